@@ -0,0 +1,115 @@
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include <equilibrium/collate.h>
+#include <gflags/gflags.h>
+#include <omp.h>
+
+DEFINE_string(tag, "", "tag");
+DEFINE_string(data_dir, "data", "data-dir");
+DEFINE_string(output, "", "output: defaults to processed-data/collated-result-<now>.csv");
+DEFINE_bool(incremental, false, "incremental: append files modified since the last collation into --output");
+DEFINE_int32(chunk_size, 256, "chunk-size: files parsed in parallel before their rows are written");
+
+namespace {
+
+struct ResultFile {
+  std::string path;
+  long long mtime_ns;
+};
+
+void ListResultFiles(const std::string& directory, long long newer_than_ns, std::vector<ResultFile>* files) {
+  DIR* dir = opendir(directory.c_str());
+  if (dir == nullptr) throw std::invalid_argument("Cannot open '" + directory + "'");
+  while (dirent* entry = readdir(dir)) {
+    const std::string name = entry->d_name;
+    if (name.size() < 5 || name.compare(name.size() - 5, 5, ".json") != 0) continue;
+    const std::string path = directory + "/" + name;
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0 || !S_ISREG(info.st_mode)) continue;
+    const long long mtime_ns = info.st_mtim.tv_sec * 1000000000LL + info.st_mtim.tv_nsec;
+    if (mtime_ns > newer_than_ns) files->push_back({path, mtime_ns});
+  }
+  closedir(dir);
+  // Stable output order regardless of directory order.
+  std::sort(files->begin(), files->end(),
+            [](const ResultFile& a, const ResultFile& b) { return a.path < b.path; });
+}
+
+bool FileExists(const std::string& path) {
+  struct stat info;
+  return stat(path.c_str(), &info) == 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  gflags::SetUsageMessage("Collate diversity-counts results into a CSV, as scripts/data-to-csv.py");
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  std::string output = FLAGS_output;
+  if (output.empty()) {
+    if (FLAGS_incremental) throw std::invalid_argument("--incremental needs an explicit --output");
+    const auto now = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    output = "processed-data/collated-result-" + std::to_string(now) + ".csv";
+  }
+
+  // The state file remembers the newest modification time collated so far.
+  const std::string state_path = output + ".state";
+  long long newer_than_ns = -1;
+  if (FLAGS_incremental) {
+    std::ifstream state{state_path};
+    state >> newer_than_ns;
+  }
+
+  std::vector<ResultFile> files;
+  ListResultFiles(FLAGS_data_dir, newer_than_ns, &files);
+
+  const bool append = FLAGS_incremental && FileExists(output);
+  std::ofstream ofs{output, append ? std::ios::app : std::ios::trunc};
+  if (!ofs) throw std::invalid_argument("Cannot write '" + output + "'");
+  if (!append) equilibrium::WriteCsvRow(equilibrium::CollateColumns(), &ofs);
+
+  long long newest_ns = newer_than_ns;
+  long long num_rows = 0;
+  int num_failed = 0;
+  const int num_files = static_cast<int>(files.size());
+  for (int chunk_start = 0; chunk_start < num_files; chunk_start += FLAGS_chunk_size) {
+    const int chunk_end = std::min(num_files, chunk_start + FLAGS_chunk_size);
+    std::vector<std::vector<equilibrium::CsvRow>> rows(chunk_end - chunk_start);
+    std::vector<char> ok(chunk_end - chunk_start, 1);
+
+#pragma omp parallel for schedule(dynamic)
+    for (int i = chunk_start; i < chunk_end; ++i) {
+      std::ifstream ifs{files[i].path};
+      ok[i - chunk_start] = equilibrium::CollateDiversityCounts(&ifs, FLAGS_tag, &rows[i - chunk_start]);
+    }
+
+    for (int i = chunk_start; i < chunk_end; ++i) {
+      if (!ok[i - chunk_start]) {
+        std::cerr << "skipping malformed " << files[i].path << std::endl;
+        ++num_failed;
+      }
+      for (const auto& row : rows[i - chunk_start]) equilibrium::WriteCsvRow(row, &ofs);
+      num_rows += rows[i - chunk_start].size();
+      newest_ns = std::max(newest_ns, files[i].mtime_ns);
+    }
+  }
+
+  ofs.close();
+  if (FLAGS_incremental) {
+    std::ofstream state{state_path};
+    state << newest_ns << std::endl;
+  }
+  std::cout << files.size() << " files, " << num_rows << " rows, " << num_failed << " malformed -> "
+            << output << std::endl;
+}
@@ -1,25 +1,30 @@
 #include <fstream>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <stdexcept>
 #include <string>
 
 #include <equilibrium/graph.h>
+#include <equilibrium/numa.h>
+#include <equilibrium/progress.h>
+#include <equilibrium/result_cache.h>
 #include <equilibrium/simulation.h>
 #include <equilibrium/writer.h>
 #include <gflags/gflags.h>
 #include <omp.h>
 #include <prettyprint.hpp>
 
-DEFINE_int32(N, 1, "N");
-DEFINE_int32(num_steps, 0, "num-steps");
-DEFINE_int32(num_simulations, 1, "num-simulations");
-DEFINE_double(birth_mutation_rate, 0, "birth-mutation-rate");
-DEFINE_double(independent_mutation_rate, 0, "independent-mutation-rate");
-DEFINE_string(graph_name, "complete", "graph-name");
-DEFINE_string(dynamic, "birth-death", "dynamic");
-DEFINE_string(tag, "", "tag");
-DEFINE_bool(start_with_max_diversity, false, "start-with-max-diversity");
+#include "diversity_counts_config.h"
+
+DEFINE_string(cache_dir, "", "cache-dir: reuse and extend seeded trials stored here");
+DEFINE_string(node_rates_file, "", "node-rates-file");
+DEFINE_string(edge_weights_file, "", "edge-weights-file");
+DEFINE_bool(continuous_time, false, "continuous-time");
+DEFINE_string(measures, "", "measures");
+DEFINE_bool(numa_replicas, false, "numa-replicas: pin threads and copy the graph to every NUMA node");
+DEFINE_double(progress_interval, 0, "progress-interval: seconds between progress reports on stderr, 0 for none");
+DEFINE_string(status_file, "", "status-file: with --progress_interval, JSON progress rewritten at every report");
 
 
 int main(int argc, char** argv) {
@@ -28,35 +33,71 @@ int main(int argc, char** argv) {
   gflags::ParseCommandLineFlags(&argc, &argv, true);
 
   equilibrium::SimulationConfig config;
-  config.birth_mutation_rate = FLAGS_birth_mutation_rate;
-  config.independent_mutation_rate = FLAGS_independent_mutation_rate;
-  config.num_steps = FLAGS_num_steps;
-  config.num_simulations = FLAGS_num_simulations;
-  config.compute_stats = true;
-  config.capture_history = false;
-  config.start_with_max_diversity = FLAGS_start_with_max_diversity;
-  config.run_until_homogeneous = false;
-
-  if (!GetGraph(FLAGS_graph_name, FLAGS_N, &config.graph)) {
-    throw std::invalid_argument("No graph named '" + FLAGS_graph_name + "'");
+  GetConfig(&config);
+  config.continuous_time = FLAGS_continuous_time;
+  config.numa_replicas = FLAGS_numa_replicas;
+
+  if (!FLAGS_edge_weights_file.empty()) {
+    std::ifstream weights_stream{FLAGS_edge_weights_file};
+    if (!equilibrium::ReadEdgeWeights(&weights_stream, &config.graph)) {
+      throw std::invalid_argument("Bad edge weights in '" + FLAGS_edge_weights_file + "'");
+    }
   }
 
-  if (!FromString(FLAGS_dynamic, &config.dynamic)) {
-    throw std::invalid_argument("No dynamic named '" + FLAGS_dynamic + "'");
+  if (!FLAGS_node_rates_file.empty()) {
+    std::ifstream rates_stream{FLAGS_node_rates_file};
+    if (!equilibrium::ReadNodeRates(&rates_stream, config.graph.size(), &config.node_rates)) {
+      throw std::invalid_argument("Bad node rates in '" + FLAGS_node_rates_file + "'");
+    }
+  }
+
+
+  if (!equilibrium::MakeMeasureTrackers(FLAGS_measures, config.graph, &config.measures)) {
+    throw std::invalid_argument("Bad measures '" + FLAGS_measures + "'");
   }
 
+  if (config.numa_replicas) {
+    equilibrium::NumaTopology topology;
+    equilibrium::GetNumaTopology(&topology);
+    std::cout << "replicating " << equilibrium::ReplicaBytes(config) << " bytes on each of "
+              << topology.num_nodes() << " NUMA nodes" << std::endl;
+  }
 
   equilibrium::MetaData metadata;
   metadata.tag = FLAGS_tag;
   metadata.start_time = std::chrono::system_clock::now();
 
+  // Cached rows only hold the built-in measures.
+  const bool use_cache = !FLAGS_cache_dir.empty() && config.measures.empty();
+
+  std::unique_ptr<equilibrium::ProgressReporter> progress;
+  if (FLAGS_progress_interval > 0) {
+    // Cached trials are never simulated, so they are left out of the totals.
+    const int num_trials = config.num_simulations -
+        (use_cache ? equilibrium::CachedTrials(config, config.num_simulations, equilibrium::ResultCache(FLAGS_cache_dir)) : 0);
+    progress.reset(new equilibrium::ProgressReporter(
+        num_trials, num_trials * static_cast<long long>(config.num_steps),
+        FLAGS_progress_interval, FLAGS_status_file));
+  }
+
   equilibrium::DiversityCounts diversity_counts;
-  ComputeDiversityCounts(config, &diversity_counts);
+  equilibrium::MeasureSummaries measure_summaries;
+  if (use_cache) {
+    int cached_trials = 0;
+    ComputeDiversityCounts(config, equilibrium::ResultCache(FLAGS_cache_dir), &diversity_counts, &cached_trials);
+    std::cout << "reused " << cached_trials << " cached trials" << std::endl;
+  } else {
+    if (!FLAGS_cache_dir.empty()) {
+      std::cerr << "ignoring --cache_dir: cached trials do not hold --measures" << std::endl;
+    }
+    ComputeDiversityCounts(config, 0, config.num_simulations, &diversity_counts, &measure_summaries);
+  }
+  progress.reset();
   std::cout << "done" << std::endl;
 
   metadata.end_time = std::chrono::system_clock::now();
 
   const std::string output_file_name = equilibrium::GetOutputFileName("diversity-counts-", metadata.start_time);
   std::ofstream ofs{"data/" + output_file_name + ".json"};
-  equilibrium::WriteDiversityCountsToStream(diversity_counts, config, metadata, &ofs);
+  equilibrium::WriteDiversityCountsToStream(diversity_counts, measure_summaries, config, metadata, &ofs);
 }
\ No newline at end of file
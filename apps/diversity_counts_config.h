@@ -0,0 +1,47 @@
+#ifndef EQUILIBRIUM_APPS_DIVERSITY_COUNTS_CONFIG_H_
+#define EQUILIBRIUM_APPS_DIVERSITY_COUNTS_CONFIG_H_
+
+// Flags and flag-to-config code shared by diversity_counts and
+// diversity_counts_mpi. Defines the flags, so include it from one source file
+// per binary.
+
+#include <stdexcept>
+#include <string>
+
+#include <equilibrium/graph.h>
+#include <equilibrium/simulation.h>
+#include <gflags/gflags.h>
+
+DEFINE_int32(N, 1, "N");
+DEFINE_int32(num_steps, 0, "num-steps");
+DEFINE_int32(num_simulations, 1, "num-simulations");
+DEFINE_double(birth_mutation_rate, 0, "birth-mutation-rate");
+DEFINE_double(independent_mutation_rate, 0, "independent-mutation-rate");
+DEFINE_string(graph_name, "complete", "graph-name");
+DEFINE_string(dynamic, "birth-death", "dynamic");
+DEFINE_string(tag, "", "tag");
+DEFINE_int32(seed, equilibrium::kNoSeed, "seed");
+DEFINE_bool(start_with_max_diversity, false, "start-with-max-diversity");
+
+/// Everything but what only the single-process app supports.
+inline void GetConfig(equilibrium::SimulationConfig* config) {
+  config->birth_mutation_rate = FLAGS_birth_mutation_rate;
+  config->independent_mutation_rate = FLAGS_independent_mutation_rate;
+  config->num_steps = FLAGS_num_steps;
+  config->num_simulations = FLAGS_num_simulations;
+  config->compute_stats = true;
+  config->capture_history = false;
+  config->start_with_max_diversity = FLAGS_start_with_max_diversity;
+  config->run_until_homogeneous = false;
+  config->seed = FLAGS_seed;
+
+  if (!GetGraph(FLAGS_graph_name, FLAGS_N, &config->graph)) {
+    throw std::invalid_argument("No graph named '" + FLAGS_graph_name + "'");
+  }
+
+  if (!FromString(FLAGS_dynamic, &config->dynamic)) {
+    throw std::invalid_argument("No dynamic named '" + FLAGS_dynamic + "'");
+  }
+}
+
+#endif // EQUILIBRIUM_APPS_DIVERSITY_COUNTS_CONFIG_H_
@@ -0,0 +1,61 @@
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <equilibrium/distributed.h>
+#include <equilibrium/simulation.h>
+#include <equilibrium/writer.h>
+#include <gflags/gflags.h>
+#include <mpi.h>
+#include <omp.h>
+
+#include "diversity_counts_config.h"
+#include "mpi_gather.h"
+
+int main(int argc, char** argv) {
+  MPI_Init(&argc, &argv);
+  int rank, num_ranks;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &num_ranks);
+
+  gflags::SetUsageMessage(
+      "Simulate birth-death process with multiple mutations across MPI ranks: capture final diversity");
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  equilibrium::SimulationConfig config;
+  GetConfig(&config);
+
+  equilibrium::MetaData metadata;
+  metadata.tag = FLAGS_tag;
+  metadata.start_time = std::chrono::system_clock::now();
+
+  const auto range = equilibrium::GetTrialRange(config.num_simulations, rank, num_ranks);
+  equilibrium::DiversityCounts local_counts;
+  equilibrium::ComputeDiversityCounts(config, range.first, range.last, &local_counts);
+
+  std::vector<int> flat;
+  equilibrium::FlattenDiversityCounts(local_counts, &flat);
+  std::vector<std::vector<int>> gathered;
+  GatherToRoot(flat, rank, num_ranks, &gathered);
+
+  if (rank == 0) {
+    equilibrium::DiversityCounts diversity_counts;
+    for (const auto& rank_flat : gathered) {
+      if (!equilibrium::UnflattenDiversityCounts(rank_flat, &diversity_counts)) {
+        throw std::runtime_error("Malformed diversity counts from rank");
+      }
+    }
+    std::cout << "done" << std::endl;
+
+    metadata.end_time = std::chrono::system_clock::now();
+
+    const std::string output_file_name = equilibrium::GetOutputFileName("diversity-counts-", metadata.start_time);
+    std::ofstream ofs{"data/" + output_file_name + ".json"};
+    equilibrium::WriteDiversityCountsToStream(diversity_counts, config, metadata, &ofs);
+  }
+
+  MPI_Finalize();
+}
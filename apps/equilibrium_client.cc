@@ -0,0 +1,65 @@
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <gflags/gflags.h>
+
+DEFINE_string(socket_path, "/tmp/equilibrium.sock", "socket-path");
+DEFINE_string(job, "", "job: a single JSON job; otherwise one job per line of stdin");
+
+namespace {
+
+void WriteAll(int fd, const std::string& data) {
+  size_t written = 0;
+  while (written < data.size()) {
+    const ssize_t n = write(fd, data.data() + written, data.size() - written);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) throw std::runtime_error(std::string("write failed: ") + std::strerror(errno));
+    written += n;
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  gflags::SetUsageMessage("Send jobs to equilibrium_server and print each reply as it arrives");
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  sockaddr_un address;
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (FLAGS_socket_path.size() >= sizeof(address.sun_path)) {
+    throw std::invalid_argument("Socket path too long: '" + FLAGS_socket_path + "'");
+  }
+  std::strcpy(address.sun_path, FLAGS_socket_path.c_str());
+
+  const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+    throw std::runtime_error("Cannot connect to '" + FLAGS_socket_path + "': " + std::strerror(errno));
+  }
+
+  if (!FLAGS_job.empty()) {
+    WriteAll(fd, FLAGS_job + '\n');
+  } else {
+    std::string line;
+    while (std::getline(std::cin, line)) WriteAll(fd, line + '\n');
+  }
+  // The server closes its end once every reply has been sent.
+  shutdown(fd, SHUT_WR);
+
+  char chunk[4096];
+  while (true) {
+    const ssize_t n = read(fd, chunk, sizeof(chunk));
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) break;
+    std::cout.write(chunk, n);
+    std::cout.flush();
+  }
+  close(fd);
+}
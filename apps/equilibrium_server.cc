@@ -0,0 +1,135 @@
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <equilibrium/server.h>
+#include <gflags/gflags.h>
+#include <nlohmann/json.hpp>
+#include <omp.h>
+
+DEFINE_string(socket_path, "/tmp/equilibrium.sock", "socket-path");
+DEFINE_int32(workers, 1, "workers: jobs run at the same time");
+DEFINE_int32(threads_per_worker, 0, "threads-per-worker: 0 splits the cores evenly between workers");
+
+namespace {
+
+/// One client. Replies may come from several workers, so writes are locked;
+/// the socket closes once the client has hung up and every reply is sent.
+class Connection {
+ public:
+  explicit Connection(int fd) : fd_(fd) {}
+  ~Connection() { close(fd_); }
+
+  bool ReadLine(std::string* line) {
+    while (true) {
+      const auto newline = buffer_.find('\n');
+      if (newline != std::string::npos) {
+        *line = buffer_.substr(0, newline);
+        buffer_.erase(0, newline + 1);
+        return true;
+      }
+      char chunk[4096];
+      const ssize_t n = read(fd_, chunk, sizeof(chunk));
+      if (n < 0 && errno == EINTR) continue;
+      if (n <= 0) {
+        // A last job without a trailing newline still counts.
+        *line = buffer_;
+        buffer_.clear();
+        return !line->empty();
+      }
+      buffer_.append(chunk, n);
+    }
+  }
+
+  void WriteLine(const std::string& line) {
+    const std::string data = line + '\n';
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    size_t written = 0;
+    while (written < data.size()) {
+      const ssize_t n = write(fd_, data.data() + written, data.size() - written);
+      if (n < 0 && errno == EINTR) continue;
+      // The client went away; drop the reply.
+      if (n <= 0) return;
+      written += n;
+    }
+  }
+
+ private:
+  int fd_;
+  std::string buffer_;
+  std::mutex write_mutex_;
+};
+
+void Serve(std::shared_ptr<Connection> connection, equilibrium::JobQueue* queue, equilibrium::GraphCache* graphs) {
+  std::string line;
+  while (connection->ReadLine(&line)) {
+    if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+    // Status requests skip the queue, so they answer even when it is full.
+    const auto job = nlohmann::json::parse(line, nullptr, false);
+    if (job.is_object() && job.value("kind", "") == "status") {
+      nlohmann::json reply;
+      if (job.count("id")) reply["id"] = job["id"];
+      reply["pending"] = queue->pending();
+      reply["graphs"] = graphs->size();
+      connection->WriteLine(reply.dump());
+      continue;
+    }
+    queue->Push([connection, line, graphs] { connection->WriteLine(equilibrium::RunJob(line, graphs)); });
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  gflags::SetUsageMessage(
+      "Serve diversity_counts and fixation jobs, one JSON object per line, over a Unix domain socket");
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  // A client that hangs up early must not take the server down with it.
+  std::signal(SIGPIPE, SIG_IGN);
+
+  const int num_workers = std::max(1, FLAGS_workers);
+  const int threads_per_worker = FLAGS_threads_per_worker > 0
+      ? FLAGS_threads_per_worker
+      : std::max(1, omp_get_max_threads() / num_workers);
+
+  sockaddr_un address;
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (FLAGS_socket_path.size() >= sizeof(address.sun_path)) {
+    throw std::invalid_argument("Socket path too long: '" + FLAGS_socket_path + "'");
+  }
+  std::strcpy(address.sun_path, FLAGS_socket_path.c_str());
+
+  const int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  unlink(FLAGS_socket_path.c_str());
+  if (listen_fd < 0 || bind(listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+      listen(listen_fd, 64) != 0) {
+    throw std::runtime_error("Cannot listen on '" + FLAGS_socket_path + "': " + std::strerror(errno));
+  }
+
+  equilibrium::GraphCache graphs;
+  equilibrium::JobQueue queue(num_workers, threads_per_worker);
+  std::cout << "listening on " << FLAGS_socket_path << " with " << num_workers << " workers x "
+            << threads_per_worker << " threads" << std::endl;
+
+  while (true) {
+    const int fd = accept(listen_fd, nullptr, nullptr);
+    if (fd < 0) {
+      if (errno == EINTR) continue;
+      throw std::runtime_error(std::string("accept failed: ") + std::strerror(errno));
+    }
+    std::thread(Serve, std::make_shared<Connection>(fd), &queue, &graphs).detach();
+  }
+}
@@ -0,0 +1,85 @@
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include <equilibrium/fixation.h>
+#include <equilibrium/graph.h>
+#include <equilibrium/progress.h>
+#include <equilibrium/simulation.h>
+#include <equilibrium/writer.h>
+#include <gflags/gflags.h>
+#include <omp.h>
+#include <prettyprint.hpp>
+
+DEFINE_int32(N, 1, "N");
+DEFINE_int32(num_simulations, 1, "num-simulations");
+DEFINE_string(graph_name, "complete", "graph-name");
+DEFINE_string(dynamic, "birth-death", "dynamic");
+DEFINE_double(mutant_fitness, 1., "mutant-fitness");
+DEFINE_int32(start_node, equilibrium::kRandomStartNode, "start-node: a node, -1 for random, -2 for every node in turn");
+DEFINE_int64(max_steps, 0, "max-steps: 0 runs every trial to absorption");
+DEFINE_int32(batch_size, 1024, "batch-size");
+DEFINE_string(engine, "scalar", "engine: scalar or batched");
+DEFINE_string(tag, "", "tag");
+DEFINE_int32(seed, equilibrium::kNoSeed, "seed");
+DEFINE_double(progress_interval, 0, "progress-interval: seconds between progress reports on stderr, 0 for none");
+DEFINE_string(status_file, "", "status-file: with --progress_interval, JSON progress rewritten at every report");
+
+
+int main(int argc, char** argv) {
+  gflags::SetUsageMessage(
+      "Simulate invasion of a single mutant: capture fixation probability and time");
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  equilibrium::FixationConfig config;
+  config.mutant_fitness = FLAGS_mutant_fitness;
+  config.start_node = FLAGS_start_node;
+  config.num_simulations = FLAGS_num_simulations;
+  config.seed = FLAGS_seed;
+  config.max_steps = FLAGS_max_steps;
+  config.batch_size = FLAGS_batch_size;
+
+  if (!GetGraph(FLAGS_graph_name, FLAGS_N, &config.graph)) {
+    throw std::invalid_argument("No graph named '" + FLAGS_graph_name + "'");
+  }
+
+  if (!FromString(FLAGS_dynamic, &config.dynamic)) {
+    throw std::invalid_argument("No dynamic named '" + FLAGS_dynamic + "'");
+  }
+
+  if (!equilibrium::IsValidFitness(config.mutant_fitness)) {
+    throw std::invalid_argument("Mutant fitness must be finite and positive");
+  }
+
+  if (!FromString(FLAGS_engine, &config.engine)) {
+    throw std::invalid_argument("No engine named '" + FLAGS_engine + "'");
+  }
+
+  if (config.start_node >= config.graph.size() || config.start_node < equilibrium::kEveryStartNode) {
+    throw std::invalid_argument("No node " + std::to_string(config.start_node));
+  }
+
+  equilibrium::MetaData metadata;
+  metadata.tag = FLAGS_tag;
+  metadata.start_time = std::chrono::system_clock::now();
+
+  std::unique_ptr<equilibrium::ProgressReporter> progress;
+  if (FLAGS_progress_interval > 0) {
+    progress.reset(new equilibrium::ProgressReporter(config.num_simulations, 0, FLAGS_progress_interval,
+                                                     FLAGS_status_file));
+  }
+
+  equilibrium::FixationResults results;
+  equilibrium::ComputeFixation(config, &results);
+  progress.reset();
+  std::cout << "done" << std::endl;
+
+  metadata.end_time = std::chrono::system_clock::now();
+
+  const std::string output_file_name = equilibrium::GetOutputFileName("fixation-", metadata.start_time);
+  std::ofstream ofs{"data/" + output_file_name + ".json"};
+  equilibrium::WriteFixationToStream(results, config, metadata, &ofs);
+}
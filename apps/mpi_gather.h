@@ -0,0 +1,43 @@
+#ifndef EQUILIBRIUM_APPS_MPI_GATHER_H_
+#define EQUILIBRIUM_APPS_MPI_GATHER_H_
+
+#include <vector>
+
+#include <mpi.h>
+
+inline MPI_Datatype MpiDatatype(int) { return MPI_INT; }
+inline MPI_Datatype MpiDatatype(long long) { return MPI_LONG_LONG; }
+
+/// Gathers every rank's `local` onto rank 0 as one vector per rank.
+template <typename T>
+void GatherToRoot(
+    const std::vector<T>& local,
+    int rank,
+    int num_ranks,
+    std::vector<std::vector<T>>* gathered
+) {
+  int local_size = static_cast<int>(local.size());
+  std::vector<int> sizes(num_ranks, 0);
+  MPI_Gather(&local_size, 1, MPI_INT, sizes.data(), 1, MPI_INT, 0, MPI_COMM_WORLD);
+
+  std::vector<int> displacements(num_ranks, 0);
+  int total_size = 0;
+  for (int r = 0; r < num_ranks; ++r) {
+    displacements[r] = total_size;
+    total_size += sizes[r];
+  }
+
+  std::vector<T> buffer(rank == 0 ? total_size : 0);
+  MPI_Gatherv(local.data(), local_size, MpiDatatype(T()),
+              buffer.data(), sizes.data(), displacements.data(), MpiDatatype(T()),
+              0, MPI_COMM_WORLD);
+
+  if (rank != 0) return;
+  gathered->clear();
+  for (int r = 0; r < num_ranks; ++r) {
+    gathered->emplace_back(buffer.begin() + displacements[r],
+                           buffer.begin() + displacements[r] + sizes[r]);
+  }
+}
+
+#endif // EQUILIBRIUM_APPS_MPI_GATHER_H_
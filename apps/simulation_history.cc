@@ -19,6 +19,11 @@ DEFINE_double(independent_mutation_rate, 0, "independent-mutation-rate");
 DEFINE_string(graph_name, "complete", "graph-name");
 DEFINE_string(dynamic, "birth-death", "dynamic");
 DEFINE_string(tag, "", "tag");
+DEFINE_int32(seed, equilibrium::kNoSeed, "seed");
+DEFINE_string(node_rates_file, "", "node-rates-file");
+DEFINE_string(edge_weights_file, "", "edge-weights-file");
+DEFINE_bool(continuous_time, false, "continuous-time");
+DEFINE_bool(track_genealogy, false, "track-genealogy");
 DEFINE_int32(sample_rate, 1, "sample-rate");
 DEFINE_bool(start_with_max_diversity, false, "start-with-max-diversity");
 DEFINE_bool(run_until_homogeneous, false, "run-until-homogeneous");
@@ -39,6 +44,9 @@ int main(int argc, char** argv) {
   config.capture_history = true;
   config.start_with_max_diversity = FLAGS_start_with_max_diversity;
   config.run_until_homogeneous = FLAGS_run_until_homogeneous;
+  config.seed = FLAGS_seed;
+  config.continuous_time = FLAGS_continuous_time;
+  config.track_genealogy = FLAGS_track_genealogy;
 
   if (config.run_until_homogeneous && config.num_steps) {
     throw std::invalid_argument("Cannot specify 'run-until-homogeneous' and 'num-steps'");
@@ -52,6 +60,20 @@ int main(int argc, char** argv) {
     throw std::invalid_argument("No dynamic named '" + FLAGS_dynamic + "'");
   }
 
+  if (!FLAGS_edge_weights_file.empty()) {
+    std::ifstream weights_stream{FLAGS_edge_weights_file};
+    if (!equilibrium::ReadEdgeWeights(&weights_stream, &config.graph)) {
+      throw std::invalid_argument("Bad edge weights in '" + FLAGS_edge_weights_file + "'");
+    }
+  }
+
+  if (!FLAGS_node_rates_file.empty()) {
+    std::ifstream rates_stream{FLAGS_node_rates_file};
+    if (!equilibrium::ReadNodeRates(&rates_stream, config.graph.size(), &config.node_rates)) {
+      throw std::invalid_argument("Bad node rates in '" + FLAGS_node_rates_file + "'");
+    }
+  }
+
 
   equilibrium::MetaData metadata;
   metadata.tag = FLAGS_tag;
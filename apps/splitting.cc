@@ -0,0 +1,95 @@
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include <equilibrium/fixation.h>
+#include <equilibrium/graph.h>
+#include <equilibrium/simulation.h>
+#include <equilibrium/splitting.h>
+#include <equilibrium/writer.h>
+#include <gflags/gflags.h>
+#include <omp.h>
+
+DEFINE_int32(N, 1, "N");
+DEFINE_string(graph_name, "complete", "graph-name");
+DEFINE_string(dynamic, "birth-death", "dynamic");
+DEFINE_double(mutant_fitness, 1., "mutant-fitness");
+DEFINE_int32(start_node, equilibrium::kRandomStartNode, "start-node: a node, -1 for random, -2 for every node in turn");
+DEFINE_int64(max_steps, 0, "max-steps: with mutant-count, clones that take longer fail");
+DEFINE_string(coordinate, "mutant-count", "coordinate: mutant-count or steps");
+DEFINE_int64(target, 0, "target: the rare level; defaults to N (fixation) for mutant-count");
+DEFINE_int32(num_levels, 10, "num-levels: evenly spaced up to target, unless levels is set");
+DEFINE_string(levels, "", "levels: comma separated increasing thresholds, the last being the target");
+DEFINE_int32(clones_per_level, 1000, "clones-per-level");
+DEFINE_int32(num_replications, 10, "num-replications");
+DEFINE_string(tag, "", "tag");
+DEFINE_int32(seed, equilibrium::kNoSeed, "seed");
+
+
+int main(int argc, char** argv) {
+  gflags::SetUsageMessage(
+      "Simulate invasion of a single mutant: estimate rare fixation or long absorption by multilevel splitting");
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  equilibrium::SplittingConfig config;
+  config.fixation.mutant_fitness = FLAGS_mutant_fitness;
+  config.fixation.start_node = FLAGS_start_node;
+  config.fixation.num_simulations = 0;
+  config.fixation.seed = FLAGS_seed;
+  config.fixation.max_steps = FLAGS_max_steps;
+  config.clones_per_level = FLAGS_clones_per_level;
+  config.num_replications = FLAGS_num_replications;
+
+  if (!GetGraph(FLAGS_graph_name, FLAGS_N, &config.fixation.graph)) {
+    throw std::invalid_argument("No graph named '" + FLAGS_graph_name + "'");
+  }
+
+  if (!FromString(FLAGS_dynamic, &config.fixation.dynamic)) {
+    throw std::invalid_argument("No dynamic named '" + FLAGS_dynamic + "'");
+  }
+
+  if (!equilibrium::IsValidFitness(config.fixation.mutant_fitness)) {
+    throw std::invalid_argument("Mutant fitness must be finite and positive");
+  }
+
+  if (!FromString(FLAGS_coordinate, &config.coordinate)) {
+    throw std::invalid_argument("No coordinate named '" + FLAGS_coordinate + "'");
+  }
+
+  if (config.fixation.start_node >= config.fixation.graph.size() ||
+      config.fixation.start_node < equilibrium::kEveryStartNode) {
+    throw std::invalid_argument("No node " + std::to_string(config.fixation.start_node));
+  }
+
+  if (config.clones_per_level < 1 || config.num_replications < 1) {
+    throw std::invalid_argument("Need at least one clone per level and one replication");
+  }
+
+  if (!FLAGS_levels.empty()) {
+    std::istringstream levels_stream{FLAGS_levels};
+    std::string level;
+    while (std::getline(levels_stream, level, ',')) config.levels.emplace_back(std::stoll(level));
+  } else {
+    const bool by_mutants = config.coordinate == equilibrium::ProgressCoordinate::MUTANT_COUNT;
+    const long long target = FLAGS_target > 0 ? FLAGS_target : (by_mutants ? config.fixation.graph.size() : 0);
+    equilibrium::MakeEvenLevels(by_mutants ? 1 : 0, target, FLAGS_num_levels, &config.levels);
+  }
+
+  equilibrium::MetaData metadata;
+  metadata.tag = FLAGS_tag;
+  metadata.start_time = std::chrono::system_clock::now();
+
+  equilibrium::SplittingResult result;
+  if (!equilibrium::RunSplitting(config, &result)) {
+    throw std::invalid_argument("Bad levels for " + FLAGS_coordinate);
+  }
+  std::cout << "done" << std::endl;
+
+  metadata.end_time = std::chrono::system_clock::now();
+
+  const std::string output_file_name = equilibrium::GetOutputFileName("splitting-", metadata.start_time);
+  std::ofstream ofs{"data/" + output_file_name + ".json"};
+  equilibrium::WriteSplittingToStream(result, config, metadata, &ofs);
+}
@@ -0,0 +1,85 @@
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <equilibrium/graph.h>
+#include <equilibrium/simulation.h>
+#include <equilibrium/sweep.h>
+#include <equilibrium/writer.h>
+#include <gflags/gflags.h>
+#include <omp.h>
+
+DEFINE_int32(N, 1, "N");
+DEFINE_int32(num_steps, 0, "num-steps");
+DEFINE_int32(num_simulations, 1, "num-simulations");
+DEFINE_double(birth_mutation_rate, 0, "birth-mutation-rate");
+DEFINE_double(independent_mutation_rate, 0, "independent-mutation-rate");
+DEFINE_string(graph_name, "complete", "graph-name");
+DEFINE_string(dynamic, "birth-death", "dynamic");
+DEFINE_string(tag, "", "tag");
+DEFINE_int32(seed, equilibrium::kNoSeed, "seed: drawn once for the whole sweep when unset");
+DEFINE_bool(start_with_max_diversity, false, "start-with-max-diversity");
+DEFINE_string(sweep_parameter, "birth_mutation_rate",
+              "sweep-parameter: birth_mutation_rate, independent_mutation_rate or dynamic");
+DEFINE_string(sweep_values, "", "sweep-values: comma separated, the first is the baseline");
+DEFINE_bool(common_random_numbers, true, "common-random-numbers: couple trial k across values");
+
+
+int main(int argc, char** argv) {
+  gflags::SetUsageMessage(
+      "Simulate birth-death process with multiple mutations: paired differences across a parameter sweep");
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  equilibrium::SimulationConfig config;
+  config.birth_mutation_rate = FLAGS_birth_mutation_rate;
+  config.independent_mutation_rate = FLAGS_independent_mutation_rate;
+  config.num_steps = FLAGS_num_steps;
+  config.num_simulations = FLAGS_num_simulations;
+  config.compute_stats = true;
+  config.capture_history = false;
+  config.start_with_max_diversity = FLAGS_start_with_max_diversity;
+  config.run_until_homogeneous = false;
+  config.seed = FLAGS_seed;
+  config.common_random_numbers = FLAGS_common_random_numbers;
+  if (config.seed == equilibrium::kNoSeed) {
+    // Every value must see the same seed.
+    std::random_device rd;
+    config.seed = static_cast<int>(rd() & 0x3fffffff);
+  }
+
+  if (!GetGraph(FLAGS_graph_name, FLAGS_N, &config.graph)) {
+    throw std::invalid_argument("No graph named '" + FLAGS_graph_name + "'");
+  }
+
+  if (!FromString(FLAGS_dynamic, &config.dynamic)) {
+    throw std::invalid_argument("No dynamic named '" + FLAGS_dynamic + "'");
+  }
+
+  std::vector<std::string> values;
+  std::istringstream values_stream{FLAGS_sweep_values};
+  std::string value;
+  while (std::getline(values_stream, value, ',')) values.emplace_back(value);
+  if (values.size() < 2) {
+    throw std::invalid_argument("Need at least two sweep values, got '" + FLAGS_sweep_values + "'");
+  }
+
+  equilibrium::MetaData metadata;
+  metadata.tag = FLAGS_tag;
+  metadata.start_time = std::chrono::system_clock::now();
+
+  equilibrium::SweepResults results;
+  if (!equilibrium::ComputeSweep(config, FLAGS_sweep_parameter, values, &results)) {
+    throw std::invalid_argument("Bad sweep of " + FLAGS_sweep_parameter + " over '" + FLAGS_sweep_values + "'");
+  }
+  std::cout << "done" << std::endl;
+
+  metadata.end_time = std::chrono::system_clock::now();
+
+  const std::string output_file_name = equilibrium::GetOutputFileName("sweep-", metadata.start_time);
+  std::ofstream ofs{"data/" + output_file_name + ".json"};
+  equilibrium::WriteSweepToStream(results, config, metadata, &ofs);
+}
@@ -0,0 +1,74 @@
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include <equilibrium/graph.h>
+#include <equilibrium/simulation.h>
+#include <equilibrium/trajectory.h>
+#include <equilibrium/writer.h>
+#include <gflags/gflags.h>
+#include <omp.h>
+
+DEFINE_int32(N, 1, "N");
+DEFINE_int32(num_steps, 0, "num-steps");
+DEFINE_int32(num_simulations, 1, "num-simulations");
+DEFINE_int32(num_checkpoints, 100, "num-checkpoints");
+DEFINE_string(spacing, "log", "spacing: log or linear");
+DEFINE_double(birth_mutation_rate, 0, "birth-mutation-rate");
+DEFINE_double(independent_mutation_rate, 0, "independent-mutation-rate");
+DEFINE_string(graph_name, "complete", "graph-name");
+DEFINE_string(dynamic, "birth-death", "dynamic");
+DEFINE_string(measures, "", "measures");
+DEFINE_string(tag, "", "tag");
+DEFINE_int32(seed, equilibrium::kNoSeed, "seed");
+DEFINE_bool(start_with_max_diversity, false, "start-with-max-diversity");
+
+
+int main(int argc, char** argv) {
+  gflags::SetUsageMessage(
+      "Simulate birth-death process with multiple mutations: diversity over time");
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  equilibrium::SimulationConfig config;
+  config.birth_mutation_rate = FLAGS_birth_mutation_rate;
+  config.independent_mutation_rate = FLAGS_independent_mutation_rate;
+  config.num_steps = FLAGS_num_steps;
+  config.num_simulations = FLAGS_num_simulations;
+  config.compute_stats = true;
+  config.capture_history = false;
+  config.start_with_max_diversity = FLAGS_start_with_max_diversity;
+  config.run_until_homogeneous = false;
+  config.seed = FLAGS_seed;
+
+  if (!GetGraph(FLAGS_graph_name, FLAGS_N, &config.graph)) {
+    throw std::invalid_argument("No graph named '" + FLAGS_graph_name + "'");
+  }
+
+  if (!FromString(FLAGS_dynamic, &config.dynamic)) {
+    throw std::invalid_argument("No dynamic named '" + FLAGS_dynamic + "'");
+  }
+
+  if (FLAGS_spacing != "log" && FLAGS_spacing != "linear") {
+    throw std::invalid_argument("No spacing named '" + FLAGS_spacing + "'");
+  }
+  equilibrium::MakeCheckpoints(config.num_steps, FLAGS_num_checkpoints, FLAGS_spacing == "log", &config.checkpoints);
+
+  if (!equilibrium::MakeMeasureTrackers(FLAGS_measures, config.graph, &config.measures)) {
+    throw std::invalid_argument("Bad measures '" + FLAGS_measures + "'");
+  }
+
+  equilibrium::MetaData metadata;
+  metadata.tag = FLAGS_tag;
+  metadata.start_time = std::chrono::system_clock::now();
+
+  equilibrium::TrajectorySummary summary;
+  equilibrium::ComputeTrajectories(config, 0, config.num_simulations, &summary);
+  std::cout << "done" << std::endl;
+
+  metadata.end_time = std::chrono::system_clock::now();
+
+  const std::string output_file_name = equilibrium::GetOutputFileName("trajectory-", metadata.start_time);
+  std::ofstream ofs{"data/" + output_file_name + ".json"};
+  equilibrium::WriteTrajectoryToStream(summary, config, FLAGS_spacing, metadata, &ofs);
+}
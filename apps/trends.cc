@@ -1,58 +1,25 @@
 #include <fstream>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <stdexcept>
 #include <string>
-#include <cmath>
 
-#include <equilibrium/graph.h>
+#include <equilibrium/progress.h>
+#include <equilibrium/result_cache.h>
 #include <equilibrium/simulation.h>
 #include <equilibrium/writer.h>
 #include <gflags/gflags.h>
 #include <omp.h>
 #include <prettyprint.hpp>
 
-DEFINE_int32(N, 0, "N");
-DEFINE_int32(num_simulations, 1, "num-simulations");
-DEFINE_string(graph_name, "complete", "graph-name");
-DEFINE_string(dynamic, "birth-death", "dynamic");
-DEFINE_double(exp_sample_rate, 1., "exp-sample-rate");
-DEFINE_string(tag, "", "tag");
+#include "trends_config.h"
 
-bool should_sample(int s, double exp_sample_rate) {
-  return s == std::floor(std::pow(exp_sample_rate, std::ceil(std::log(s)/std::log(exp_sample_rate))));
-}
-
-void GetConfigs(const std::vector<int>& ns, std::map<int, equilibrium::SimulationConfig>* configs) {
-  equilibrium::SimulationConfig config;
-  config.birth_mutation_rate = 0;
-  config.independent_mutation_rate = 0;
-  config.num_steps = 0;
-  config.num_simulations = FLAGS_num_simulations;
-  config.history_sample_rate = -1;
-  config.compute_stats = true;
-  config.capture_history = false;
-  config.start_with_max_diversity = true;
-  config.run_until_homogeneous = true;
-
-  if (config.run_until_homogeneous && config.num_steps) {
-    throw std::invalid_argument(
-        "Cannot specify 'run-until-homogeneous' and 'num-steps'");
-  }
-
-  if (!FromString(FLAGS_dynamic, &config.dynamic)) {
-    throw std::invalid_argument("No dynamic named '" + FLAGS_dynamic + "'");
-  }
-
-  for (int n : ns) {
-    equilibrium::SimulationConfig config_ = config;
-    if (!GetGraph(FLAGS_graph_name, n, &config_.graph)) {
-      throw std::invalid_argument("No graph named '" + FLAGS_graph_name +
-                                  "'");
-    }
-    (*configs)[n] = config_;
-  }
-}
+DEFINE_string(cache_dir, "", "cache-dir: reuse and extend seeded trials stored here");
+DEFINE_bool(summary, false, "summary");
+DEFINE_bool(keep_samples, false, "keep-samples: with --summary, also write every time");
+DEFINE_double(progress_interval, 0, "progress-interval: seconds between progress reports on stderr, 0 for none");
+DEFINE_string(status_file, "", "status-file: with --progress_interval, JSON progress rewritten at every report");
 
 int main(int argc, char** argv) {
   gflags::SetUsageMessage(
@@ -60,11 +27,7 @@ int main(int argc, char** argv) {
   gflags::ParseCommandLineFlags(&argc, &argv, true);
 
   std::vector<int> ns;
-  for (int n = 2; n <= FLAGS_N; ++n) {
-    if (should_sample(n, FLAGS_exp_sample_rate)) {
-      ns.push_back(n);
-    }
-  }
+  GetSampledNs(&ns);
 
   std::map<int, equilibrium::SimulationConfig> configs;
   GetConfigs(ns, &configs);
@@ -74,17 +37,39 @@ int main(int argc, char** argv) {
   metadata.tag = FLAGS_tag;
   metadata.start_time = std::chrono::system_clock::now();
 
+  std::unique_ptr<equilibrium::ProgressReporter> progress;
+  if (FLAGS_progress_interval > 0) {
+    // Trials run until homogeneous, so only their number is known. Cached
+    // trials are never simulated, so they are left out of it.
+    long long num_trials = FLAGS_num_simulations * static_cast<long long>(ns.size());
+    if (!FLAGS_cache_dir.empty()) {
+      const equilibrium::ResultCache cache(FLAGS_cache_dir);
+      for (const auto& n_config : configs) {
+        num_trials -= equilibrium::CachedTrials(n_config.second, FLAGS_num_simulations, cache);
+      }
+    }
+    progress.reset(new equilibrium::ProgressReporter(num_trials, 0, FLAGS_progress_interval, FLAGS_status_file));
+  }
+
+  // Summary mode only keeps raw times when asked to.
   equilibrium::Trends absorption_times;
-#pragma omp parallel for collapse(2)
-  for (int trial = 0; trial < FLAGS_num_simulations; ++trial) {
-    for (int i = 0; i < ns.size(); ++i) {
-      const int n = ns[i];
-      equilibrium::Stats stats;
-      equilibrium::Simulate(configs[n], &stats, nullptr);
-#pragma omp critical
-      { absorption_times[n].emplace_back(stats.number_of_steps); }
+  equilibrium::TrendSummaries summaries;
+  const bool keep_samples = !FLAGS_summary || FLAGS_keep_samples;
+  if (!FLAGS_cache_dir.empty()) {
+    int cached_trials = 0;
+    if (!equilibrium::ComputeTrends(configs, FLAGS_num_simulations, equilibrium::ResultCache(FLAGS_cache_dir),
+                                    keep_samples ? &absorption_times : nullptr, FLAGS_summary ? &summaries : nullptr,
+                                    &cached_trials)) {
+      throw std::overflow_error("Absorption times overflow a long long");
+    }
+    std::cout << "reused " << cached_trials << " cached trials" << std::endl;
+  } else {
+    if (!equilibrium::ComputeTrends(configs, 0, FLAGS_num_simulations, keep_samples ? &absorption_times : nullptr,
+                                    FLAGS_summary ? &summaries : nullptr)) {
+      throw std::overflow_error("Absorption times overflow a long long");
     }
   }
+  progress.reset();
 
   std::cout << "done" << std::endl;
   metadata.end_time = std::chrono::system_clock::now();
@@ -96,6 +81,7 @@ int main(int argc, char** argv) {
    FLAGS_N,
    FLAGS_exp_sample_rate,
    absorption_times,
+   summaries,
    configs[ns[0]],
    metadata,
    &ofs
@@ -0,0 +1,88 @@
+#ifndef EQUILIBRIUM_APPS_TRENDS_CONFIG_H_
+#define EQUILIBRIUM_APPS_TRENDS_CONFIG_H_
+
+// Flags and flag-to-config code shared by trends and trends_mpi. Defines the
+// flags, so include it from one source file per binary.
+
+#include <cmath>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <equilibrium/ensemble.h>
+#include <equilibrium/graph.h>
+#include <equilibrium/lumped.h>
+#include <equilibrium/simulation.h>
+#include <gflags/gflags.h>
+
+DEFINE_int32(N, 0, "N");
+DEFINE_int32(num_simulations, 1, "num-simulations");
+DEFINE_string(graph_name, "complete", "graph-name");
+DEFINE_string(dynamic, "birth-death", "dynamic");
+DEFINE_double(exp_sample_rate, 1., "exp-sample-rate");
+DEFINE_string(tag, "", "tag");
+DEFINE_int32(seed, equilibrium::kNoSeed, "seed");
+DEFINE_string(engine, "scalar", "engine: scalar, ensemble or lumped");
+
+inline bool should_sample(int s, double exp_sample_rate) {
+  const double sampled = std::floor(std::pow(exp_sample_rate, std::ceil(std::log(s)/std::log(exp_sample_rate))));
+  return !(sampled < s || sampled > s);
+}
+
+/// The n in [2, N] that should_sample keeps.
+inline void GetSampledNs(std::vector<int>* ns) {
+  ns->clear();
+  for (int n = 2; n <= FLAGS_N; ++n) {
+    if (should_sample(n, FLAGS_exp_sample_rate)) {
+      ns->push_back(n);
+    }
+  }
+  if (ns->empty()) {
+    throw std::invalid_argument("No n up to " + std::to_string(FLAGS_N) + " to sample");
+  }
+}
+
+inline void GetConfigs(const std::vector<int>& ns, std::map<int, equilibrium::SimulationConfig>* configs) {
+  equilibrium::SimulationConfig config;
+  config.birth_mutation_rate = 0;
+  config.independent_mutation_rate = 0;
+  config.num_steps = 0;
+  config.num_simulations = FLAGS_num_simulations;
+  config.history_sample_rate = -1;
+  config.compute_stats = true;
+  config.capture_history = false;
+  config.start_with_max_diversity = true;
+  config.run_until_homogeneous = true;
+  config.seed = FLAGS_seed;
+
+  if (config.run_until_homogeneous && config.num_steps) {
+    throw std::invalid_argument(
+        "Cannot specify 'run-until-homogeneous' and 'num-steps'");
+  }
+
+  if (!FromString(FLAGS_dynamic, &config.dynamic)) {
+    throw std::invalid_argument("No dynamic named '" + FLAGS_dynamic + "'");
+  }
+
+  if (!FromString(FLAGS_engine, &config.engine)) {
+    throw std::invalid_argument("No engine named '" + FLAGS_engine + "'");
+  }
+
+  for (int n : ns) {
+    equilibrium::SimulationConfig config_ = config;
+    if (!GetGraph(FLAGS_graph_name, n, &config_.graph)) {
+      throw std::invalid_argument("No graph named '" + FLAGS_graph_name +
+                                  "'");
+    }
+    if (config_.engine == equilibrium::SimulationEngine::ENSEMBLE && !equilibrium::SupportsEnsemble(config_)) {
+      throw std::invalid_argument("The ensemble engine does not support this config");
+    }
+    if (config_.engine == equilibrium::SimulationEngine::LUMPED && !equilibrium::SupportsLumped(config_)) {
+      throw std::invalid_argument("The lumped engine does not support this config");
+    }
+    (*configs)[n] = config_;
+  }
+}
+
+#endif // EQUILIBRIUM_APPS_TRENDS_CONFIG_H_
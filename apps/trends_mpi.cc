@@ -0,0 +1,74 @@
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <equilibrium/distributed.h>
+#include <equilibrium/simulation.h>
+#include <equilibrium/writer.h>
+#include <gflags/gflags.h>
+#include <mpi.h>
+#include <omp.h>
+
+#include "mpi_gather.h"
+#include "trends_config.h"
+
+int main(int argc, char** argv) {
+  MPI_Init(&argc, &argv);
+  int rank, num_ranks;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &num_ranks);
+
+  gflags::SetUsageMessage(
+      "Simulate birth-death process across MPI ranks: capture absorption times");
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  std::vector<int> ns;
+  GetSampledNs(&ns);
+
+  std::map<int, equilibrium::SimulationConfig> configs;
+  GetConfigs(ns, &configs);
+
+  equilibrium::MetaData metadata;
+  metadata.tag = FLAGS_tag;
+  metadata.start_time = std::chrono::system_clock::now();
+
+  const auto range = equilibrium::GetTrialRange(FLAGS_num_simulations, rank, num_ranks);
+  equilibrium::Trends local_times;
+  if (!equilibrium::ComputeTrends(configs, range.first, range.last, &local_times)) {
+    throw std::overflow_error("Absorption times overflow a long long");
+  }
+
+  std::vector<long long> flat;
+  equilibrium::FlattenTrends(local_times, &flat);
+  std::vector<std::vector<long long>> gathered;
+  GatherToRoot(flat, rank, num_ranks, &gathered);
+
+  if (rank == 0) {
+    // Ranks own consecutive trial blocks, so appending in rank order keeps trial order.
+    equilibrium::Trends absorption_times;
+    for (const auto& rank_flat : gathered) {
+      if (!equilibrium::UnflattenTrends(rank_flat, &absorption_times)) {
+        throw std::runtime_error("Malformed trends from rank");
+      }
+    }
+    std::cout << "done" << std::endl;
+    metadata.end_time = std::chrono::system_clock::now();
+
+    const std::string output_file_name = equilibrium::GetOutputFileName("trends-", metadata.start_time);
+    std::ofstream ofs{"data/" + output_file_name + ".json"};
+    equilibrium::WriteTrendsToStream(
+     FLAGS_graph_name,
+     FLAGS_N,
+     FLAGS_exp_sample_rate,
+     absorption_times,
+     configs[ns[0]],
+     metadata,
+     &ofs
+    );
+  }
+
+  MPI_Finalize();
+}
@@ -0,0 +1,102 @@
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <equilibrium/fixation.h>
+#include <equilibrium/simulation.h>
+#include <equilibrium/statistics.h>
+#include <equilibrium/validate.h>
+#include <gflags/gflags.h>
+
+DEFINE_string(candidate, "ensemble",
+              "candidate: ensemble, lumped, common-random-numbers, batched-fixation or parallel-trajectory");
+DEFINE_string(graph_names, "complete,star,double-star,cycle", "graph-names: comma separated");
+DEFINE_string(ns, "5,12", "ns: comma separated");
+DEFINE_string(dynamics, "birth-death,death-birth", "dynamics: comma separated");
+DEFINE_string(mutation_rates, "0,0.05",
+              "mutation-rates: comma separated; 0 compares absorption times, others diversity counts");
+DEFINE_int32(num_steps, 100, "num-steps: of the diversity count cases");
+DEFINE_double(mutant_fitness, 1.5, "mutant-fitness: of the batched-fixation cases");
+DEFINE_int32(num_trials, 10000, "num-trials: per engine and case");
+DEFINE_double(resolution, 0,
+              "resolution: when set, enough trials for the KS test to catch CDFs this far apart");
+DEFINE_double(alpha, 0.001, "alpha: family-wise false alarm rate");
+DEFINE_int32(seed, 1, "seed");
+
+namespace {
+
+std::vector<std::string> SplitList(const std::string& list) {
+  std::vector<std::string> items;
+  std::istringstream list_stream{list};
+  std::string item;
+  while (std::getline(list_stream, item, ',')) items.emplace_back(item);
+  return items;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  gflags::SetUsageMessage(
+      "Simulate birth-death process with multiple mutations: check an engine against the scalar one");
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  equilibrium::ValidationConfig config;
+  if (!FromString(FLAGS_candidate, &config.candidate)) {
+    throw std::invalid_argument("No candidate named '" + FLAGS_candidate + "'");
+  }
+  config.graph_names = SplitList(FLAGS_graph_names);
+  config.ns.clear();
+  for (const auto& n : SplitList(FLAGS_ns)) config.ns.emplace_back(std::stoi(n));
+  config.dynamics.clear();
+  for (const auto& dynamic_str : SplitList(FLAGS_dynamics)) {
+    equilibrium::Dynamic dynamic;
+    if (!FromString(dynamic_str, &dynamic)) {
+      throw std::invalid_argument("No dynamic named '" + dynamic_str + "'");
+    }
+    config.dynamics.emplace_back(dynamic);
+  }
+  config.mutation_rates.clear();
+  for (const auto& rate : SplitList(FLAGS_mutation_rates)) config.mutation_rates.emplace_back(std::stod(rate));
+  config.num_steps = FLAGS_num_steps;
+  if (!equilibrium::IsValidFitness(FLAGS_mutant_fitness)) {
+    throw std::invalid_argument("Mutant fitness must be finite and positive");
+  }
+  config.mutant_fitness = FLAGS_mutant_fitness;
+  config.num_trials = FLAGS_num_trials;
+  config.alpha = FLAGS_alpha;
+  config.seed = FLAGS_seed;
+  if (FLAGS_resolution > 0) {
+    // KolmogorovSmirnovResolution with n = m, solved for n.
+    const double critical = std::sqrt(-0.5 * std::log(config.alpha / 2));
+    config.num_trials = static_cast<int>(std::ceil(2 * std::pow(critical / FLAGS_resolution, 2)));
+  }
+
+  std::vector<equilibrium::ValidationResult> results;
+  if (!equilibrium::RunValidation(config, &results)) {
+    throw std::invalid_argument("Bad graph names '" + FLAGS_graph_names + "'");
+  }
+
+  std::cout << "candidate " << FLAGS_candidate << ", " << config.num_trials << " trials per engine, KS resolution "
+            << equilibrium::KolmogorovSmirnovResolution(config.num_trials, config.num_trials, config.alpha)
+            << std::endl;
+  int num_failed = 0;
+  for (const auto& result : results) {
+    std::string dynamic_str;
+    ToString(result.dynamic, &dynamic_str);
+    std::cout << (result.passed ? "ok   " : "FAIL ") << result.graph_name << " n=" << result.n << " "
+              << dynamic_str << " mutation_rate=" << result.mutation_rate << " " << result.quantity
+              << std::setprecision(3)
+              << " chi2=" << result.chi_square.statistic << "/" << result.chi_square.degrees_of_freedom
+              << " p=" << result.chi_square.p_value
+              << " ks=" << result.kolmogorov_smirnov.statistic << " p=" << result.kolmogorov_smirnov.p_value
+              << std::setprecision(6) << std::endl;
+    if (!result.passed) ++num_failed;
+  }
+  const int num_results = static_cast<int>(results.size());
+  std::cout << num_results - num_failed << " of " << num_results << " comparisons passed" << std::endl;
+  return num_failed == 0 ? 0 : 1;
+}
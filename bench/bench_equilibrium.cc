@@ -0,0 +1,281 @@
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <equilibrium/fixation.h>
+#include <equilibrium/graph.h>
+#include <equilibrium/parallel_trajectory.h>
+#include <equilibrium/progress.h>
+#include <equilibrium/simulation.h>
+#include <equilibrium/writer.h>
+#include <omp.h>
+
+namespace {
+
+const std::vector<std::string> kGraphNames = {
+    "complete", "star", "cycle", "double-star", "line", "contracting-path", "barbell",
+};
+
+const int kNumSteps = 100000;
+
+equilibrium::SimulationConfig MakeConfig(const std::string& graph_name, int N, equilibrium::Dynamic dynamic) {
+  equilibrium::SimulationConfig config;
+  config.birth_mutation_rate = 0.01;
+  config.independent_mutation_rate = 0;
+  config.num_steps = kNumSteps;
+  config.num_simulations = 1;
+  config.dynamic = dynamic;
+  equilibrium::GetGraph(graph_name, N, &config.graph);
+  config.capture_history = false;
+  config.history_sample_rate = -1;
+  config.compute_stats = false;
+  config.start_with_max_diversity = false;
+  config.run_until_homogeneous = false;
+  config.seed = 1;
+  return config;
+}
+
+std::vector<int> RandomPopulation(int N, int num_types) {
+  std::mt19937 rng(1);
+  std::uniform_int_distribution<> type_dist(0, num_types - 1);
+  std::vector<int> location_to_type(N);
+  for (auto& type : location_to_type) type = type_dist(rng);
+  return location_to_type;
+}
+
+void SimulateArgs(benchmark::internal::Benchmark* b) {
+  for (int graph = 0; graph < static_cast<int>(kGraphNames.size()); ++graph) {
+    for (int N : {10, 100, 1000}) {
+      for (int dynamic : {0, 1}) {
+        b->Args({graph, N, dynamic});
+      }
+    }
+  }
+  b->ArgNames({"graph", "N", "dynamic"});
+}
+
+}  // namespace
+
+/// Steps/second of the simulation kernel; graph indexes kGraphNames,
+/// dynamic is 0 for birth-death and 1 for death-birth.
+static void BM_Simulate(benchmark::State& state) {
+  const auto& graph_name = kGraphNames[state.range(0)];
+  const auto dynamic = state.range(2) == 0 ? equilibrium::Dynamic::BIRTH_DEATH : equilibrium::Dynamic::DEATH_BIRTH;
+  const auto config = MakeConfig(graph_name, static_cast<int>(state.range(1)), dynamic);
+
+  int trial = 0;
+  for (auto _ : state) {
+    equilibrium::Simulate(config, trial++, nullptr, nullptr);
+  }
+  state.SetLabel(graph_name);
+  state.counters["steps_per_second"] = benchmark::Counter(
+      static_cast<double>(state.iterations()) * kNumSteps, benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_Simulate)->Apply(SimulateArgs)->Unit(benchmark::kMillisecond);
+
+/// Trials/second of the small-N absorption trials trends runs, building a
+/// fresh workspace per trial (0) or reusing one (1).
+static void BM_SimulateUntilHomogeneous(benchmark::State& state) {
+  auto config = MakeConfig("complete", static_cast<int>(state.range(0)), equilibrium::Dynamic::BIRTH_DEATH);
+  config.num_steps = 0;
+  config.birth_mutation_rate = 0;
+  config.start_with_max_diversity = true;
+  config.run_until_homogeneous = true;
+  config.compute_stats = true;
+  equilibrium::SimulationWorkspace workspace(config);
+  equilibrium::Stats stats;
+
+  int trial = 0;
+  for (auto _ : state) {
+    if (state.range(1)) {
+      equilibrium::Simulate(config, trial++, &workspace, &stats, nullptr);
+    } else {
+      equilibrium::Simulate(config, trial++, &stats, nullptr);
+    }
+  }
+  state.counters["trials_per_second"] = benchmark::Counter(
+      static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_SimulateUntilHomogeneous)->ArgsProduct({{4, 8, 16, 32}, {0, 1}})->ArgNames({"N", "reuse"});
+
+/// Strong scaling of one trajectory on a large sparse graph, from 1 thread to
+/// every core: events/second of SimulateParallel on a cycle of N locations.
+static void BM_SimulateParallel(benchmark::State& state) {
+  const int num_threads = static_cast<int>(state.range(1));
+  auto config = MakeConfig("cycle", static_cast<int>(state.range(0)), equilibrium::Dynamic::DEATH_BIRTH);
+  config.compute_stats = true;
+  const double end_time = 10.;
+
+  const int max_threads = omp_get_max_threads();
+  omp_set_num_threads(num_threads);
+  int trial = 0;
+  long long num_events = 0;
+  for (auto _ : state) {
+    equilibrium::Stats stats;
+    equilibrium::SimulateParallel(config, trial++, end_time, &stats, nullptr);
+    num_events += stats.number_of_steps;
+  }
+  omp_set_num_threads(max_threads);
+
+  state.counters["events_per_second"] = benchmark::Counter(
+      static_cast<double>(num_events), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_SimulateParallel)
+    ->Apply([](benchmark::internal::Benchmark* b) {
+      for (int N : {100000, 1000000}) {
+        for (int threads = 1; threads <= omp_get_max_threads(); ++threads) b->Args({N, threads});
+      }
+      b->ArgNames({"N", "threads"});
+    })
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+static void BM_NumberOfTypes(benchmark::State& state) {
+  const auto location_to_type = RandomPopulation(static_cast<int>(state.range(0)), 10);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(equilibrium::NumberOfTypes(location_to_type));
+  }
+  state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_NumberOfTypes)->RangeMultiplier(4)->Range(16, 4096)->Complexity();
+
+static void BM_NumberOfUnmatchingPairs(benchmark::State& state) {
+  const auto location_to_type = RandomPopulation(static_cast<int>(state.range(0)), 10);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(equilibrium::NumberOfUnmatchingPairs(location_to_type));
+  }
+  state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_NumberOfUnmatchingPairs)->RangeMultiplier(4)->Range(16, 4096)->Complexity();
+
+static void BM_NumberOfUnmatchingLinks(benchmark::State& state) {
+  const int N = static_cast<int>(state.range(0));
+  const auto graph = equilibrium::CompleteGraph(N);
+  const auto location_to_type = RandomPopulation(N, 10);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(equilibrium::NumberOfUnmatchingLinks(location_to_type, graph));
+  }
+  state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_NumberOfUnmatchingLinks)->RangeMultiplier(4)->Range(16, 4096)->Complexity();
+
+/// Thread scaling of the trial loop, from 1 thread to every core.
+static void BM_ComputeDiversityCounts(benchmark::State& state) {
+  const int num_threads = static_cast<int>(state.range(0));
+  auto config = MakeConfig("cycle", 100, equilibrium::Dynamic::BIRTH_DEATH);
+  config.num_steps = 10000;
+  config.num_simulations = 64;
+  config.compute_stats = true;
+
+  const int max_threads = omp_get_max_threads();
+  omp_set_num_threads(num_threads);
+  for (auto _ : state) {
+    equilibrium::DiversityCounts diversity_counts;
+    equilibrium::ComputeDiversityCounts(config, &diversity_counts);
+    benchmark::DoNotOptimize(diversity_counts);
+  }
+  omp_set_num_threads(max_threads);
+
+  state.counters["trials_per_second"] = benchmark::Counter(
+      static_cast<double>(state.iterations()) * config.num_simulations, benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_ComputeDiversityCounts)
+    ->DenseRange(1, omp_get_max_threads())
+    ->ArgName("threads")
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+static void BM_WriteDiversityCountsToStream(benchmark::State& state) {
+  const auto config = MakeConfig("complete", 100, equilibrium::Dynamic::BIRTH_DEATH);
+  equilibrium::DiversityCounts diversity_counts;
+  for (const auto& measure : equilibrium::DIVERSITY_MEASURES) {
+    for (int diversity = 0; diversity < state.range(0); ++diversity) {
+      diversity_counts[measure][diversity] = diversity + 1;
+    }
+  }
+  equilibrium::MetaData metadata;
+
+  int64_t bytes = 0;
+  for (auto _ : state) {
+    std::ostringstream os;
+    equilibrium::WriteDiversityCountsToStream(diversity_counts, config, metadata, &os);
+    bytes += static_cast<int64_t>(os.tellp());
+  }
+  state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_WriteDiversityCountsToStream)->RangeMultiplier(10)->Range(10, 10000);
+
+static void BM_WriteSimulationHistoryToStream(benchmark::State& state) {
+  auto config = MakeConfig("complete", 100, equilibrium::Dynamic::BIRTH_DEATH);
+  config.num_steps = static_cast<int>(state.range(0));
+  config.capture_history = true;
+  config.history_sample_rate = 100;
+
+  equilibrium::SimulationHistories histories(1);
+  equilibrium::Simulate(config, 0, nullptr, &histories[0]);
+  equilibrium::MetaData metadata;
+
+  int64_t bytes = 0;
+  for (auto _ : state) {
+    std::ostringstream os;
+    equilibrium::WriteSimulationHistoryToStream(histories, config, metadata, &os);
+    bytes += static_cast<int64_t>(os.tellp());
+  }
+  state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_WriteSimulationHistoryToStream)->RangeMultiplier(10)->Range(1000, 100000)->Unit(benchmark::kMillisecond);
+
+static void BM_WriteTrendsToStream(benchmark::State& state) {
+  const auto config = MakeConfig("complete", 100, equilibrium::Dynamic::BIRTH_DEATH);
+  equilibrium::Trends trends;
+  for (int n = 2; n <= 100; n *= 2) {
+    trends[n] = std::vector<long long>(static_cast<size_t>(state.range(0)), n * n);
+  }
+  equilibrium::MetaData metadata;
+
+  int64_t bytes = 0;
+  for (auto _ : state) {
+    std::ostringstream os;
+    equilibrium::WriteTrendsToStream("complete", 100, 2., trends, config, metadata, &os);
+    bytes += static_cast<int64_t>(os.tellp());
+  }
+  state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_WriteTrendsToStream)->RangeMultiplier(10)->Range(100, 100000)->Unit(benchmark::kMillisecond);
+
+/// Fixation trials/second; engine is 0 for scalar and 1 for batched.
+static void BM_ComputeFixation(benchmark::State& state) {
+  equilibrium::FixationConfig config;
+  config.dynamic = equilibrium::Dynamic::BIRTH_DEATH;
+  config.graph = equilibrium::CycleGraph(static_cast<int>(state.range(1)));
+  config.num_simulations = 4096;
+  config.seed = 1;
+  config.engine = state.range(0) == 0 ? equilibrium::FixationEngine::SCALAR : equilibrium::FixationEngine::BATCHED;
+
+  for (auto _ : state) {
+    equilibrium::FixationResults results;
+    equilibrium::ComputeFixation(config, &results);
+    benchmark::DoNotOptimize(results);
+  }
+  state.counters["trials_per_second"] = benchmark::Counter(
+      static_cast<double>(state.iterations()) * config.num_simulations, benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_ComputeFixation)
+    ->ArgsProduct({{0, 1}, {8, 32, 128}})
+    ->ArgNames({"engine", "N"})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+/// The per-trial progress hook every engine calls; compare with the cost of
+/// the smallest trials in BM_SimulateUntilHomogeneous. More threads must not
+/// slow it down.
+static void BM_RecordTrialProgress(benchmark::State& state) {
+  long long steps = 0;
+  for (auto _ : state) {
+    equilibrium::RecordTrialProgress(++steps);
+  }
+}
+BENCHMARK(BM_RecordTrialProgress)->ThreadRange(1, omp_get_max_threads());
+
+BENCHMARK_MAIN();
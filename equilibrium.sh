@@ -19,3 +19,14 @@ OMP_NUM_THREADS=100 \
   --num-steps=10000000 \
   --graph-name=complete \
   --num-simulations=10000
+
+# Across nodes: one MPI rank per task, OpenMP within each rank.
+# cmake -DEQUILIBRIUM_WITH_MPI=ON -DCMAKE_BUILD_TYPE=Release
+# Locally: mpirun -np 4 ./cmake-build-release/apps/cmake-build-debug/diversity_counts_mpi --seed=1 ...
+# srun ./cmake-build-release/apps/cmake-build-debug/diversity_counts_mpi \
+#   --N=100 \
+#   --birth-mutation-rate=0.01 \
+#   --num-steps=10000000 \
+#   --graph-name=complete \
+#   --num-simulations=10000 \
+#   --seed=1
@@ -0,0 +1,37 @@
+#ifndef EQUILIBRIUM_ALIAS_TABLE_H_
+#define EQUILIBRIUM_ALIAS_TABLE_H_
+
+#include <vector>
+
+namespace equilibrium {
+
+/// Walker/Vose alias tables for many rows of weights, stored back to back so
+/// that sampling a row touches one contiguous slice.
+class AliasTable {
+ public:
+  AliasTable() = default;
+  /// Rows with no weights must never be sampled; rows whose weights are all
+  /// zero sample -1.
+  explicit AliasTable(const std::vector<std::vector<double>>& rows);
+
+  int num_rows() const { return static_cast<int>(offsets_.size()) - 1; }
+  int row_size(int row) const { return offsets_[row+1] - offsets_[row]; }
+
+  /// Index within row drawn proportionally to its weight, for u in [0, 1),
+  /// or -1 when every weight of the row is zero. O(1).
+  int Sample(int row, double u) const {
+    const int offset = offsets_[row];
+    const double scaled = u * row_size(row);
+    const int i = static_cast<int>(scaled);
+    return scaled - i < probability_[offset + i] ? i : alias_[offset + i];
+  }
+
+ private:
+  std::vector<int> offsets_;
+  std::vector<double> probability_;
+  std::vector<int> alias_;
+};
+
+} // namespace equilibrium
+
+#endif // EQUILIBRIUM_ALIAS_TABLE_H_
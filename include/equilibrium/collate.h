@@ -0,0 +1,27 @@
+#ifndef EQUILIBRIUM_COLLATE_H_
+#define EQUILIBRIUM_COLLATE_H_
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace equilibrium {
+
+using CsvRow = std::vector<std::string>;
+
+/// Same columns, in the same order, as scripts/data-to-csv.py.
+const std::vector<std::string>& CollateColumns();
+
+/// Streams one diversity-counts result and appends a row per (measure,
+/// diversity) when its metadata tag equals tag. Parsing stops as soon as
+/// the tag is known not to match. Other result kinds yield no rows. False
+/// on malformed input.
+bool CollateDiversityCounts(std::istream* is, const std::string& tag, std::vector<CsvRow>* rows);
+
+/// RFC 4180 quoting only where needed.
+void WriteCsvRow(const CsvRow& row, std::ostream* os);
+
+} // namespace equilibrium
+
+#endif // EQUILIBRIUM_COLLATE_H_
@@ -0,0 +1,34 @@
+#ifndef EQUILIBRIUM_DISTRIBUTED_H_
+#define EQUILIBRIUM_DISTRIBUTED_H_
+
+#include <vector>
+
+#include "simulation.h"
+
+namespace equilibrium {
+
+/// Trials [first, last) owned by one rank.
+struct TrialRange {
+  int first;
+  int last;
+};
+
+/// Splits num_trials into contiguous, near-equal blocks; rank r gets block r.
+/// Together with seeded trials this makes results independent of num_ranks.
+TrialRange GetTrialRange(int num_trials, int rank, int num_ranks);
+
+void MergeDiversityCounts(const DiversityCounts& from, DiversityCounts* into);
+
+/// Flat integer encodings used to ship results between ranks.
+/// DiversityCounts: (measure, diversity, count) int triples.
+/// Trends: for every n, (n, number of times, times...) as long long.
+void FlattenDiversityCounts(const DiversityCounts&, std::vector<int>* flat);
+bool UnflattenDiversityCounts(const std::vector<int>& flat, DiversityCounts*);
+void FlattenTrends(const Trends&, std::vector<long long>* flat);
+/// Appends the decoded times to trends, so decoding rank blocks in rank order
+/// keeps trends[n] in trial order.
+bool UnflattenTrends(const std::vector<long long>& flat, Trends*);
+
+} // namespace equilibrium
+
+#endif // EQUILIBRIUM_DISTRIBUTED_H_
@@ -0,0 +1,46 @@
+#ifndef EQUILIBRIUM_ENSEMBLE_H_
+#define EQUILIBRIUM_ENSEMBLE_H_
+
+#include <cstdint>
+#include <map>
+
+#include "fixation.h"
+#include "simulation.h"
+
+namespace equilibrium {
+
+/// Trials an ensemble block advances together.
+const int kEnsembleLanes = 32;
+/// Trials handed to an OpenMP thread at a time.
+const int kEnsembleBatchSize = 1024;
+
+/// The ensemble engine only runs plain absorption trials: run until
+/// homogeneous, no mutations, uniform rates, unweighted edges, and nothing
+/// tracked beyond the number of steps.
+bool SupportsEnsemble(const SimulationConfig&);
+
+/// Runs trials [first_trial, last_trial) of config kEnsembleLanes at a time
+/// and writes the number of steps of trial k to steps[k - first_trial].
+///
+/// Location i of every lane is stored next to location i of the other lanes,
+/// lanes draw from their own xoshiro128** streams in `omp simd` loops, and
+/// each round steps every lane once, so the lanes' independent loads overlap.
+/// A lane that becomes homogeneous is refilled with the next trial. Trial k's
+/// stream depends only on (base_seed, k), so results do not depend on how
+/// trials are split. Same distribution as Simulate, not the same draws.
+void RunEnsembleBlock(
+    const SimulationConfig&,
+    const NeighborTable&,
+    std::uint64_t base_seed,
+    int first_trial,
+    int last_trial,
+    int* steps
+);
+
+/// ComputeTrends for configs whose engine is ENSEMBLE.
+void ComputeEnsembleTrends(const std::map<int, SimulationConfig>& configs, int first_trial, int last_trial,
+                           Trends* trends, TrendSummaries* summaries);
+
+} // namespace equilibrium
+
+#endif // EQUILIBRIUM_ENSEMBLE_H_
@@ -0,0 +1,37 @@
+#ifndef EQUILIBRIUM_FENWICK_TREE_H_
+#define EQUILIBRIUM_FENWICK_TREE_H_
+
+#include <vector>
+
+namespace equilibrium {
+
+/// Non-negative weights with O(log N) update and O(log N) sampling of an index
+/// proportional to its weight.
+class FenwickTree {
+ public:
+  FenwickTree() = default;
+  explicit FenwickTree(int size);
+
+  /// O(N).
+  void Reset(const std::vector<double>& weights);
+  void Set(int index, double weight);
+  void Add(int index, double delta);
+
+  int size() const { return static_cast<int>(weights_.size()); }
+  double weight(int index) const { return weights_[index]; }
+  double total() const { return total_; }
+
+  /// Smallest index whose inclusive prefix sum exceeds u, for u in [0, total()).
+  int Find(double u) const;
+
+ private:
+  std::vector<double> weights_;
+  /// 1-based partial sums.
+  std::vector<double> tree_;
+  double total_ = 0;
+  int high_bit_ = 0;
+};
+
+} // namespace equilibrium
+
+#endif // EQUILIBRIUM_FENWICK_TREE_H_
@@ -0,0 +1,150 @@
+#ifndef EQUILIBRIUM_FIXATION_H_
+#define EQUILIBRIUM_FIXATION_H_
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "graph.h"
+#include "random.h"
+#include "simulation.h"
+#include "statistics.h"
+
+namespace equilibrium {
+
+/// Every trial places the mutant on a uniformly random node.
+const int kRandomStartNode = -1;
+/// Trial k places the mutant on node k % N, so every node gets the same effort.
+const int kEveryStartNode = -2;
+
+enum class FixationEngine {
+  /// One trial at a time, see RunFixationTrial.
+  SCALAR,
+  /// kFixationLanes trials in lockstep, see RunFixationBlock.
+  BATCHED,
+};
+
+bool FromString(const std::string&, FixationEngine*);
+bool ToString(const FixationEngine&, std::string*);
+
+/// Trials the batched engine advances together: one bit of a word per trial.
+const int kFixationLanes = 64;
+
+struct FixationConfig {
+  Dynamic dynamic;
+  Graph graph;
+  /// Reproductive (BD) or replacement (DB) weight of the mutant; 1 is neutral.
+  /// Must pass IsValidFitness.
+  double mutant_fitness = 1.;
+  /// A node, kRandomStartNode or kEveryStartNode.
+  int start_node = kRandomStartNode;
+  int num_simulations;
+  int seed = kNoSeed;
+  /// Give up on a trial after this many steps; 0 never gives up.
+  long long max_steps = 0;
+  /// Trials handed to an OpenMP thread at a time.
+  int batch_size = 1024;
+  FixationEngine engine = FixationEngine::SCALAR;
+};
+
+/// Two-type population, one bit per location (1 = mutant).
+class TwoTypePopulation {
+ public:
+  void Reset(int size);
+
+  bool IsMutant(int location) const { return (words_[location >> 6] >> (location & 63)) & 1; }
+  void Set(int location, bool mutant) {
+    const std::uint64_t bit = std::uint64_t{1} << (location & 63);
+    auto& word = words_[location >> 6];
+    num_mutants_ += static_cast<int>(mutant) - static_cast<int>((word & bit) != 0);
+    word = mutant ? (word | bit) : (word & ~bit);
+  }
+
+  int size() const { return size_; }
+  int num_mutants() const { return num_mutants_; }
+  bool IsAbsorbed() const { return num_mutants_ == 0 || num_mutants_ == size_; }
+
+ private:
+  int size_ = 0;
+  int num_mutants_ = 0;
+  std::vector<std::uint64_t> words_;
+};
+
+enum class FixationOutcome {
+  EXTINCTION,
+  FIXATION,
+  /// Hit max_steps first.
+  UNDECIDED,
+};
+
+struct FixationTrial {
+  int start_node;
+  FixationOutcome outcome;
+  long long steps;
+};
+
+struct FixationResult {
+  long long trials = 0;
+  long long fixations = 0;
+  long long undecided = 0;
+  /// Steps, conditional on the outcome.
+  RunningMoments fixation_time;
+  RunningMoments extinction_time;
+};
+
+/// Keyed by start node.
+using FixationResults = std::map<int, FixationResult>;
+
+/// Finite and positive. Proposals are rejected in proportion to fitness, so
+/// at fitness 0 a population whose candidates are all mutants never moves.
+bool IsValidFitness(double fitness);
+
+int GetStartNode(const FixationConfig&, int trial, Xoshiro256& rng);
+
+/// Continues the two-type dynamic from *population until it absorbs, holds
+/// target_mutants mutants, or *steps reaches max_steps (0: no limit). Adds
+/// the steps taken to *steps.
+void AdvanceFixation(const FixationConfig&, int target_mutants, long long max_steps, Xoshiro256& rng,
+                     TwoTypePopulation* population, long long* steps);
+
+/// Runs one invasion from a single mutant at start_node until it fixes or
+/// goes extinct. population is scratch space, reused across trials.
+void RunFixationTrial(const FixationConfig&, int start_node, Xoshiro256& rng, TwoTypePopulation* population, FixationTrial*);
+
+/// Neighbors in compressed sparse row form, in the direction the dynamic
+/// samples them: neighbors of i are targets[offsets[i] .. offsets[i+1]).
+struct NeighborTable {
+  std::vector<int> offsets;
+  std::vector<int> targets;
+};
+
+void GetNeighborTable(const Graph&, const Dynamic&, NeighborTable*);
+
+/// Runs trials [first_trial, last_trial) kFixationLanes at a time. Location i
+/// of every lane is bit `lane` of one word, lanes draw from their own
+/// xoshiro128** streams in `omp simd` loops, and a lane that absorbs is
+/// refilled with the next trial. Trial k's stream depends only on
+/// (base_seed, k), so results do not depend on how trials are split. When
+/// trials is set, it must hold last_trial - first_trial entries and
+/// (*trials)[k - first_trial] receives trial k.
+void RunFixationBlock(
+    const FixationConfig&,
+    const NeighborTable&,
+    std::uint64_t base_seed,
+    int first_trial,
+    int last_trial,
+    FixationResults*,
+    std::vector<FixationTrial>* trials = nullptr
+);
+
+void AddFixationTrial(const FixationTrial&, FixationResults*);
+void MergeFixationResult(const FixationResult& from, FixationResult* into);
+void MergeFixationResults(const FixationResults& from, FixationResults* into);
+
+/// Runs config.num_simulations trials in per-thread batches.
+void ComputeFixation(const FixationConfig&, FixationResults*);
+
+} // namespace equilibrium
+
+#endif // EQUILIBRIUM_FIXATION_H_
@@ -0,0 +1,60 @@
+#ifndef EQUILIBRIUM_GENEALOGY_H_
+#define EQUILIBRIUM_GENEALOGY_H_
+
+#include <unordered_map>
+#include <vector>
+
+namespace equilibrium {
+
+const int kNoAncestry = -1;
+
+struct GenealogyNode {
+  int type;
+  /// kNoAncestry for initial types and independent mutations.
+  int parent;
+  int birth_step;
+  /// Number of locations currently holding this type.
+  int abundance;
+};
+
+/// Type tree restricted to the ancestors of living types. A type is dropped
+/// as soon as it holds no location and has no living descendants, so memory
+/// follows the current diversity instead of the number of mutations so far.
+class Genealogy {
+ public:
+  /// Every type in location_to_type becomes a root born at step 0.
+  void Reset(const std::vector<int>& location_to_type);
+  /// type must be new; it holds no location until Replace gives it one.
+  void AddType(int type, int parent, int step);
+  /// One location changes from old_type to new_type.
+  void Replace(int old_type, int new_type);
+
+  int size() const { return static_cast<int>(nodes_.size()); }
+
+  /// Most recent type that every living type descends from (inclusive), or
+  /// kNoAncestry when the living types descend from different roots.
+  int MostRecentCommonAncestor() const;
+  /// step minus the birth step of the most recent common ancestor, or -1.
+  int TimeToMostRecentCommonAncestor(int step) const;
+
+  /// Sorted by type.
+  void GetNodes(std::vector<GenealogyNode>* nodes) const;
+
+ private:
+  struct Node {
+    int parent;
+    int birth_step;
+    int abundance;
+    std::vector<int> children;
+  };
+
+  /// Drops type and any ancestors it was keeping alive.
+  void Prune(int type);
+
+  std::unordered_map<int, Node> nodes_;
+  int num_roots_ = 0;
+};
+
+} // namespace equilibrium
+
+#endif // EQUILIBRIUM_GENEALOGY_H_
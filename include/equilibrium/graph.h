@@ -1,28 +1,48 @@
 #ifndef EQUILIBRIUM_GRAPH_H_
 #define EQUILIBRIUM_GRAPH_H_
 
+#include <istream>
+#include <memory>
 #include <string>
 #include <vector>
 
 namespace equilibrium {
 
+/// Edges never change once built, so copies of a graph share them and cost
+/// O(1) rather than O(E).
 class Graph {
  public:
   Graph() = default;
   Graph(const int size, const std::string& name, const std::vector<std::vector<int>>& out_edges);
+  /// out_weights[i][k] is the weight of the edge to out_edges[i][k].
+  Graph(const int size, const std::string& name, const std::vector<std::vector<int>>& out_edges,
+        const std::vector<std::vector<double>>& out_weights);
 
   const int& size() const { return size_; }
   const std::string& name() const { return name_; }
-  const std::vector<std::vector<int>>& out_edges() const { return out_edges_; }
-  const std::vector<std::vector<int>>& in_edges() const { return in_edges_; }
+  const std::vector<std::vector<int>>& out_edges() const { return edges_->out_edges; }
+  const std::vector<std::vector<int>>& in_edges() const { return edges_->in_edges; }
+  /// Empty unless weighted(); otherwise parallel to out_edges() and in_edges().
+  const std::vector<std::vector<double>>& out_weights() const { return edges_->out_weights; }
+  const std::vector<std::vector<double>>& in_weights() const { return edges_->in_weights; }
+  bool weighted() const { return !edges_->out_weights.empty(); }
+
+  /// A copy with edges of its own, allocated by the calling thread.
+  Graph DeepCopy() const;
 
  private:
-  void ComputeInEdges();
+  struct Edges {
+    std::vector<std::vector<int>> out_edges;
+    std::vector<std::vector<int>> in_edges;
+    std::vector<std::vector<double>> out_weights;
+    std::vector<std::vector<double>> in_weights;
+  };
+
+  static void ComputeInEdges(int size, Edges* edges);
 
   int size_;
   std::string name_;
-  std::vector<std::vector<int>> out_edges_;
-  std::vector<std::vector<int>> in_edges_;
+  std::shared_ptr<const Edges> edges_ = std::make_shared<const Edges>();
 };
 
 Graph CompleteGraph(int N);
@@ -52,6 +72,12 @@ bool GetGraph(const std::string& graph_name, int N, Graph* graph);
 
 bool IsBidirectional(const Graph&);
 
+/// Reads "from to weight" lines and weights the matching edges of graph.
+/// Unlisted edges keep weight 1. Fails on unknown edges or negative weights.
+/// A location whose edges all have weight 0 takes no part in the second step
+/// of the dynamic: its steps do nothing, as for an isolated location.
+bool ReadEdgeWeights(std::istream* is, Graph* graph);
+
 
 } // namespace equilibrium
 
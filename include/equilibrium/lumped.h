@@ -0,0 +1,49 @@
+#ifndef EQUILIBRIUM_LUMPED_H_
+#define EQUILIBRIUM_LUMPED_H_
+
+#include <map>
+#include <vector>
+
+#include "graph.h"
+#include "random.h"
+#include "simulation.h"
+
+namespace equilibrium {
+
+/// The orbits of a graph whose symmetries leave few of them: the complete
+/// graph (one orbit), or hubs joined to each other, each with its own
+/// leaves (star, double star).
+struct LumpedGraph {
+  int size = 0;
+  bool complete = false;
+  /// Leaves of each hub; empty for the complete graph.
+  std::vector<int> hub_leaves;
+};
+
+/// Recognises CompleteGraph, StarGraph and DoubleStarGraph by name, and
+/// checks in O(N) that the edges have that shape.
+bool GetLumpedGraph(const Graph&, LumpedGraph*);
+
+/// The lumped engine runs the same absorption trials as the ensemble engine,
+/// on graphs GetLumpedGraph recognises.
+bool SupportsLumped(const SimulationConfig&);
+
+/// Steps until config becomes homogeneous, in distribution the same as
+/// Simulate. Starting from N distinct types, that is the time for the
+/// ancestral lineages of every location, followed back through the same
+/// steps, to coalesce into one. Those lineages are tracked as counts per
+/// orbit, and steps that change no count are skipped in one geometric draw,
+/// so a trial costs O(N) events on the complete graph and O(N log N) on
+/// stars, whatever the number of steps. False when the steps overflow a
+/// long long, as they do on birth-death stars of a few million locations.
+bool RunLumpedTrial(const SimulationConfig&, const LumpedGraph&, Xoshiro256& rng, long long* steps);
+
+/// ComputeTrends for configs whose engine is LUMPED. Trial k draws from
+/// (seed, k), so results do not depend on how trials are split. False when
+/// some trial overflowed.
+bool ComputeLumpedTrends(const std::map<int, SimulationConfig>& configs, int first_trial, int last_trial,
+                         Trends* trends, TrendSummaries* summaries);
+
+} // namespace equilibrium
+
+#endif // EQUILIBRIUM_LUMPED_H_
@@ -0,0 +1,96 @@
+#ifndef EQUILIBRIUM_MEASURES_H_
+#define EQUILIBRIUM_MEASURES_H_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "graph.h"
+#include "statistics.h"
+
+namespace equilibrium {
+
+struct MeasureResult {
+  std::string name;
+  std::vector<double> final;
+  /// Each value weighted by the number of steps it was held.
+  std::vector<double> time_average;
+};
+
+/// Across trials, one entry per value of the measure.
+struct MeasureSummary {
+  std::vector<RunningMoments> final;
+  std::vector<RunningMoments> time_average;
+};
+
+using MeasureSummaries = std::map<std::string, MeasureSummary>;
+
+/// A diversity measure kept up to date one replacement at a time, so its
+/// cost per event is independent of N (or proportional to a degree).
+///
+/// Type ids must be below N + 1, as handed out by TypeAllocator. Subclasses
+/// report changes through SetValue; time averages are integrated lazily, per
+/// value, only when it changes.
+class MeasureTracker {
+ public:
+  explicit MeasureTracker(const std::string& name) : name_(name) {}
+  virtual ~MeasureTracker() = default;
+
+  const std::string& name() const { return name_; }
+
+  /// A fresh tracker sharing any precomputed tables with this one.
+  virtual std::unique_ptr<MeasureTracker> Clone() const = 0;
+
+  /// location_to_type must outlive the tracker's use and be updated before
+  /// each call to Replace.
+  void Reset(const std::vector<int>* location_to_type);
+  /// location just changed from old_type to new_type during step.
+  void Replace(int location, int old_type, int new_type, int step);
+
+  /// Values after step; time averages over [0, step].
+  void GetResult(int step, MeasureResult* result) const;
+  /// Current values only.
+  const std::vector<double>& values() const { return values_; }
+
+ protected:
+  virtual void DoReset() = 0;
+  virtual void DoReplace(int location, int old_type, int new_type) = 0;
+
+  void SetValue(int index, double value);
+  double value(int index) const { return values_[index]; }
+  int num_locations() const { return static_cast<int>(location_to_type_->size()); }
+  const std::vector<int>& location_to_type() const { return *location_to_type_; }
+
+  /// Sizes the values; call from DoReset.
+  void ResizeValues(int size);
+
+ private:
+  std::string name_;
+  const std::vector<int>* location_to_type_ = nullptr;
+  std::vector<double> values_;
+  std::vector<double> integrals_;
+  std::vector<int> last_steps_;
+  int step_ = 0;
+};
+
+/// "abundance_spectrum": number of types with abundance 1, ..., N.
+/// "shannon": Shannon entropy of type frequencies, in nats.
+/// "simpson": probability that two distinct locations share a type.
+/// "unmatching_pairs": unordered pairs of locations with different types.
+/// "unmatching_links": edges whose endpoints have different types.
+/// "autocorrelation_<k>": (F_k - F) / (1 - F), where F_k is the identity
+///   probability of locations k undirected hops apart and F is "simpson";
+///   0 when the population is homogeneous.
+bool MakeMeasureTracker(const std::string& name, const Graph& graph, std::shared_ptr<const MeasureTracker>* tracker);
+
+/// Comma separated names.
+bool MakeMeasureTrackers(const std::string& names, const Graph& graph,
+                         std::vector<std::shared_ptr<const MeasureTracker>>* trackers);
+
+void AddMeasureResult(const MeasureResult& result, MeasureSummaries* summaries);
+void MergeMeasureSummaries(const MeasureSummaries& from, MeasureSummaries* to);
+
+} // namespace equilibrium
+
+#endif // EQUILIBRIUM_MEASURES_H_
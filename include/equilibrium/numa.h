@@ -0,0 +1,76 @@
+#ifndef EQUILIBRIUM_NUMA_H_
+#define EQUILIBRIUM_NUMA_H_
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "simulation.h"
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+namespace equilibrium {
+
+/// The CPUs of each NUMA node that this process may run on, read from
+/// /sys/devices/system/node. Without that (or off Linux) every allowed CPU
+/// is on node 0.
+struct NumaTopology {
+  std::vector<std::vector<int>> node_cpus;
+
+  int num_nodes() const { return static_cast<int>(node_cpus.size()); }
+};
+
+void GetNumaTopology(NumaTopology*);
+
+/// Pins the calling thread to one CPU, spreading threads over the nodes:
+/// thread k runs on node k % num_nodes. Returns that node, or -1 when the
+/// thread could not be pinned.
+int PinThread(const NumaTopology&, int thread);
+
+/// PinThread for the lifetime of the object. The calling thread's CPU mask
+/// is saved first and restored on destruction, so that a thread pool does
+/// not stay pinned (and a later GetNumaTopology does not see a single CPU)
+/// after the parallel region ends.
+class ScopedThreadPin {
+ public:
+  ScopedThreadPin(const NumaTopology&, int thread);
+  ~ScopedThreadPin();
+
+  ScopedThreadPin(const ScopedThreadPin&) = delete;
+  ScopedThreadPin& operator=(const ScopedThreadPin&) = delete;
+
+  /// As returned by PinThread.
+  int node() const { return node_; }
+
+ private:
+  int node_ = -1;
+#ifdef __linux__
+  bool saved_ = false;
+  cpu_set_t saved_mask_;
+#endif
+};
+
+/// Heap bytes of the graph and rates that a replica copies.
+std::size_t ReplicaBytes(const SimulationConfig&);
+
+/// One copy of a config per NUMA node. The first thread to ask for a node's
+/// copy makes it, so when that thread is pinned to the node, first touch
+/// puts the copy's pages in the node's memory.
+class ConfigReplicas {
+ public:
+  ConfigReplicas(const SimulationConfig& config, int num_nodes);
+
+  /// Safe to call from concurrent threads. Sets *bytes_copied to the bytes
+  /// this call copied, 0 when the node already had its copy.
+  const SimulationConfig& Get(int node, std::size_t* bytes_copied);
+
+ private:
+  const SimulationConfig& config_;
+  std::vector<std::unique_ptr<SimulationConfig>> replicas_;
+};
+
+} // namespace equilibrium
+
+#endif // EQUILIBRIUM_NUMA_H_
@@ -0,0 +1,39 @@
+#ifndef EQUILIBRIUM_PARALLEL_TRAJECTORY_H_
+#define EQUILIBRIUM_PARALLEL_TRAJECTORY_H_
+
+#include <vector>
+
+#include "simulation.h"
+
+namespace equilibrium {
+
+/// Mean events per location in each window of SimulateParallel. Longer
+/// windows amortise the per-window O(N) passes but lengthen dependency chains.
+const double kParallelWindowEvents = 2.;
+
+/// SimulateParallel runs the continuous-time version of the dynamic: birth
+/// mutations, node rates and edge weights, but no independent mutations and
+/// nothing tracked beyond the final population.
+bool SupportsParallelTrajectory(const SimulationConfig&);
+
+/// One continuous-time trajectory of config over [0, end_time], using every
+/// OpenMP thread. Location i fires as a Poisson process of rate node_rates[i]
+/// (1 when empty), so the total process is the one Simulate follows with
+/// continuous_time, observed at a fixed time rather than after a fixed number
+/// of steps.
+///
+/// Time advances in windows. In each window, every location generates its own
+/// events (time, neighbor, mutation coin) from its own stream, seeded from
+/// (seed, trial, location), with the locations split across threads. An event
+/// touches its birther and its dier. It runs once every earlier event on
+/// either location has run. Events on disjoint locations run concurrently,
+/// level by level, with no rollback. The result is exactly the sequential
+/// time-ordered trajectory, whatever the number of threads.
+///
+/// Stats::number_of_steps counts events; location_to_type may be null.
+void SimulateParallel(const SimulationConfig& config, int trial, double end_time, Stats* stats,
+                      std::vector<int>* location_to_type);
+
+} // namespace equilibrium
+
+#endif // EQUILIBRIUM_PARALLEL_TRAJECTORY_H_
@@ -0,0 +1,56 @@
+#ifndef EQUILIBRIUM_PROFILE_H_
+#define EQUILIBRIUM_PROFILE_H_
+
+#include <chrono>
+#include <vector>
+
+namespace equilibrium {
+
+/// Configure with -DEQUILIBRIUM_PROFILE=ON to compile the counters in.
+/// Otherwise every `if (kProfile)` block is dead code.
+#ifdef EQUILIBRIUM_PROFILE
+const bool kProfile = true;
+#else
+const bool kProfile = false;
+#endif
+
+struct Profile {
+  int thread = 0;
+  /// NUMA node the thread was pinned to, -1 when unpinned.
+  int numa_node = -1;
+  long long trials = 0;
+  long long steps = 0;
+  /// Steps that changed the type of some location.
+  long long effective_steps = 0;
+  long long mutations = 0;
+  long long rng_draws = 0;
+  long long history_snapshots = 0;
+  double burn_in_seconds = 0;
+  double stats_seconds = 0;
+  double serialisation_seconds = 0;
+  /// Graph and rates this thread copied for its node, see ConfigReplicas.
+  long long replica_bytes = 0;
+};
+
+/// Adds `from` into `into`, leaving into->thread and into->numa_node unchanged.
+void MergeProfile(const Profile& from, Profile* into);
+
+/// The calling thread's accumulated profile. Simulate accumulates locally and
+/// merges here once per trial, so the hot loop never touches shared state.
+Profile& ThreadProfile();
+
+/// Every thread's profile, ordered by OpenMP thread number.
+void CollectProfiles(std::vector<Profile>* profiles);
+void ResetProfiles();
+
+/// Start of a profiled interval: steady_clock::now(), but without reading the
+/// clock when profiling is compiled out.
+inline std::chrono::steady_clock::time_point ProfileNow() {
+  return kProfile ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+}
+
+double SecondsSince(const std::chrono::steady_clock::time_point& start);
+
+} // namespace equilibrium
+
+#endif // EQUILIBRIUM_PROFILE_H_
@@ -0,0 +1,85 @@
+#ifndef EQUILIBRIUM_PROGRESS_H_
+#define EQUILIBRIUM_PROGRESS_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+
+namespace equilibrium {
+
+/// Counts a finished trial of the calling thread. Every engine calls it once
+/// per trial, with the steps it has not already passed to
+/// RecordStepProgress. Each thread owns a counter slot, padded so that no
+/// two share a cache line, and is its only writer: the update is a relaxed
+/// load and store, with no lock and no read-modify-write.
+void RecordTrialProgress(long long steps);
+
+/// Steps between flushes of a running trial's steps.
+const int kProgressStepsPerFlush = 1 << 16;
+
+/// Counts steps of a trial that is still running, so that a run of a few
+/// long trials shows its throughput before any of them ends. The scalar
+/// engines call it every kProgressStepsPerFlush steps.
+void RecordStepProgress(long long steps);
+
+/// Trials and steps recorded by every thread since the process started.
+void GetTrialProgress(long long* trials, long long* steps);
+
+struct ProgressStatus {
+  long long trials = 0;
+  /// 0 when unknown.
+  long long total_trials = 0;
+  long long steps = 0;
+  /// 0 when unknown.
+  long long total_steps = 0;
+  double elapsed_seconds = 0;
+  double trials_per_second = 0;
+  double steps_per_second = 0;
+  /// At the average rate so far, of steps when total_steps is known and of
+  /// trials otherwise; -1 when unknown.
+  double eta_seconds = -1;
+  bool done = false;
+};
+
+/// One line, for stderr.
+void WriteProgressLine(const ProgressStatus&, std::ostream*);
+void WriteProgressJson(const ProgressStatus&, std::ostream*);
+
+/// Samples the trial counters from a thread of its own, every interval, and
+/// writes a ProgressStatus line to stderr and, unless status_file is empty,
+/// JSON to status_file, replaced by rename so readers never see half of it.
+/// Counts trials from construction. Destruction writes a last, done report.
+/// total_trials and total_steps are 0 when unknown.
+class ProgressReporter {
+ public:
+  ProgressReporter(long long total_trials, long long total_steps, double interval_seconds,
+                   const std::string& status_file);
+  ~ProgressReporter();
+
+  ProgressReporter(const ProgressReporter&) = delete;
+  ProgressReporter& operator=(const ProgressReporter&) = delete;
+
+  ProgressStatus GetStatus() const;
+
+ private:
+  void Report(bool done);
+
+  const long long total_trials_;
+  const long long total_steps_;
+  const std::chrono::duration<double> interval_;
+  const std::string status_file_;
+  const std::chrono::steady_clock::time_point start_;
+  long long start_trials_ = 0;
+  long long start_steps_ = 0;
+  std::mutex mutex_;
+  std::condition_variable stop_;
+  bool stopping_ = false;
+  std::thread thread_;
+};
+
+} // namespace equilibrium
+
+#endif // EQUILIBRIUM_PROGRESS_H_
@@ -0,0 +1,195 @@
+#ifndef EQUILIBRIUM_RANDOM_H_
+#define EQUILIBRIUM_RANDOM_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace equilibrium {
+
+/// Advances *state and returns the next SplitMix64 output.
+inline std::uint64_t SplitMix64(std::uint64_t* state) {
+  std::uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+/// xoshiro256**. Seeding is O(1), unlike std::mt19937, so even very short
+/// trials can afford their own stream.
+class Xoshiro256 {
+ public:
+  using result_type = std::uint64_t;
+
+  Xoshiro256(std::uint64_t seed, std::uint64_t stream) {
+    std::uint64_t state = seed ^ SplitMix64(&stream);
+    for (auto& s : s_) s = SplitMix64(&state);
+  }
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+  result_type operator()() {
+    const std::uint64_t result = Rotl(s_[1] * 5, 7) * 9;
+    const std::uint64_t t = s_[1] << 17;
+    s_[2] ^= s_[0];
+    s_[3] ^= s_[1];
+    s_[1] ^= s_[2];
+    s_[0] ^= s_[3];
+    s_[2] ^= t;
+    s_[3] = Rotl(s_[3], 45);
+    return result;
+  }
+
+ private:
+  static std::uint64_t Rotl(std::uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+  std::uint64_t s_[4];
+};
+
+/// Generates the same words as std::seed_seq over two or three seeds, so
+/// std::mt19937::seed(sequence) reaches the same state, but allocates nothing
+/// and walks its indices instead of taking them modulo the output size. The
+/// library's divisions dominate the cost of seeding a short trial.
+class SeedSequence {
+ public:
+  using result_type = std::uint32_t;
+
+  SeedSequence(result_type a, result_type b) : v_{a, b, 0}, size_(2) {}
+  SeedSequence(result_type a, result_type b, result_type c) : v_{a, b, c}, size_(3) {}
+
+  std::size_t size() const { return size_; }
+  template <typename OutputIt>
+  void param(OutputIt dest) const { std::copy(v_, v_ + size_, dest); }
+
+  template <typename RandomIt>
+  void generate(RandomIt begin, RandomIt end) const {
+    const std::size_t n = end - begin;
+    if (n == 0) return;
+    std::fill(begin, end, 0x8b8b8b8bu);
+    const std::size_t t = n >= 623 ? 11 : n >= 68 ? 7 : n >= 39 ? 5 : n >= 7 ? 3 : (n - 1) / 2;
+    const std::size_t p = (n - t) / 2;
+    const std::size_t q = p + t;
+    const std::size_t m = std::max(size_ + 1, n);
+
+    // k, k + p, k + q and k - 1, all modulo n.
+    std::size_t i = 0;
+    std::size_t ip = p % n;
+    std::size_t iq = q % n;
+    std::size_t im = n - 1;
+    const auto next = [n](std::size_t* index) {
+      if (++*index == n) *index = 0;
+    };
+    const auto word = [&begin](std::size_t index) { return static_cast<result_type>(begin[index]); };
+
+    for (std::size_t k = 0; k < m; ++k) {
+      const result_type r1 = 1664525u * Mix(word(i) ^ word(ip) ^ word(im));
+      const std::size_t offset = k == 0 ? size_ : k <= size_ ? i + v_[k - 1] : i;
+      const result_type r2 = r1 + static_cast<result_type>(offset);
+      begin[ip] = static_cast<result_type>(word(ip) + r1);
+      begin[iq] = static_cast<result_type>(word(iq) + r2);
+      begin[i] = r2;
+      next(&i);
+      next(&ip);
+      next(&iq);
+      next(&im);
+    }
+    for (std::size_t k = m; k < m + n; ++k) {
+      const result_type r3 = 1566083941u * Mix(word(i) + word(ip) + word(im));
+      const result_type r4 = r3 - static_cast<result_type>(i);
+      begin[ip] = word(ip) ^ r3;
+      begin[iq] = word(iq) ^ r4;
+      begin[i] = r4;
+      next(&i);
+      next(&ip);
+      next(&iq);
+      next(&im);
+    }
+  }
+
+ private:
+  static result_type Mix(result_type x) { return x ^ (x >> 27); }
+
+  result_type v_[3];
+  std::size_t size_;
+};
+
+/// Uniform integer in [0, n), n > 0 (Lemire's multiply-shift with rejection).
+template <typename Rng>
+inline std::uint32_t UniformIndex(Rng& rng, std::uint32_t n) {
+  std::uint64_t m = static_cast<std::uint64_t>(static_cast<std::uint32_t>(rng() >> 32)) * n;
+  std::uint32_t low = static_cast<std::uint32_t>(m);
+  if (low < n) {
+    const std::uint32_t threshold = (0u - n) % n;
+    while (low < threshold) {
+      m = static_cast<std::uint64_t>(static_cast<std::uint32_t>(rng() >> 32)) * n;
+      low = static_cast<std::uint32_t>(m);
+    }
+  }
+  return static_cast<std::uint32_t>(m >> 32);
+}
+
+/// Uniform double in [0, 1).
+template <typename Rng>
+inline double UniformReal(Rng& rng) {
+  return static_cast<double>(rng() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/// Lane-parallel xoshiro128** (32-bit outputs). Kept as structure of arrays
+/// so `omp simd` advances every lane in a few vector instructions.
+template <int kLanes>
+struct LaneRng {
+  std::uint32_t s0[kLanes];
+  std::uint32_t s1[kLanes];
+  std::uint32_t s2[kLanes];
+  std::uint32_t s3[kLanes];
+
+  void Seed(int lane, Xoshiro256& rng) {
+    const std::uint64_t a = rng();
+    const std::uint64_t b = rng() | 1;  // Never all zero.
+    s0[lane] = static_cast<std::uint32_t>(a);
+    s1[lane] = static_cast<std::uint32_t>(a >> 32);
+    s2[lane] = static_cast<std::uint32_t>(b);
+    s3[lane] = static_cast<std::uint32_t>(b >> 32);
+  }
+
+  /// Same stream as Next, for one lane.
+  std::uint32_t NextLane(int lane) {
+    const std::uint32_t x = s1[lane] * 5;
+    const std::uint32_t result = ((x << 7) | (x >> 25)) * 9;
+    const std::uint32_t t = s1[lane] << 9;
+    s2[lane] ^= s0[lane];
+    s3[lane] ^= s1[lane];
+    s1[lane] ^= s2[lane];
+    s0[lane] ^= s3[lane];
+    s2[lane] ^= t;
+    s3[lane] = (s3[lane] << 11) | (s3[lane] >> 21);
+    return result;
+  }
+
+  /// Writes one draw per lane.
+  void Next(std::uint32_t* out) {
+#pragma omp simd
+    for (int lane = 0; lane < kLanes; ++lane) {
+      const std::uint32_t x = s1[lane] * 5;
+      out[lane] = ((x << 7) | (x >> 25)) * 9;
+      const std::uint32_t t = s1[lane] << 9;
+      s2[lane] ^= s0[lane];
+      s3[lane] ^= s1[lane];
+      s1[lane] ^= s2[lane];
+      s0[lane] ^= s3[lane];
+      s2[lane] ^= t;
+      s3[lane] = (s3[lane] << 11) | (s3[lane] >> 21);
+    }
+  }
+};
+
+/// Maps a 32-bit draw onto [0, n); the bias is at most n / 2^32.
+inline std::uint32_t ScaleToIndex(std::uint32_t draw, std::uint32_t n) {
+  return static_cast<std::uint32_t>((static_cast<std::uint64_t>(draw) * n) >> 32);
+}
+
+} // namespace equilibrium
+
+#endif // EQUILIBRIUM_RANDOM_H_
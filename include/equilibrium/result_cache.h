@@ -0,0 +1,59 @@
+#ifndef EQUILIBRIUM_RESULT_CACHE_H_
+#define EQUILIBRIUM_RESULT_CACHE_H_
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "simulation.h"
+
+namespace equilibrium {
+
+/// Bump whenever a seeded trial can produce different Stats than before, so
+/// that stale cache entries are never reused.
+const int kEngineVersion = 1;
+
+/// Everything that determines a seeded trial's Stats, in a fixed order. The
+/// number of trials is deliberately left out.
+std::string CanonicalConfig(const SimulationConfig& config);
+
+uint64_t Fnv1a(const std::string& data);
+
+/// Per-trial rows of integers on disk, one file per canonical config. Rows
+/// are appended, so a later run with more trials extends an earlier one.
+class ResultCache {
+ public:
+  explicit ResultCache(const std::string& directory);
+
+  /// Rows for trials 0, 1, ..., stopping at the first missing trial.
+  void Load(const std::string& key, std::vector<std::vector<long long>>* rows) const;
+  /// Stores rows for trials first_trial, first_trial + 1, ...
+  bool Append(const std::string& key, int first_trial, const std::vector<std::vector<long long>>& rows) const;
+  /// The file holding key's rows.
+  std::string PathFor(const std::string& key) const;
+
+ private:
+  std::string directory_;
+};
+
+/// Same as ComputeDiversityCounts over every trial, but reuses trials cached
+/// for an identical seeded config and appends the ones it had to simulate.
+/// Unseeded configs bypass the cache.
+void ComputeDiversityCounts(const SimulationConfig& config, const ResultCache& cache, DiversityCounts* diversity_counts,
+                            int* cached_trials);
+
+/// Trials in [0, num_trials) that the cached overloads would reuse for config
+/// rather than simulate.
+int CachedTrials(const SimulationConfig& config, int num_trials, const ResultCache& cache);
+
+/// Same as ComputeTrends over [0, num_trials), cached per n.
+bool ComputeTrends(const std::map<int, SimulationConfig>& configs, int num_trials, const ResultCache& cache,
+                   Trends* trends, int* cached_trials);
+/// Either output may be null; only one n's trials are held at a time.
+bool ComputeTrends(const std::map<int, SimulationConfig>& configs, int num_trials, const ResultCache& cache,
+                   Trends* trends, TrendSummaries* summaries, int* cached_trials);
+
+} // namespace equilibrium
+
+#endif // EQUILIBRIUM_RESULT_CACHE_H_
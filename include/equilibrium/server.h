@@ -0,0 +1,68 @@
+#ifndef EQUILIBRIUM_SERVER_H_
+#define EQUILIBRIUM_SERVER_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "graph.h"
+
+namespace equilibrium {
+
+/// Graphs built so far, keyed by (graph name, N), shared by every job.
+class GraphCache {
+ public:
+  /// The cached graph, building it on first use; it shares its edges with the
+  /// cache, so a job does not copy them. False when there is no graph with
+  /// that name.
+  bool Get(const std::string& graph_name, int N, Graph* graph);
+  int size();
+
+ private:
+  std::mutex mutex_;
+  std::map<std::pair<std::string, int>, Graph> graphs_;
+};
+
+/// Runs one job, given as a single line of JSON, and returns a single line of
+/// JSON. A job holds "kind" ("diversity_counts" or "fixation"), an optional
+/// "id" and the fields of the matching app's flags, e.g.
+///
+///   {"id": 3, "kind": "diversity_counts", "graph_name": "cycle", "N": 20,
+///    "num_steps": 1000, "num_simulations": 100, "birth_mutation_rate": 0.01}
+///
+/// The reply echoes "id" and holds either "result", the document the app
+/// would have written to data/, or "error".
+std::string RunJob(const std::string& job, GraphCache* graphs);
+
+/// First-in first-out jobs served by a fixed set of worker threads. Each
+/// worker caps the OpenMP loops of its jobs at threads_per_worker, so that
+/// workers * threads_per_worker matches the cores in use.
+class JobQueue {
+ public:
+  JobQueue(int num_workers, int threads_per_worker);
+  /// Runs every job already pushed, then joins the workers.
+  ~JobQueue();
+
+  void Push(std::function<void()> job);
+  /// Jobs waiting for a worker.
+  int pending();
+
+ private:
+  void Work(int threads_per_worker);
+
+  std::mutex mutex_;
+  std::condition_variable ready_;
+  std::deque<std::function<void()>> jobs_;
+  bool stopping_ = false;
+  std::vector<std::thread> workers_;
+};
+
+} // namespace equilibrium
+
+#endif // EQUILIBRIUM_SERVER_H_
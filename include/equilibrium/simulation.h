@@ -1,21 +1,37 @@
 #ifndef EQUILIBRIUM_SIMULATION_H_
 #define EQUILIBRIUM_SIMULATION_H_
 
+#include <istream>
 #include <map>
+#include <memory>
 #include <random>
 #include <vector>
 
+#include "alias_table.h"
+#include "fenwick_tree.h"
+#include "genealogy.h"
 #include "graph.h"
+#include "measures.h"
+#include "statistics.h"
+#include "type_allocator.h"
 
 
 namespace equilibrium {
 
-const int kNoAncestry = -1;
+/// Seed value meaning every trial draws its seed from std::random_device.
+const int kNoSeed = -1;
 
 struct SimulationHistory {
   std::vector<std::vector<int>> location_to_types;
   /// ancestry[i] == parent of i if i came from birth, otherwise it is -1.
+  /// Left empty with SimulationConfig::track_genealogy.
   std::vector<int> ancestry;
+  /// Ancestors of the final types, only with SimulationConfig::track_genealogy.
+  std::vector<GenealogyNode> genealogy;
+  /// In steps; -1 when the final types have no common ancestor.
+  int time_to_mrca = -1;
+  /// Continuous time of each snapshot, only with SimulationConfig::continuous_time.
+  std::vector<double> times;
 };
 
 enum class DiversityMeasure {
@@ -32,7 +48,11 @@ const std::vector<DiversityMeasure> DIVERSITY_MEASURES = {
 
 using DiversityCounts = std::map<DiversityMeasure, std::map<int, int>>;
 using SimulationHistories = std::vector<SimulationHistory>;
-using Trends = std::map<int, std::vector<int>>;
+/// Absorption times in steps: wider than an int, since the lumped engine
+/// runs stars of millions of locations.
+using Trends = std::map<int, std::vector<long long>>;
+/// Streaming alternative to Trends: absorption time summary per n.
+using TrendSummaries = std::map<int, SampleSummary>;
 
 enum class Dynamic {
   BIRTH_DEATH,
@@ -42,6 +62,19 @@ enum class Dynamic {
 bool FromString(const std::string&, Dynamic*);
 bool ToString(const Dynamic&, std::string*);
 
+enum class SimulationEngine {
+  /// One Simulate call per trial.
+  SCALAR,
+  /// kEnsembleLanes absorption trials interleaved, see RunEnsembleBlock.
+  ENSEMBLE,
+  /// Lineage counts per orbit of a complete graph or (double) star, see
+  /// RunLumpedTrial.
+  LUMPED,
+};
+
+bool FromString(const std::string&, SimulationEngine*);
+bool ToString(const SimulationEngine&, std::string*);
+
 struct Step {
   int birther;
   int dier;
@@ -54,7 +87,9 @@ struct StepConfig {
     const Graph& graph,
     std::uniform_int_distribution<>& first_step_dist,
     std::vector<std::uniform_int_distribution<>>& second_step_idx_dists,
-    std::mt19937& rng
+    std::mt19937& rng,
+    const FenwickTree* first_step_weights = nullptr,
+    const AliasTable* second_step_weights = nullptr
   );
 
   const Dynamic& dynamic;
@@ -62,13 +97,29 @@ struct StepConfig {
   std::uniform_int_distribution<>& first_step_dist;
   std::vector<std::uniform_int_distribution<>>& second_step_idx_dists;
   std::mt19937& rng;
+  /// When set, the first location is drawn proportionally to these weights
+  /// instead of from first_step_dist.
+  const FenwickTree* first_step_weights;
+  /// When set, the neighbor is drawn from this row's alias table instead of
+  /// from second_step_idx_dists.
+  const AliasTable* second_step_weights;
 };
 
 struct Stats {
   int number_of_types;
   int number_of_unmatching_pairs;
   int number_of_unmatching_links;
-  int number_of_steps;
+  /// Events of SimulateParallel can outnumber an int.
+  long long number_of_steps;
+  /// Only tracked with SimulationConfig::continuous_time.
+  double time;
+  /// Only tracked with SimulationConfig::track_genealogy, otherwise -1.
+  int time_to_mrca;
+  /// One per SimulationConfig::measures, in order.
+  std::vector<MeasureResult> measures;
+  /// trajectory[c] holds the number of types followed by every value of
+  /// SimulationConfig::measures, right after step checkpoints[c].
+  std::vector<std::vector<double>> trajectory;
 };
 
 struct SimulationConfig {
@@ -83,6 +134,68 @@ struct SimulationConfig {
   bool compute_stats;
   bool start_with_max_diversity;
   bool run_until_homogeneous;
+  /// Trial k is seeded from (seed, k), so seeded runs reproduce regardless of
+  /// how trials are split across threads or ranks.
+  int seed = kNoSeed;
+  /// Rate of each location's event: its birth rate under birth-death, its
+  /// death rate under death-birth. Empty (or all equal) is the uniform
+  /// discrete-step process; otherwise the first location of a step is drawn
+  /// from a Fenwick tree in O(log N).
+  std::vector<double> node_rates;
+  /// Also track continuous time: each step waits Exp(sum of rates), with
+  /// uniform rates of 1. Drawn from a separate stream, so the trajectory
+  /// is the same as without it.
+  bool continuous_time = false;
+  /// Keep a pruned type tree instead of the full ancestry: memory follows the
+  /// number of living lineages rather than the number of mutations.
+  bool track_genealogy = false;
+  /// Extra measures updated on every event; each trial runs its own clone.
+  std::vector<std::shared_ptr<const MeasureTracker>> measures;
+  /// Sorted steps at which Stats::trajectory is recorded; 0 is the initial
+  /// state. Steps beyond the end of the run are not recorded.
+  std::vector<int> checkpoints;
+  /// Only ComputeTrends honours ENSEMBLE and LUMPED, for configs
+  /// SupportsEnsemble or SupportsLumped accept.
+  SimulationEngine engine = SimulationEngine::SCALAR;
+  /// ComputeDiversityCounts pins its threads across NUMA nodes and gives each
+  /// node its own copy of the graph and rates. Same results either way.
+  bool numa_replicas = false;
+  /// Steps, birth-mutation coins and independent mutations draw from separate
+  /// streams of the trial, and the independent mutation location is drawn
+  /// whether or not it mutates. Trial k then makes the same steps and compares
+  /// the same uniforms against the rates at every mutation rate, so runs that
+  /// differ only in rates (or dynamic, on undirected graphs) are coupled.
+  bool common_random_numbers = false;
+};
+
+/// Everything a trial needs besides its config: the sampling tables derived
+/// from the graph, dynamic and rates, and the state buffers. Build one per
+/// config and thread and hand it to each trial that thread runs; a trial then
+/// resets the buffers in O(N) instead of rebuilding and reallocating them.
+struct SimulationWorkspace {
+  explicit SimulationWorkspace(const SimulationConfig& config);
+
+  std::mt19937 rng;
+  /// Continuous-time clock, see SimulationConfig::continuous_time.
+  std::mt19937 time_rng;
+  /// Only used with SimulationConfig::common_random_numbers.
+  std::mt19937 mutation_rng;
+  std::mt19937 independent_mutation_rng;
+  std::uniform_int_distribution<> first_step_dist;
+  /// Unused on weighted graphs.
+  std::vector<std::uniform_int_distribution<>> second_step_idx_dists;
+  bool uniform_rates;
+  double total_rate;
+  /// Only built with heterogeneous rates.
+  FenwickTree first_step_weights;
+  /// Only built on weighted graphs.
+  AliasTable second_step_weights;
+
+  std::vector<int> location_to_type;
+  TypeAllocator types;
+  Genealogy genealogy;
+  /// One clone of each of SimulationConfig::measures.
+  std::vector<std::unique_ptr<MeasureTracker>> trackers;
 };
 
 
@@ -90,14 +203,47 @@ bool BirthDeathStep(const StepConfig&, Step*);
 bool DeathBirthStep(const StepConfig&, Step*);
 bool MakeStep(const StepConfig&, Step*);
 
+std::mt19937 MakeTrialRng(int seed, int trial);
+/// An independent stream for the same trial, e.g. for the continuous-time clock.
+std::mt19937 MakeTrialRng(int seed, int trial, int stream);
+/// Same states as MakeTrialRng, reseeding rng in place.
+void SeedTrialRng(int seed, int trial, std::mt19937* rng);
+void SeedTrialRng(int seed, int trial, int stream, std::mt19937* rng);
+
+/// One non-negative rate per location, not all zero.
+bool ValidNodeRates(const std::vector<double>& rates, int size);
+/// Reads whitespace separated rates that satisfy ValidNodeRates.
+bool ReadNodeRates(std::istream* is, int size, std::vector<double>* rates);
+/// True when empty or all equal.
+bool HasUniformRates(const std::vector<double>& rates);
+
 void Simulate(const SimulationConfig&, Stats*, SimulationHistory*);
+void Simulate(const SimulationConfig&, int trial, Stats*, SimulationHistory*);
+/// workspace must have been built from the same config.
+void Simulate(const SimulationConfig&, int trial, SimulationWorkspace* workspace, Stats*, SimulationHistory*);
 
+/// Appends one history per trial, in trial order.
 void ComputeSimulationHistories(const SimulationConfig&, SimulationHistories*);
 void ComputeDiversityCounts(const equilibrium::SimulationConfig&, DiversityCounts*);
+/// Only runs trials [first_trial, last_trial).
+void ComputeDiversityCounts(const equilibrium::SimulationConfig&, int first_trial, int last_trial, DiversityCounts*,
+                            MeasureSummaries* measure_summaries = nullptr);
+/// Absorption times of trials [first_trial, last_trial) for every n in configs.
+/// trends[n][k] is the time of trial first_trial + k. False when a time
+/// overflowed a long long, which only the lumped engine runs long enough to do.
+bool ComputeTrends(const std::map<int, SimulationConfig>& configs, int first_trial, int last_trial, Trends* trends);
+/// Either output may be null; without raw trends memory does not grow with the
+/// number of trials, and each thread summarises its own trials.
+bool ComputeTrends(const std::map<int, SimulationConfig>& configs, int first_trial, int last_trial, Trends* trends,
+                   TrendSummaries* summaries);
 
 bool IsHomogeneous(const std::vector<int>& location_to_type);
 int NumberOfTypes(const std::vector<int>&);
+/// Counted in long long, but returned as an int like every diversity
+/// count, so only exact up to N = 65536 locations (N (N - 1) / 2 < 2^31).
 int NumberOfUnmatchingPairs(const std::vector<int>&);
+/// Same count from the abundances alone, in O(N) without a copy.
+int NumberOfUnmatchingPairs(const TypeAllocator&);
 int NumberOfUnmatchingLinks(const std::vector<int>&, const Graph&);
 
 bool ToString(const DiversityMeasure& measure, std::string* output);
@@ -0,0 +1,69 @@
+#ifndef EQUILIBRIUM_SPLITTING_H_
+#define EQUILIBRIUM_SPLITTING_H_
+
+#include <string>
+#include <vector>
+
+#include "fixation.h"
+
+namespace equilibrium {
+
+/// What multilevel splitting measures an invasion's progress by.
+enum class ProgressCoordinate {
+  /// Number of mutants. A last level of N estimates the fixation probability.
+  MUTANT_COUNT,
+  /// Steps survived without absorbing. A last level of T estimates
+  /// P(absorption time > T).
+  STEPS,
+};
+
+bool FromString(const std::string&, ProgressCoordinate*);
+bool ToString(const ProgressCoordinate&, std::string*);
+
+struct SplittingConfig {
+  /// The invasion: graph, dynamic, fitness, start node, seed and max_steps.
+  /// num_simulations, batch_size and engine are unused.
+  FixationConfig fixation;
+  ProgressCoordinate coordinate = ProgressCoordinate::MUTANT_COUNT;
+  /// Increasing thresholds of the coordinate, all beyond its start (1 mutant,
+  /// 0 steps). The last one is the rare event.
+  std::vector<long long> levels;
+  /// Clones started from each level (fixed effort).
+  int clones_per_level = 1000;
+  /// Independent splitting runs, whose spread gives the confidence interval.
+  int num_replications = 10;
+};
+
+/// num_levels thresholds spread evenly over (start, target], ending at target.
+void MakeEvenLevels(long long start, long long target, int num_levels, std::vector<long long>* levels);
+
+struct SplittingResult {
+  /// Mean of the replications' estimates. Each is the product of the
+  /// fractions of clones that reach the next level, which is unbiased.
+  double probability = 0;
+  /// From the spread of the replications; with a single replication, from
+  /// the usual approximation that levels are independent.
+  double standard_error = 0;
+  /// 95% normal interval, clipped to [0, 1].
+  double lower = 0;
+  double upper = 0;
+  /// level_probabilities[l] is the mean fraction of clones that went from
+  /// level l-1 (the start for l = 0) to level l, counting 0 for replications
+  /// that died out before level l.
+  std::vector<double> level_probabilities;
+  long long steps = 0;
+};
+
+/// Fixed-effort multilevel splitting: clones_per_level invasions run from the
+/// start until they reach levels[0] or fail (absorb, or reach max_steps with
+/// MUTANT_COUNT). The next clones_per_level start from states drawn uniformly
+/// among those that made it, and so on up to the last level. Clones of a
+/// level run across OpenMP threads. Each clone draws from its own stream,
+/// seeded from (seed, replication, level, clone), so results do not depend on
+/// the number of threads. False when the levels are not increasing or not
+/// beyond the start.
+bool RunSplitting(const SplittingConfig&, SplittingResult*);
+
+} // namespace equilibrium
+
+#endif // EQUILIBRIUM_SPLITTING_H_
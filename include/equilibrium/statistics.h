@@ -0,0 +1,138 @@
+#ifndef EQUILIBRIUM_STATISTICS_H_
+#define EQUILIBRIUM_STATISTICS_H_
+
+#include <map>
+#include <vector>
+
+namespace equilibrium {
+
+/// Welford's running mean and variance. Merge uses Chan et al.'s pairwise
+/// update, so per-thread moments can be combined in any order.
+class RunningMoments {
+ public:
+  void Add(double x);
+  void Merge(const RunningMoments& other);
+
+  long long count() const { return count_; }
+  double mean() const { return mean_; }
+  /// Sample variance; 0 with fewer than two samples.
+  double variance() const;
+
+ private:
+  long long count_ = 0;
+  double mean_ = 0;
+  double m2_ = 0;
+};
+
+/// Dunning's merging t-digest: a mergeable quantile sketch whose size is
+/// bounded by the compression, with the best accuracy near the tails.
+class TDigest {
+ public:
+  explicit TDigest(double compression = 100) : compression_(compression) {}
+
+  void Add(double x, double weight = 1);
+  void Merge(const TDigest& other);
+
+  double count() const { return total_weight_ + buffer_weight_; }
+  bool empty() const { return centroids_.empty() && buffer_.empty(); }
+  /// q in [0, 1]; 0 when empty.
+  double Quantile(double q) const;
+
+ private:
+  struct Centroid {
+    double mean;
+    double weight;
+  };
+
+  /// Folds the buffer into the centroids.
+  void Compress() const;
+
+  double compression_;
+  mutable std::vector<Centroid> centroids_;
+  mutable std::vector<Centroid> buffer_;
+  mutable double total_weight_ = 0;
+  mutable double buffer_weight_ = 0;
+  double min_ = 0;
+  double max_ = 0;
+};
+
+/// Counts in geometrically growing buckets: bucket i covers
+/// [2^(i/b), 2^((i+1)/b)) for b buckets per octave. Values below 1 share
+/// one underflow bucket. Sparse, so merging costs the number of buckets used.
+class LogHistogram {
+ public:
+  explicit LogHistogram(int buckets_per_octave = 4) : buckets_per_octave_(buckets_per_octave) {}
+
+  void Add(double x);
+  void Merge(const LogHistogram& other);
+
+  long long underflow() const { return underflow_; }
+  const std::map<int, long long>& buckets() const { return buckets_; }
+  double lower(int bucket) const;
+  double upper(int bucket) const { return lower(bucket + 1); }
+
+ private:
+  int buckets_per_octave_;
+  long long underflow_ = 0;
+  std::map<int, long long> buckets_;
+};
+
+/// Moments, log histogram and quantiles of one stream of samples.
+struct SampleSummary {
+  void Add(double x);
+  void Merge(const SampleSummary& other);
+
+  RunningMoments moments;
+  LogHistogram histogram;
+  TDigest quantiles;
+};
+
+/// Mean and spread of b[k] - a[k] over matched samples.
+struct PairedDifference {
+  long long num_pairs = 0;
+  double mean = 0;
+  /// Sample variance of the differences.
+  double variance = 0;
+  double standard_error = 0;
+  /// The standard error had a and b been independent samples of the same
+  /// size; its ratio to standard_error shows what the pairing saves.
+  double unpaired_standard_error = 0;
+};
+
+/// a and b must have the same size.
+void ComputePairedDifference(const std::vector<double>& a, const std::vector<double>& b, PairedDifference*);
+
+/// Wilson score interval for a binomial proportion, z = 1.96 for 95%.
+void WilsonInterval(long long successes, long long trials, double z, double* lower, double* upper);
+
+/// Counts of each integer value.
+using Histogram = std::map<long long, long long>;
+
+/// A two-sample test of whether both samples come from one distribution.
+struct TestResult {
+  double statistic = 0;
+  /// 0 for tests without one.
+  int degrees_of_freedom = 0;
+  /// 1 when either sample is empty or there is nothing to compare.
+  double p_value = 1;
+};
+
+/// P(X >= statistic) for X chi-square with the given degrees of freedom.
+double ChiSquarePValue(double statistic, int degrees_of_freedom);
+
+/// Pearson's chi-square test of homogeneity on two histograms of integer
+/// values. Neighbouring values are pooled, in order, until both expected
+/// counts of a bin are at least 5.
+void ChiSquareTest(const Histogram& a, const Histogram& b, TestResult*);
+
+/// Two-sample Kolmogorov-Smirnov test on histograms of integer values, with
+/// Stephens' small-sample correction. Conservative with ties.
+void KolmogorovSmirnovTest(const Histogram& a, const Histogram& b, TestResult*);
+
+/// The distance between two CDFs that a Kolmogorov-Smirnov test at level
+/// alpha, on samples of sizes n and m, detects about half of the time.
+double KolmogorovSmirnovResolution(long long n, long long m, double alpha);
+
+} // namespace equilibrium
+
+#endif // EQUILIBRIUM_STATISTICS_H_
@@ -0,0 +1,42 @@
+#ifndef EQUILIBRIUM_SWEEP_H_
+#define EQUILIBRIUM_SWEEP_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "simulation.h"
+#include "statistics.h"
+
+namespace equilibrium {
+
+/// Final value of every diversity measure per trial: samples[measure][k] is
+/// that of trial k.
+using TrialSamples = std::map<DiversityMeasure, std::vector<double>>;
+
+/// Sets one of birth_mutation_rate, independent_mutation_rate or dynamic
+/// from its string value.
+bool SetSweepParameter(const std::string& parameter, const std::string& value, SimulationConfig*);
+
+struct SweepResults {
+  std::string parameter;
+  std::vector<std::string> values;
+  /// samples[p] holds the trials run at values[p].
+  std::vector<TrialSamples> samples;
+  /// differences[p][measure] compares values[p] with values[0], trial by
+  /// trial; differences[0] is empty.
+  std::vector<std::map<DiversityMeasure, PairedDifference>> differences;
+};
+
+/// Runs trials [0, config.num_simulations) of config at every value of
+/// parameter. With config.common_random_numbers, trial k has the same seed at
+/// every value, so the paired differences only carry the noise the parameter
+/// itself adds. Without it, value p runs with a seed hashed from seed and p,
+/// so the points are independent. Needs a seed. False when a value does not
+/// parse.
+bool ComputeSweep(const SimulationConfig& config, const std::string& parameter, const std::vector<std::string>& values,
+                  SweepResults*);
+
+} // namespace equilibrium
+
+#endif // EQUILIBRIUM_SWEEP_H_
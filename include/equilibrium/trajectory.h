@@ -0,0 +1,36 @@
+#ifndef EQUILIBRIUM_TRAJECTORY_H_
+#define EQUILIBRIUM_TRAJECTORY_H_
+
+#include <string>
+#include <vector>
+
+#include "simulation.h"
+#include "statistics.h"
+
+namespace equilibrium {
+
+/// Per-checkpoint statistics of every recorded series across trials.
+struct TrajectorySummary {
+  std::vector<int> checkpoints;
+  /// "number_of_types", "number_of_unmatching_pairs",
+  /// "number_of_unmatching_links", then the values of SimulationConfig::measures
+  /// (multi-valued measures get "_1", "_2", ... suffixes).
+  std::vector<std::string> series;
+  /// [checkpoint][series].
+  std::vector<std::vector<RunningMoments>> moments;
+  std::vector<std::vector<TDigest>> quantiles;
+};
+
+/// Steps 0 and num_steps plus up to num_checkpoints steps in between, spaced
+/// evenly or (log_spaced) geometrically. Duplicates are dropped.
+void MakeCheckpoints(int num_steps, int num_checkpoints, bool log_spaced, std::vector<int>* checkpoints);
+
+/// Runs trials [first_trial, last_trial) at config.checkpoints. Only
+/// measures are kept, so memory does not grow with N or the run length.
+void ComputeTrajectories(const SimulationConfig& config, int first_trial, int last_trial, TrajectorySummary* summary);
+
+void MergeTrajectorySummary(const TrajectorySummary& from, TrajectorySummary* to);
+
+} // namespace equilibrium
+
+#endif // EQUILIBRIUM_TRAJECTORY_H_
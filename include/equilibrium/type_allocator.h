@@ -0,0 +1,46 @@
+#ifndef EQUILIBRIUM_TYPE_ALLOCATOR_H_
+#define EQUILIBRIUM_TYPE_ALLOCATOR_H_
+
+#include <vector>
+
+namespace equilibrium {
+
+/// Hands out dense type ids and recycles them once a type holds no location,
+/// so a population of N locations never uses ids above N and per-type state
+/// fits in flat arrays. Each id also remembers the global mutation index it
+/// currently stands for, which is what histories and ancestry report.
+class TypeAllocator {
+ public:
+  /// Ids 0, ..., N-1 stand for global types 0, ..., num_initial_types-1, one
+  /// location each, or all on type 0 when num_initial_types is 1.
+  void Reset(int num_locations, int num_initial_types);
+
+  /// A fresh id with abundance 0 for the next global type.
+  int Allocate();
+  /// One location changes from old_id to new_id; old_id is recycled when it
+  /// holds no more locations.
+  void Replace(int old_id, int new_id);
+
+  int abundance(int id) const { return abundance_[id]; }
+  /// Ids are below this.
+  int num_ids() const { return static_cast<int>(abundance_.size()); }
+  int global_type(int id) const { return global_types_[id]; }
+  /// Number of types holding at least one location. O(1).
+  int num_types() const { return num_types_; }
+  /// Global types handed out so far.
+  int num_global_types() const { return next_global_type_; }
+
+  /// Rewrites local ids as global types.
+  void ToGlobal(const std::vector<int>& location_to_id, std::vector<int>* location_to_type) const;
+
+ private:
+  std::vector<int> abundance_;
+  std::vector<int> global_types_;
+  std::vector<int> free_ids_;
+  int num_types_ = 0;
+  int next_global_type_ = 0;
+};
+
+} // namespace equilibrium
+
+#endif // EQUILIBRIUM_TYPE_ALLOCATOR_H_
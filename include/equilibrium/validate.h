@@ -0,0 +1,76 @@
+#ifndef EQUILIBRIUM_VALIDATE_H_
+#define EQUILIBRIUM_VALIDATE_H_
+
+#include <string>
+#include <vector>
+
+#include "simulation.h"
+#include "statistics.h"
+
+namespace equilibrium {
+
+/// A way of running trials that must match the scalar engine in distribution.
+enum class ValidationCandidate {
+  /// SimulationEngine::ENSEMBLE, on absorption times.
+  ENSEMBLE,
+  /// SimulationEngine::LUMPED, on absorption times.
+  LUMPED,
+  /// SimulationConfig::common_random_numbers, on absorption times and
+  /// diversity counts.
+  COMMON_RANDOM_NUMBERS,
+  /// FixationEngine::BATCHED against the scalar fixation engine, on the
+  /// outcome, fixation times and extinction times of a single mutant. Only
+  /// the cases of mutation rate 0.
+  BATCHED_FIXATION,
+  /// SimulateParallel against continuous-time Simulate, on the diversity
+  /// counts at time num_steps / n, with birth mutations only.
+  PARALLEL_TRAJECTORY,
+};
+
+bool FromString(const std::string&, ValidationCandidate*);
+bool ToString(const ValidationCandidate&, std::string*);
+
+/// A matrix of cases: every graph, n, dynamic and mutation rate.
+struct ValidationConfig {
+  ValidationCandidate candidate = ValidationCandidate::ENSEMBLE;
+  std::vector<std::string> graph_names = {"complete", "star", "double-star", "cycle"};
+  std::vector<int> ns = {5, 12};
+  std::vector<Dynamic> dynamics = {Dynamic::BIRTH_DEATH, Dynamic::DEATH_BIRTH};
+  /// Both mutation rates of a case. At 0 the case compares absorption times
+  /// from N distinct types; above 0, the diversity counts after num_steps
+  /// steps from a single type.
+  std::vector<double> mutation_rates = {0, 0.05};
+  int num_steps = 100;
+  /// Of the mutant in the batched-fixation cases; must pass IsValidFitness.
+  double mutant_fitness = 1.5;
+  /// Per engine and case. KolmogorovSmirnovResolution tells what that buys.
+  int num_trials = 10000;
+  /// Family-wise: each test runs at alpha over the number of tests.
+  double alpha = 0.001;
+  /// The reference runs with seed, the candidate with seed + 1.
+  int seed = 1;
+};
+
+struct ValidationResult {
+  std::string graph_name;
+  int n = 0;
+  Dynamic dynamic = Dynamic::BIRTH_DEATH;
+  double mutation_rate = 0;
+  /// "absorption_time", the DiversityMeasure compared, or "fixation",
+  /// "fixation_time" and "extinction_time" of the batched-fixation cases.
+  std::string quantity;
+  TestResult chi_square;
+  TestResult kolmogorov_smirnov;
+  bool passed = true;
+};
+
+/// Runs each case of config that the candidate supports with the scalar
+/// engine and with the candidate, and compares the two histograms of every
+/// quantity with ChiSquareTest and KolmogorovSmirnovTest. Trials run across
+/// OpenMP threads. False when a graph name is unknown or the batched-fixation
+/// candidate gets an invalid mutant fitness.
+bool RunValidation(const ValidationConfig&, std::vector<ValidationResult>*);
+
+} // namespace equilibrium
+
+#endif // EQUILIBRIUM_VALIDATE_H_
@@ -5,7 +5,11 @@
 #include <ostream>
 #include <string>
 
+#include "fixation.h"
 #include "simulation.h"
+#include "splitting.h"
+#include "sweep.h"
+#include "trajectory.h"
 
 namespace equilibrium {
 
@@ -17,7 +21,15 @@ struct MetaData {
 
 std::string GetOutputFileName(const std::string& prefix, const std::chrono::time_point<std::chrono::system_clock>& time);
 void WriteDiversityCountsToStream(const DiversityCounts&, const SimulationConfig&, const MetaData&, std::ostream* os);
+/// Also writes the per-event measures of SimulationConfig::measures.
+void WriteDiversityCountsToStream(const DiversityCounts&, const MeasureSummaries&, const SimulationConfig&,
+                                  const MetaData&, std::ostream* os);
+void WriteSweepToStream(const SweepResults&, const SimulationConfig&, const MetaData&, std::ostream* os);
 void WriteSimulationHistoryToStream(const SimulationHistories&, const SimulationConfig&, const MetaData&, std::ostream* os);
+void WriteFixationToStream(const FixationResults&, const FixationConfig&, const MetaData&, std::ostream* os);
+void WriteSplittingToStream(const SplittingResult&, const SplittingConfig&, const MetaData&, std::ostream* os);
+void WriteTrajectoryToStream(const TrajectorySummary&, const SimulationConfig&, const std::string& spacing,
+                             const MetaData&, std::ostream* os);
 void WriteTrendsToStream(
   const std::string& graph_name,
   const int N,
@@ -27,6 +39,17 @@ void WriteTrendsToStream(
   const MetaData& metadata,
   std::ostream* os
 );
+/// Also writes per-n summaries; trends may be empty when raw samples were not kept.
+void WriteTrendsToStream(
+  const std::string& graph_name,
+  const int N,
+  const double exp_sample_rate,
+  const Trends& trends,
+  const TrendSummaries& summaries,
+  const SimulationConfig& config,
+  const MetaData& metadata,
+  std::ostream* os
+);
 
 } // namespace equilibrium
 
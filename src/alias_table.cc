@@ -0,0 +1,60 @@
+#include <equilibrium/alias_table.h>
+
+namespace equilibrium {
+
+AliasTable::AliasTable(const std::vector<std::vector<double>>& rows) {
+  offsets_.reserve(rows.size() + 1);
+  offsets_.push_back(0);
+  for (const auto& row : rows) {
+    offsets_.push_back(offsets_.back() + static_cast<int>(row.size()));
+  }
+  probability_.assign(offsets_.back(), 1.);
+  alias_.resize(offsets_.back());
+
+  std::vector<double> scaled;
+  std::vector<int> small;
+  std::vector<int> large;
+  const int num_rows = static_cast<int>(rows.size());
+  for (int r = 0; r < num_rows; ++r) {
+    const auto& row = rows[r];
+    const int offset = offsets_[r];
+    const int size = static_cast<int>(row.size());
+    double total = 0;
+    for (const auto& weight : row) total += weight;
+    if (total <= 0) {
+      // Every column defers to the alias -1.
+      for (int i = 0; i < size; ++i) {
+        probability_[offset + i] = 0.;
+        alias_[offset + i] = -1;
+      }
+      continue;
+    }
+    for (int i = 0; i < size; ++i) alias_[offset + i] = i;
+
+    // Vose: pair every under-full column with an over-full one.
+    scaled.resize(row.size());
+    small.clear();
+    large.clear();
+    for (int i = 0; i < size; ++i) {
+      scaled[i] = row[i] * size / total;
+      (scaled[i] < 1. ? small : large).push_back(i);
+    }
+    while (!small.empty() && !large.empty()) {
+      const int s = small.back();
+      small.pop_back();
+      const int l = large.back();
+      probability_[offset + s] = scaled[s];
+      alias_[offset + s] = l;
+      scaled[l] -= 1. - scaled[s];
+      if (scaled[l] < 1.) {
+        large.pop_back();
+        small.push_back(l);
+      }
+    }
+    // Whatever is left is full up to rounding.
+    for (const auto& i : small) probability_[offset + i] = 1.;
+    for (const auto& i : large) probability_[offset + i] = 1.;
+  }
+}
+
+} // namespace equilibrium
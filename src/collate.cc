@@ -0,0 +1,176 @@
+#include <map>
+#include <string>
+
+#include <equilibrium/collate.h>
+
+#include <nlohmann/json.hpp>
+
+namespace equilibrium {
+
+const std::vector<std::string>& CollateColumns() {
+  static const std::vector<std::string> columns = {
+    "tag",
+    "start_time_s",
+    "end_time_s",
+    "N",
+    "graph_name",
+    "num_simulations",
+    "num_steps",
+    "birth_mutation_rate",
+    "independent_mutation_rate",
+    "diversity_measure",
+    "dynamic",
+    "diversity",
+    "count",
+  };
+  return columns;
+}
+
+namespace {
+
+/// Keeps only what the CSV needs: top-level config and metadata scalars, and
+/// results[].diversity_measure / results[].diversity_counts[].{diversity,count}.
+/// Scalars are kept as text the way Python's csv module would print them.
+class CollateHandler : public nlohmann::json_sax<nlohmann::json> {
+ public:
+  explicit CollateHandler(const std::string& tag) : tag_(tag) {}
+
+  bool null() override { return Scalar(""); }
+  bool boolean(bool val) override { return Scalar(val ? "True" : "False"); }
+  bool number_integer(number_integer_t val) override { return Scalar(std::to_string(val)); }
+  bool number_unsigned(number_unsigned_t val) override { return Scalar(std::to_string(val)); }
+  bool number_float(number_float_t, const string_t& s) override { return Scalar(s); }
+  bool string(string_t& val) override { return Scalar(val); }
+  bool binary(binary_t&) override { return Scalar(""); }
+
+  bool start_object(std::size_t) override {
+    path_.push_back(key_);
+    key_.clear();
+    if (InResult() && path_.size() == 3) {
+      measure_.clear();
+      counts_.clear();
+    }
+    if (InCount()) count_.clear();
+    return true;
+  }
+
+  bool end_object() override {
+    if (InCount()) counts_.push_back(count_);
+    if (InResult() && path_.size() == 3) {
+      for (auto count : counts_) {
+        count["diversity_measure"] = measure_;
+        pending_.push_back(count);
+      }
+    }
+    path_.pop_back();
+    return true;
+  }
+
+  bool start_array(std::size_t) override {
+    path_.push_back(key_);
+    key_.clear();
+    return true;
+  }
+
+  bool end_array() override {
+    path_.pop_back();
+    return true;
+  }
+
+  bool key(string_t& val) override {
+    key_ = val;
+    return true;
+  }
+
+  bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception&) override {
+    failed_ = true;
+    return false;
+  }
+
+  bool failed() const { return failed_; }
+  bool tag_mismatch() const { return tag_mismatch_; }
+  bool has_tag() const { return metadata_.count("tag") > 0; }
+
+  void GetRows(std::vector<CsvRow>* rows) const {
+    // Later sources win, as in {**config, **metadata, **dc}.
+    for (const auto& count : pending_) {
+      std::map<std::string, std::string> datum = config_;
+      for (const auto& entry : metadata_) datum[entry.first] = entry.second;
+      for (const auto& entry : count) datum[entry.first] = entry.second;
+      CsvRow row;
+      for (const auto& column : CollateColumns()) {
+        const auto it = datum.find(column);
+        row.push_back(it == datum.end() ? "" : it->second);
+      }
+      rows->push_back(row);
+    }
+  }
+
+ private:
+  // path_ holds the key (or "" inside arrays) that opened each container.
+  bool InResult() const { return path_.size() >= 3 && path_[1] == "results"; }
+  bool InCount() const { return path_.size() == 5 && InResult() && path_[3] == "diversity_counts"; }
+
+  bool Scalar(const std::string& value) {
+    if (path_.size() == 2 && path_[1] == "config") {
+      config_[key_] = value;
+    } else if (path_.size() == 2 && path_[1] == "metadata") {
+      metadata_[key_] = value;
+      // Stop reading as soon as the file is known to be filtered out.
+      if (key_ == "tag" && value != tag_) {
+        tag_mismatch_ = true;
+        return false;
+      }
+    } else if (InResult() && path_.size() == 3 && key_ == "diversity_measure") {
+      measure_ = value;
+    } else if (InCount()) {
+      count_[key_] = value;
+    }
+    return true;
+  }
+
+  std::string tag_;
+  std::vector<std::string> path_;
+  std::string key_;
+  std::map<std::string, std::string> config_;
+  std::map<std::string, std::string> metadata_;
+  std::string measure_;
+  std::map<std::string, std::string> count_;
+  std::vector<std::map<std::string, std::string>> counts_;
+  std::vector<std::map<std::string, std::string>> pending_;
+  bool failed_ = false;
+  bool tag_mismatch_ = false;
+};
+
+}  // namespace
+
+bool CollateDiversityCounts(std::istream* is, const std::string& tag, std::vector<CsvRow>* rows) {
+  CollateHandler handler(tag);
+  nlohmann::json::sax_parse(*is, &handler);
+  if (handler.tag_mismatch()) return true;
+  if (handler.failed()) return false;
+  // data-to-csv.py skips files without a tag too.
+  if (!handler.has_tag()) return true;
+  handler.GetRows(rows);
+  return true;
+}
+
+void WriteCsvRow(const CsvRow& row, std::ostream* os) {
+  for (int i = 0; i < static_cast<int>(row.size()); ++i) {
+    if (i > 0) (*os) << ',';
+    const auto& field = row[i];
+    if (field.find_first_of(",\"\r\n") == std::string::npos) {
+      (*os) << field;
+      continue;
+    }
+    (*os) << '"';
+    for (const auto& c : field) {
+      if (c == '"') (*os) << '"';
+      (*os) << c;
+    }
+    (*os) << '"';
+  }
+  (*os) << "\r\n";
+}
+
+} // namespace equilibrium
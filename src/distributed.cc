@@ -0,0 +1,71 @@
+#include <vector>
+
+#include <equilibrium/distributed.h>
+#include <equilibrium/simulation.h>
+
+namespace equilibrium {
+
+TrialRange GetTrialRange(int num_trials, int rank, int num_ranks) {
+  const int block = num_trials / num_ranks;
+  const int remainder = num_trials % num_ranks;
+  // The first `remainder` ranks take one extra trial.
+  TrialRange range;
+  range.first = rank * block + (rank < remainder ? rank : remainder);
+  range.last = range.first + block + (rank < remainder ? 1 : 0);
+  return range;
+}
+
+void MergeDiversityCounts(const DiversityCounts& from, DiversityCounts* into) {
+  for (const auto& measure_counts : from) {
+    auto& counts = (*into)[measure_counts.first];
+    for (const auto& element : measure_counts.second) {
+      counts[element.first] += element.second;
+    }
+  }
+}
+
+void FlattenDiversityCounts(const DiversityCounts& diversity_counts, std::vector<int>* flat) {
+  flat->clear();
+  for (const auto& measure_counts : diversity_counts) {
+    for (const auto& element : measure_counts.second) {
+      flat->emplace_back(static_cast<int>(measure_counts.first));
+      flat->emplace_back(element.first);
+      flat->emplace_back(element.second);
+    }
+  }
+}
+
+bool UnflattenDiversityCounts(const std::vector<int>& flat, DiversityCounts* diversity_counts) {
+  if (flat.size() % 3 != 0) return false;
+  for (int i = 0; i < static_cast<int>(flat.size()); i += 3) {
+    const auto measure = static_cast<DiversityMeasure>(flat[i]);
+    (*diversity_counts)[measure][flat[i+1]] += flat[i+2];
+  }
+  return true;
+}
+
+void FlattenTrends(const Trends& trends, std::vector<long long>* flat) {
+  flat->clear();
+  for (const auto& trend : trends) {
+    flat->emplace_back(trend.first);
+    flat->emplace_back(static_cast<long long>(trend.second.size()));
+    flat->insert(flat->end(), trend.second.begin(), trend.second.end());
+  }
+}
+
+bool UnflattenTrends(const std::vector<long long>& flat, Trends* trends) {
+  std::size_t i = 0;
+  while (i < flat.size()) {
+    if (i + 2 > flat.size()) return false;
+    const int n = static_cast<int>(flat[i]);
+    const long long num_times = flat[i+1];
+    i += 2;
+    if (num_times < 0 || num_times > static_cast<long long>(flat.size() - i)) return false;
+    auto& times = (*trends)[n];
+    times.insert(times.end(), flat.begin() + i, flat.begin() + i + num_times);
+    i += static_cast<std::size_t>(num_times);
+  }
+  return true;
+}
+
+}  // namespace equilibrium
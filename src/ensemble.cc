@@ -0,0 +1,173 @@
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <equilibrium/ensemble.h>
+#include <equilibrium/progress.h>
+#include <equilibrium/random.h>
+
+namespace equilibrium {
+
+bool SupportsEnsemble(const SimulationConfig& config) {
+  return config.run_until_homogeneous &&
+      !(config.birth_mutation_rate > 0) &&
+      !(config.independent_mutation_rate > 0) &&
+      HasUniformRates(config.node_rates) &&
+      !config.graph.weighted() &&
+      !config.capture_history &&
+      !config.continuous_time &&
+      !config.track_genealogy &&
+      config.measures.empty() &&
+      config.checkpoints.empty();
+}
+
+void RunEnsembleBlock(
+    const SimulationConfig& config,
+    const NeighborTable& table,
+    std::uint64_t base_seed,
+    int first_trial,
+    int last_trial,
+    int* steps
+) {
+  assert(SupportsEnsemble(config));
+  const int N = config.graph.size();
+  const auto num_locations = static_cast<std::uint32_t>(N);
+  const bool birth_death = config.dynamic == Dynamic::BIRTH_DEATH;
+  const int L = kEnsembleLanes;
+
+  // types[i * L + lane] is the type at location i in that lane's trial, and
+  // abundance[t * L + lane] the number of locations holding type t. Without
+  // mutations there are never more than N types.
+  std::vector<int> types(N * L, 0);
+  std::vector<int> abundance(N * L, 0);
+  LaneRng<kEnsembleLanes> lane_rng;
+  int trial_of[kEnsembleLanes];
+  int num_types[kEnsembleLanes];
+  int lane_steps[kEnsembleLanes];
+  std::uint32_t first_draw[kEnsembleLanes];
+  std::uint32_t second_draw[kEnsembleLanes];
+  int active_lanes[kEnsembleLanes];
+  int num_active = 0;
+
+  int next_trial = first_trial;
+  const auto load = [&](int lane) {
+    if (next_trial >= last_trial) return false;
+
+    const int trial = next_trial++;
+    Xoshiro256 rng(base_seed, static_cast<std::uint64_t>(trial));
+    lane_rng.Seed(lane, rng);
+    for (int i = 0; i < N; ++i) {
+      types[i * L + lane] = config.start_with_max_diversity ? i : 0;
+      abundance[i * L + lane] = config.start_with_max_diversity ? 1 : (i == 0 ? N : 0);
+    }
+    trial_of[lane] = trial;
+    num_types[lane] = config.start_with_max_diversity ? N : 1;
+    lane_steps[lane] = 0;
+    return true;
+  };
+  for (int lane = 0; lane < kEnsembleLanes; ++lane) {
+    if (load(lane)) active_lanes[num_active++] = lane;
+  }
+
+  while (num_active > 0) {
+    // Every active lane takes exactly one pair of draws per round, from
+    // either path, so a trial's stream does not depend on how full the block
+    // is. Once most lanes have drained, drawing for all of them costs more
+    // than it saves.
+    const bool vectorised = 4 * num_active >= kEnsembleLanes;
+    if (vectorised) {
+      lane_rng.Next(first_draw);
+      lane_rng.Next(second_draw);
+    }
+
+    for (int a = 0; a < num_active; ++a) {
+      const int lane = active_lanes[a];
+
+      // Retire finished trials before stepping, as Simulate checks before each step.
+      if (num_types[lane] == 1) {
+        steps[trial_of[lane] - first_trial] = lane_steps[lane];
+        RecordTrialProgress(lane_steps[lane]);
+        if (!load(lane)) {
+          // Revisit slot a, which now holds the last active lane.
+          active_lanes[a--] = active_lanes[--num_active];
+        }
+        continue;
+      }
+
+      if (!vectorised) {
+        first_draw[lane] = lane_rng.NextLane(lane);
+        second_draw[lane] = lane_rng.NextLane(lane);
+      }
+      ++lane_steps[lane];
+
+      const int first = static_cast<int>(ScaleToIndex(first_draw[lane], num_locations));
+      const int begin = table.offsets[first];
+      const auto degree = static_cast<std::uint32_t>(table.offsets[first + 1] - begin);
+      // An isolated location still uses up a step, as in Simulate.
+      if (degree == 0) continue;
+      const int second = table.targets[begin + ScaleToIndex(second_draw[lane], degree)];
+
+      const int birther = birth_death ? first : second;
+      const int dier = birth_death ? second : first;
+      const int new_type = types[birther * L + lane];
+      const int old_type = types[dier * L + lane];
+      if (new_type == old_type) continue;
+      types[dier * L + lane] = new_type;
+      ++abundance[new_type * L + lane];
+      if (--abundance[old_type * L + lane] == 0) --num_types[lane];
+    }
+  }
+}
+
+void ComputeEnsembleTrends(const std::map<int, SimulationConfig>& configs, int first_trial, int last_trial,
+                           Trends* trends, TrendSummaries* summaries) {
+  std::vector<int> ns;
+  std::vector<NeighborTable> tables;
+  std::vector<std::uint64_t> base_seeds;
+  for (const auto& n_config : configs) {
+    const auto& config = n_config.second;
+    assert(SupportsEnsemble(config));
+    ns.emplace_back(n_config.first);
+    tables.emplace_back();
+    GetNeighborTable(config.graph, config.dynamic, &tables.back());
+    std::uint64_t base_seed = static_cast<std::uint64_t>(config.seed);
+    if (config.seed == kNoSeed) {
+      std::random_device rd;
+      base_seed = (static_cast<std::uint64_t>(rd()) << 32) | rd();
+    }
+    base_seeds.emplace_back(base_seed);
+    // Pre-size so that each block writes its own slots without locking.
+    if (trends != nullptr) (*trends)[n_config.first].assign(last_trial - first_trial, 0);
+  }
+  const int num_blocks = (last_trial - first_trial + kEnsembleBatchSize - 1) / kEnsembleBatchSize;
+  const int num_ns = static_cast<int>(ns.size());
+
+#pragma omp parallel
+  {
+    TrendSummaries local_summaries;
+    std::vector<int> block_steps(kEnsembleBatchSize);
+
+#pragma omp for collapse(2) schedule(dynamic)
+    for (int block = 0; block < num_blocks; ++block) {
+      for (int i = 0; i < num_ns; ++i) {
+        const int n = ns[i];
+        const int block_first = first_trial + block * kEnsembleBatchSize;
+        const int block_last = std::min(last_trial, block_first + kEnsembleBatchSize);
+        RunEnsembleBlock(configs.at(n), tables[i], base_seeds[i], block_first, block_last, block_steps.data());
+        for (int k = 0; k < block_last - block_first; ++k) {
+          if (trends != nullptr) trends->at(n)[block_first - first_trial + k] = block_steps[k];
+          if (summaries != nullptr) local_summaries[n].Add(block_steps[k]);
+        }
+      }
+    }
+
+    if (summaries != nullptr) {
+#pragma omp critical
+      for (const auto& summary : local_summaries) (*summaries)[summary.first].Merge(summary.second);
+    }
+  }
+}
+
+} // namespace equilibrium
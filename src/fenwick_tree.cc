@@ -0,0 +1,51 @@
+#include <vector>
+
+#include <equilibrium/fenwick_tree.h>
+
+namespace equilibrium {
+
+FenwickTree::FenwickTree(int size) {
+  Reset(std::vector<double>(size, 0.));
+}
+
+void FenwickTree::Reset(const std::vector<double>& weights) {
+  weights_ = weights;
+  const int n = size();
+  tree_.assign(n + 1, 0.);
+  total_ = 0;
+  for (int i = 1; i <= n; ++i) {
+    tree_[i] += weights_[i-1];
+    total_ += weights_[i-1];
+    const int parent = i + (i & -i);
+    if (parent <= n) tree_[parent] += tree_[i];
+  }
+  high_bit_ = 1;
+  while (high_bit_ * 2 <= n) high_bit_ *= 2;
+}
+
+void FenwickTree::Set(int index, double weight) {
+  Add(index, weight - weights_[index]);
+}
+
+void FenwickTree::Add(int index, double delta) {
+  weights_[index] += delta;
+  total_ += delta;
+  for (int i = index + 1; i <= size(); i += i & -i) {
+    tree_[i] += delta;
+  }
+}
+
+int FenwickTree::Find(double u) const {
+  int position = 0;
+  for (int step = high_bit_; step > 0; step >>= 1) {
+    if (position + step <= size() && tree_[position + step] <= u) {
+      position += step;
+      u -= tree_[position];
+    }
+  }
+  // Rounding can push u past the last positive weight.
+  while (position > 0 && (position >= size() || weights_[position] <= 0)) --position;
+  return position;
+}
+
+}  // namespace equilibrium
@@ -0,0 +1,365 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <equilibrium/fixation.h>
+#include <equilibrium/progress.h>
+#include <equilibrium/random.h>
+
+namespace equilibrium {
+
+void TwoTypePopulation::Reset(int size) {
+  size_ = size;
+  num_mutants_ = 0;
+  words_.assign((size + 63) / 64, 0);
+}
+
+bool IsValidFitness(double fitness) {
+  return std::isfinite(fitness) && fitness > 0;
+}
+
+int GetStartNode(const FixationConfig& config, int trial, Xoshiro256& rng) {
+  if (config.start_node == kEveryStartNode) return trial % config.graph.size();
+  if (config.start_node == kRandomStartNode) {
+    return static_cast<int>(UniformIndex(rng, static_cast<std::uint32_t>(config.graph.size())));
+  }
+  return config.start_node;
+}
+
+void AdvanceFixation(
+    const FixationConfig& config,
+    int target_mutants,
+    long long max_steps,
+    Xoshiro256& rng,
+    TwoTypePopulation* population,
+    long long* steps
+) {
+  assert(IsValidFitness(config.mutant_fitness));
+  const auto& graph = config.graph;
+  const auto N = static_cast<std::uint32_t>(graph.size());
+  // Assuming there are only two dynamics: bd and db.
+  const bool birth_death = config.dynamic == Dynamic::BIRTH_DEATH;
+  const auto& neighbors = birth_death ? graph.out_edges() : graph.in_edges();
+
+  // Fitness-proportional choices are made by rejection against the fitter type,
+  // which keeps the state a plain bitset.
+  const double max_fitness = std::max(1., config.mutant_fitness);
+  const double mutant_acceptance = config.mutant_fitness / max_fitness;
+  const double resident_acceptance = 1. / max_fitness;
+  const bool neutral = mutant_acceptance >= 1. && resident_acceptance >= 1.;
+  const auto accept = [&](int location) {
+    return UniformReal(rng) < (population->IsMutant(location) ? mutant_acceptance : resident_acceptance);
+  };
+
+  long long step = *steps;
+  while (!population->IsAbsorbed() && population->num_mutants() < target_mutants &&
+         (max_steps == 0 || step < max_steps)) {
+    ++step;
+    if (step % kProgressStepsPerFlush == 0) RecordStepProgress(kProgressStepsPerFlush);
+    int first = static_cast<int>(UniformIndex(rng, N));
+    if (birth_death && !neutral) {
+      while (!accept(first)) first = static_cast<int>(UniformIndex(rng, N));
+    }
+
+    const auto& first_neighbors = neighbors[first];
+    if (first_neighbors.empty()) continue;
+    const auto num_neighbors = static_cast<std::uint32_t>(first_neighbors.size());
+    int second = first_neighbors[UniformIndex(rng, num_neighbors)];
+    if (!birth_death && !neutral) {
+      while (!accept(second)) second = first_neighbors[UniformIndex(rng, num_neighbors)];
+    }
+
+    if (birth_death) {
+      population->Set(second, population->IsMutant(first));
+    } else {
+      population->Set(first, population->IsMutant(second));
+    }
+  }
+  *steps = step;
+}
+
+void RunFixationTrial(
+    const FixationConfig& config,
+    int start_node,
+    Xoshiro256& rng,
+    TwoTypePopulation* population,
+    FixationTrial* trial
+) {
+  const auto& graph = config.graph;
+  assert(0 <= start_node && start_node < graph.size());
+  population->Reset(graph.size());
+  population->Set(start_node, true);
+
+  long long steps = 0;
+  AdvanceFixation(config, graph.size(), config.max_steps, rng, population, &steps);
+
+  trial->start_node = start_node;
+  trial->steps = steps;
+  RecordTrialProgress(steps % kProgressStepsPerFlush);
+  if (population->num_mutants() == graph.size()) {
+    trial->outcome = FixationOutcome::FIXATION;
+  } else if (population->num_mutants() == 0) {
+    trial->outcome = FixationOutcome::EXTINCTION;
+  } else {
+    trial->outcome = FixationOutcome::UNDECIDED;
+  }
+}
+
+bool FromString(const std::string& engine_str, FixationEngine* engine) {
+  if (engine_str == "scalar") {
+    *engine = FixationEngine::SCALAR;
+    return true;
+  }
+  if (engine_str == "batched") {
+    *engine = FixationEngine::BATCHED;
+    return true;
+  }
+
+  return false;
+}
+
+bool ToString(const FixationEngine& engine, std::string* engine_str) {
+  if (engine == FixationEngine::SCALAR) {
+    *engine_str = "scalar";
+    return true;
+  }
+  if (engine == FixationEngine::BATCHED) {
+    *engine_str = "batched";
+    return true;
+  }
+
+  return false;
+}
+
+void GetNeighborTable(const Graph& graph, const Dynamic& dynamic, NeighborTable* table) {
+  // Assuming there are only two dynamics: bd and db.
+  const auto& neighbors = dynamic == Dynamic::BIRTH_DEATH ? graph.out_edges() : graph.in_edges();
+  table->offsets.assign(1, 0);
+  table->targets.clear();
+  for (int i = 0; i < graph.size(); ++i) {
+    table->targets.insert(table->targets.end(), neighbors[i].begin(), neighbors[i].end());
+    table->offsets.emplace_back(static_cast<int>(table->targets.size()));
+  }
+}
+
+void RunFixationBlock(
+    const FixationConfig& config,
+    const NeighborTable& table,
+    std::uint64_t base_seed,
+    int first_trial,
+    int last_trial,
+    FixationResults* results,
+    std::vector<FixationTrial>* trials
+) {
+  assert(IsValidFitness(config.mutant_fitness));
+  const int N = config.graph.size();
+  const auto num_locations = static_cast<std::uint32_t>(N);
+  const bool birth_death = config.dynamic == Dynamic::BIRTH_DEATH;
+
+  // Acceptance thresholds in 32-bit fixed point; see RunFixationTrial. A
+  // threshold of at least 1 keeps a fitness below 2^-32 from rounding to 0,
+  // which would reject its proposals forever.
+  const double max_fitness = std::max(1., config.mutant_fitness);
+  const double kScale = 4294967296.;
+  const std::uint64_t mutant_threshold =
+      std::max<std::uint64_t>(1, static_cast<std::uint64_t>(config.mutant_fitness / max_fitness * kScale));
+  const std::uint64_t resident_threshold =
+      std::max<std::uint64_t>(1, static_cast<std::uint64_t>(1. / max_fitness * kScale));
+  const bool neutral = mutant_threshold >= 4294967296ULL && resident_threshold >= 4294967296ULL;
+
+  // Bit `lane` of state[i] is the type of location i in that lane's trial.
+  std::vector<std::uint64_t> state(N, 0);
+  LaneRng<kFixationLanes> lane_rng;
+  int trial_of[kFixationLanes];
+  int start_of[kFixationLanes];
+  int num_mutants[kFixationLanes];
+  long long steps[kFixationLanes];
+  // Death-birth keeps its dier while the birther proposal is rejected.
+  int pending_dier[kFixationLanes];
+  std::uint32_t first_draw[kFixationLanes];
+  std::uint32_t second_draw[kFixationLanes];
+  std::uint32_t accept_draw[kFixationLanes];
+  int active_lanes[kFixationLanes];
+  int num_active = 0;
+
+  int next_trial = first_trial;
+  const auto load = [&](int lane) {
+    const std::uint64_t bit = std::uint64_t{1} << lane;
+    for (auto& word : state) word &= ~bit;
+    if (next_trial >= last_trial) return false;
+
+    const int trial = next_trial++;
+    trial_of[lane] = trial;
+    Xoshiro256 rng(base_seed, static_cast<std::uint64_t>(trial));
+    start_of[lane] = GetStartNode(config, trial, rng);
+    lane_rng.Seed(lane, rng);
+    state[start_of[lane]] |= bit;
+    num_mutants[lane] = 1;
+    steps[lane] = 0;
+    pending_dier[lane] = -1;
+    return true;
+  };
+  for (int lane = 0; lane < kFixationLanes; ++lane) {
+    if (load(lane)) active_lanes[num_active++] = lane;
+  }
+
+  while (num_active > 0) {
+    // Every active lane takes exactly one set of draws per round, from either
+    // path, so a trial's stream does not depend on how full the block is.
+    // Once most lanes have drained, drawing for all of them costs more than it saves.
+    const bool vectorised = 4 * num_active >= kFixationLanes;
+    if (vectorised) {
+      lane_rng.Next(first_draw);
+      lane_rng.Next(second_draw);
+      if (!neutral) lane_rng.Next(accept_draw);
+    }
+
+    for (int a = 0; a < num_active; ++a) {
+      const int lane = active_lanes[a];
+
+      // Retire finished trials before stepping, so a trial is never stepped past absorption.
+      const bool absorbed = num_mutants[lane] == 0 || num_mutants[lane] == N;
+      if (absorbed || (config.max_steps > 0 && steps[lane] >= config.max_steps)) {
+        FixationTrial fixation_trial;
+        fixation_trial.start_node = start_of[lane];
+        fixation_trial.steps = steps[lane];
+        fixation_trial.outcome = !absorbed ? FixationOutcome::UNDECIDED
+            : (num_mutants[lane] == N ? FixationOutcome::FIXATION : FixationOutcome::EXTINCTION);
+        AddFixationTrial(fixation_trial, results);
+        if (trials != nullptr) (*trials)[trial_of[lane] - first_trial] = fixation_trial;
+        RecordTrialProgress(steps[lane]);
+        if (!load(lane)) {
+          // Revisit slot a, which now holds the last active lane.
+          active_lanes[a--] = active_lanes[--num_active];
+        }
+        continue;
+      }
+
+      if (!vectorised) {
+        first_draw[lane] = lane_rng.NextLane(lane);
+        second_draw[lane] = lane_rng.NextLane(lane);
+        if (!neutral) accept_draw[lane] = lane_rng.NextLane(lane);
+      }
+
+      const std::uint64_t bit = std::uint64_t{1} << lane;
+      const auto accept = [&](int location) {
+        return neutral || accept_draw[lane] < ((state[location] & bit) ? mutant_threshold : resident_threshold);
+      };
+
+      int first;
+      if (birth_death) {
+        // A rejected birther proposal is not a step.
+        first = static_cast<int>(ScaleToIndex(first_draw[lane], num_locations));
+        if (!accept(first)) continue;
+        ++steps[lane];
+      } else {
+        if (pending_dier[lane] < 0) {
+          pending_dier[lane] = static_cast<int>(ScaleToIndex(first_draw[lane], num_locations));
+          ++steps[lane];
+        }
+        first = pending_dier[lane];
+      }
+
+      const int begin = table.offsets[first];
+      const auto degree = static_cast<std::uint32_t>(table.offsets[first + 1] - begin);
+      if (degree > 0) {
+        const int second = table.targets[begin + ScaleToIndex(second_draw[lane], degree)];
+        if (!birth_death && !accept(second)) continue;
+
+        const int birther = birth_death ? first : second;
+        const int dier = birth_death ? second : first;
+        const bool mutant = (state[birther] & bit) != 0;
+        if (mutant != ((state[dier] & bit) != 0)) {
+          num_mutants[lane] += mutant ? 1 : -1;
+          state[dier] ^= bit;
+        }
+      }
+      pending_dier[lane] = -1;
+    }
+  }
+}
+
+void AddFixationTrial(const FixationTrial& trial, FixationResults* results) {
+  auto& result = (*results)[trial.start_node];
+  ++result.trials;
+  if (trial.outcome == FixationOutcome::FIXATION) {
+    ++result.fixations;
+    result.fixation_time.Add(static_cast<double>(trial.steps));
+  } else if (trial.outcome == FixationOutcome::EXTINCTION) {
+    result.extinction_time.Add(static_cast<double>(trial.steps));
+  } else {
+    ++result.undecided;
+  }
+}
+
+void MergeFixationResult(const FixationResult& from, FixationResult* into) {
+  into->trials += from.trials;
+  into->fixations += from.fixations;
+  into->undecided += from.undecided;
+  into->fixation_time.Merge(from.fixation_time);
+  into->extinction_time.Merge(from.extinction_time);
+}
+
+void MergeFixationResults(const FixationResults& from, FixationResults* into) {
+  for (const auto& node_result : from) {
+    MergeFixationResult(node_result.second, &(*into)[node_result.first]);
+  }
+}
+
+void ComputeFixation(const FixationConfig& config, FixationResults* results) {
+  assert(config.graph.size() > 0);
+  assert(config.batch_size > 0);
+  std::uint64_t base_seed = static_cast<std::uint64_t>(config.seed);
+  if (config.seed == kNoSeed) {
+    std::random_device rd;
+    base_seed = (static_cast<std::uint64_t>(rd()) << 32) | rd();
+  }
+
+  if (config.engine == FixationEngine::BATCHED) {
+    NeighborTable table;
+    GetNeighborTable(config.graph, config.dynamic, &table);
+    const int num_blocks = (config.num_simulations + config.batch_size - 1) / config.batch_size;
+
+#pragma omp parallel
+    {
+      FixationResults local_results;
+
+#pragma omp for schedule(dynamic) nowait
+      for (int block = 0; block < num_blocks; ++block) {
+        const int first_trial = block * config.batch_size;
+        const int last_trial = std::min(config.num_simulations, first_trial + config.batch_size);
+        RunFixationBlock(config, table, base_seed, first_trial, last_trial, &local_results);
+      }
+
+#pragma omp critical
+      {
+        MergeFixationResults(local_results, results);
+      }
+    }
+    return;
+  }
+
+#pragma omp parallel
+  {
+    TwoTypePopulation population;
+    FixationResults local_results;
+
+#pragma omp for schedule(dynamic, config.batch_size) nowait
+    for (int trial = 0; trial < config.num_simulations; ++trial) {
+      Xoshiro256 rng(base_seed, static_cast<std::uint64_t>(trial));
+      FixationTrial fixation_trial;
+      RunFixationTrial(config, GetStartNode(config, trial, rng), rng, &population, &fixation_trial);
+      AddFixationTrial(fixation_trial, &local_results);
+    }
+
+#pragma omp critical
+    {
+      MergeFixationResults(local_results, results);
+    }
+  }
+}
+
+}  // namespace equilibrium
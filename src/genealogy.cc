@@ -0,0 +1,90 @@
+#include <algorithm>
+#include <cassert>
+
+#include <equilibrium/genealogy.h>
+
+namespace equilibrium {
+
+void Genealogy::Reset(const std::vector<int>& location_to_type) {
+  nodes_.clear();
+  num_roots_ = 0;
+  for (const auto& type : location_to_type) {
+    auto it = nodes_.find(type);
+    if (it == nodes_.end()) {
+      nodes_[type] = {kNoAncestry, 0, 1, {}};
+      ++num_roots_;
+    } else {
+      ++it->second.abundance;
+    }
+  }
+}
+
+void Genealogy::AddType(int type, int parent, int step) {
+  assert(nodes_.find(type) == nodes_.end());
+  nodes_[type] = {parent, step, 0, {}};
+  if (parent == kNoAncestry) {
+    ++num_roots_;
+  } else {
+    nodes_.at(parent).children.push_back(type);
+  }
+}
+
+void Genealogy::Replace(int old_type, int new_type) {
+  if (old_type == new_type) return;
+  ++nodes_.at(new_type).abundance;
+  auto& old_node = nodes_.at(old_type);
+  --old_node.abundance;
+  assert(old_node.abundance >= 0);
+  if (old_node.abundance == 0 && old_node.children.empty()) Prune(old_type);
+}
+
+void Genealogy::Prune(int type) {
+  while (true) {
+    const int parent = nodes_.at(type).parent;
+    nodes_.erase(type);
+    if (parent == kNoAncestry) {
+      --num_roots_;
+      return;
+    }
+    auto& parent_node = nodes_.at(parent);
+    auto& siblings = parent_node.children;
+    siblings.erase(std::find(siblings.begin(), siblings.end(), type));
+    if (parent_node.abundance > 0 || !siblings.empty()) return;
+    type = parent;
+  }
+}
+
+int Genealogy::MostRecentCommonAncestor() const {
+  if (num_roots_ != 1) return kNoAncestry;
+  int type = kNoAncestry;
+  for (const auto& node : nodes_) {
+    if (node.second.parent == kNoAncestry) {
+      type = node.first;
+      break;
+    }
+  }
+  // Walk down while a single child carries every living type.
+  while (true) {
+    const auto& node = nodes_.at(type);
+    if (node.abundance > 0 || node.children.size() != 1) return type;
+    type = node.children[0];
+  }
+}
+
+int Genealogy::TimeToMostRecentCommonAncestor(int step) const {
+  const int type = MostRecentCommonAncestor();
+  if (type == kNoAncestry) return -1;
+  return step - nodes_.at(type).birth_step;
+}
+
+void Genealogy::GetNodes(std::vector<GenealogyNode>* nodes) const {
+  nodes->clear();
+  nodes->reserve(nodes_.size());
+  for (const auto& node : nodes_) {
+    nodes->push_back({node.first, node.second.parent, node.second.birth_step, node.second.abundance});
+  }
+  std::sort(nodes->begin(), nodes->end(),
+            [](const GenealogyNode& a, const GenealogyNode& b) { return a.type < b.type; });
+}
+
+} // namespace equilibrium
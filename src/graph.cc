@@ -1,5 +1,6 @@
 #include <functional>
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
 #include <utility>
@@ -9,8 +10,23 @@
 namespace equilibrium {
 
 
-Graph::Graph(const int N, const std::string& name, const std::vector<std::vector<int>>& out_edges) : size_(N), name_(name), out_edges_(out_edges) {
- ComputeInEdges();
+Graph::Graph(const int N, const std::string& name, const std::vector<std::vector<int>>& out_edges)
+    : Graph(N, name, out_edges, {}) {}
+
+Graph::Graph(const int N, const std::string& name, const std::vector<std::vector<int>>& out_edges,
+             const std::vector<std::vector<double>>& out_weights)
+    : size_(N), name_(name) {
+  std::shared_ptr<Edges> edges = std::make_shared<Edges>();
+  edges->out_edges = out_edges;
+  edges->out_weights = out_weights;
+  ComputeInEdges(N, edges.get());
+  edges_ = edges;
+}
+
+Graph Graph::DeepCopy() const {
+  Graph copy = *this;
+  copy.edges_ = std::make_shared<const Edges>(*edges_);
+  return copy;
 }
 
 Graph CompleteGraph(int N) {
@@ -211,14 +227,49 @@ bool IsBidirectional(const Graph& graph) {
   return true;
 }
 
-void Graph::ComputeInEdges() {
-  // Assumes graph.out_edges is already specified.
-  in_edges_.clear();
-  in_edges_.resize(size_);
+bool ReadEdgeWeights(std::istream* is, Graph* graph) {
+  std::vector<std::vector<double>> out_weights = graph->out_weights();
+  if (!graph->weighted()) {
+    out_weights.resize(graph->size());
+    for (int i = 0; i < graph->size(); ++i) {
+      out_weights[i].assign(graph->out_edges()[i].size(), 1.);
+    }
+  }
+
+  int from;
+  int to;
+  double weight;
+  while ((*is) >> from >> to >> weight) {
+    if (from < 0 || from >= graph->size() || weight < 0) return false;
+    const auto& edges = graph->out_edges()[from];
+    bool found = false;
+    for (int k = 0; k < static_cast<int>(edges.size()); ++k) {
+      if (edges[k] == to) {
+        out_weights[from][k] = weight;
+        found = true;
+      }
+    }
+    if (!found) return false;
+  }
+  if (!is->eof()) return false;
+
+  *graph = Graph(graph->size(), graph->name(), graph->out_edges(), out_weights);
+  return true;
+}
 
-  for (int i = 0; i < size_; ++i) {
-    for (int j : out_edges_[i]) {
-      in_edges_[j].emplace_back(i);
+void Graph::ComputeInEdges(int size, Edges* edges) {
+  // Assumes edges->out_edges is already specified.
+  const bool weighted = !edges->out_weights.empty();
+  edges->in_edges.clear();
+  edges->in_edges.resize(size);
+  edges->in_weights.clear();
+  if (weighted) edges->in_weights.resize(size);
+
+  for (int i = 0; i < size; ++i) {
+    for (int k = 0; k < static_cast<int>(edges->out_edges[i].size()); ++k) {
+      const int j = edges->out_edges[i][k];
+      edges->in_edges[j].emplace_back(i);
+      if (weighted) edges->in_weights[j].emplace_back(edges->out_weights[i][k]);
     }
   }
 }
@@ -0,0 +1,241 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <equilibrium/lumped.h>
+#include <equilibrium/progress.h>
+
+namespace equilibrium {
+
+namespace {
+
+/// Adds the steps up to and including the next effective one, when each
+/// step is effective with probability q. False when *steps would overflow.
+bool AddGeometricSteps(Xoshiro256& rng, double q, long long* steps) {
+  const long long room = std::numeric_limits<long long>::max() - *steps;
+  if (room < 1) return false;
+  if (q >= 1) {
+    ++*steps;
+    return true;
+  }
+  const double u = 1. - UniformReal(rng);
+  const double skipped = std::floor(std::log(u) / std::log1p(-q));
+  // Compared as doubles, before the cast could overflow.
+  if (!(skipped < static_cast<double>(room - 1))) return false;
+  *steps += 1 + static_cast<long long>(skipped);
+  return true;
+}
+
+bool IsLumpedStar(const Graph& graph, LumpedGraph* lumped) {
+  const int N = graph.size();
+  const auto& out_edges = graph.out_edges();
+  if (N > 0 && static_cast<int>(out_edges[0].size()) != N - 1) return false;
+  for (int i = 1; i < N; ++i) {
+    if (out_edges[i].size() != 1 || out_edges[i][0] != 0) return false;
+  }
+  lumped->hub_leaves = {std::max(N - 1, 0)};
+  return true;
+}
+
+/// Hubs 0 and 1; even locations are leaves of 0, odd ones leaves of 1.
+bool IsLumpedDoubleStar(const Graph& graph, LumpedGraph* lumped) {
+  const int N = graph.size();
+  if (N < 2) return IsLumpedStar(graph, lumped);
+  const auto& out_edges = graph.out_edges();
+  lumped->hub_leaves = {0, 0};
+  for (int i = 2; i < N; ++i) {
+    if (out_edges[i].size() != 1 || out_edges[i][0] != i % 2) return false;
+    ++lumped->hub_leaves[i % 2];
+  }
+  for (int hub = 0; hub < 2; ++hub) {
+    if (static_cast<int>(out_edges[hub].size()) != lumped->hub_leaves[hub] + 1) return false;
+    for (const auto& j : out_edges[hub]) {
+      if (j != 1 - hub && (j < 2 || j % 2 != hub)) return false;
+    }
+  }
+  return true;
+}
+
+bool RunCompleteTrial(const LumpedGraph& graph, Xoshiro256& rng, long long* steps) {
+  // Both dynamics copy along a uniform ordered pair of distinct locations, and
+  // k lineages coalesce when the pair falls among them.
+  const double n = graph.size;
+  for (int k = graph.size; k > 1; --k) {
+    if (!AddGeometricSteps(rng, k * (k - 1.) / (n * (n - 1)), steps)) return false;
+  }
+  return true;
+}
+
+bool RunHubTrial(const SimulationConfig& config, const LumpedGraph& graph, Xoshiro256& rng, long long* steps) {
+  const int N = graph.size;
+  const int num_hubs = static_cast<int>(graph.hub_leaves.size());
+  assert(num_hubs <= 2);
+  const bool birth_death = config.dynamic == Dynamic::BIRTH_DEATH;
+
+  // A step copies location i into j, and takes a lineage at j back to i,
+  // merging it with any lineage there. Birth-death picks the pair with
+  // probability 1 / (N deg(i)), death-birth with 1 / (N deg(j)). Per hub,
+  // rates times N of: a leaf lineage moving to the hub, the hub lineage
+  // moving to a leaf with or without a lineage, and to the other hub.
+  const int kEvents = 4;
+  int hub_lineage[2];
+  int leaf_lineages[2];
+  double degree[2];
+  double rates[2 * kEvents];
+  for (int hub = 0; hub < num_hubs; ++hub) {
+    hub_lineage[hub] = 1;
+    leaf_lineages[hub] = graph.hub_leaves[hub];
+    degree[hub] = graph.hub_leaves[hub] + num_hubs - 1;
+  }
+  int num_lineages = N;
+  while (num_lineages > 1) {
+    double total = 0;
+    for (int hub = 0; hub < num_hubs; ++hub) {
+      const double leaf_weight = birth_death ? 1. / degree[hub] : 1.;
+      const double hub_weight = birth_death ? 1. : 1. / degree[hub];
+      double* rate = rates + hub * kEvents;
+      rate[0] = leaf_lineages[hub] * leaf_weight;
+      rate[1] = hub_lineage[hub] * leaf_lineages[hub] * hub_weight;
+      rate[2] = hub_lineage[hub] * (graph.hub_leaves[hub] - leaf_lineages[hub]) * hub_weight;
+      rate[3] = num_hubs == 2 && hub_lineage[hub] ? 1. / (birth_death ? degree[1 - hub] : degree[hub]) : 0.;
+      for (int e = 0; e < kEvents; ++e) total += rate[e];
+    }
+    if (!AddGeometricSteps(rng, total / N, steps)) return false;
+
+    // Rounding may leave u just past the last rate; the last possible event
+    // takes it.
+    double u = UniformReal(rng) * total;
+    int event = -1;
+    for (int e = 0; e < num_hubs * kEvents; ++e) {
+      if (!(rates[e] > 0)) continue;
+      event = e;
+      if (u < rates[e]) break;
+      u -= rates[e];
+    }
+    const int hub = event / kEvents;
+    const int other = 1 - hub;
+    switch (event % kEvents) {
+      case 0:
+        --leaf_lineages[hub];
+        if (hub_lineage[hub]) --num_lineages;
+        hub_lineage[hub] = 1;
+        break;
+      case 1:
+        hub_lineage[hub] = 0;
+        --num_lineages;
+        break;
+      case 2:
+        hub_lineage[hub] = 0;
+        ++leaf_lineages[hub];
+        break;
+      case 3:
+        hub_lineage[hub] = 0;
+        if (hub_lineage[other]) --num_lineages;
+        hub_lineage[other] = 1;
+        break;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+bool GetLumpedGraph(const Graph& graph, LumpedGraph* lumped) {
+  lumped->size = graph.size();
+  lumped->complete = false;
+  lumped->hub_leaves.clear();
+  if (graph.weighted()) return false;
+
+  if (graph.name() == "complete") {
+    for (int i = 0; i < graph.size(); ++i) {
+      if (static_cast<int>(graph.out_edges()[i].size()) != graph.size() - 1) return false;
+      for (const auto& j : graph.out_edges()[i]) {
+        if (j == i) return false;
+      }
+    }
+    lumped->complete = true;
+    return true;
+  }
+  if (graph.name() == "star") return IsLumpedStar(graph, lumped);
+  if (graph.name() == "double star") return IsLumpedDoubleStar(graph, lumped);
+  return false;
+}
+
+bool SupportsLumped(const SimulationConfig& config) {
+  LumpedGraph lumped;
+  return config.run_until_homogeneous &&
+      !(config.birth_mutation_rate > 0) &&
+      !(config.independent_mutation_rate > 0) &&
+      HasUniformRates(config.node_rates) &&
+      !config.capture_history &&
+      !config.continuous_time &&
+      !config.track_genealogy &&
+      config.measures.empty() &&
+      config.checkpoints.empty() &&
+      GetLumpedGraph(config.graph, &lumped);
+}
+
+bool RunLumpedTrial(const SimulationConfig& config, const LumpedGraph& graph, Xoshiro256& rng, long long* steps) {
+  *steps = 0;
+  // A single type from the start is already homogeneous.
+  if (!config.start_with_max_diversity || graph.size <= 1) return true;
+  if (graph.complete) return RunCompleteTrial(graph, rng, steps);
+  return RunHubTrial(config, graph, rng, steps);
+}
+
+bool ComputeLumpedTrends(const std::map<int, SimulationConfig>& configs, int first_trial, int last_trial,
+                         Trends* trends, TrendSummaries* summaries) {
+  std::vector<int> ns;
+  std::vector<LumpedGraph> graphs;
+  std::vector<std::uint64_t> base_seeds;
+  for (const auto& n_config : configs) {
+    const auto& config = n_config.second;
+    assert(SupportsLumped(config));
+    ns.emplace_back(n_config.first);
+    graphs.emplace_back();
+    GetLumpedGraph(config.graph, &graphs.back());
+    std::uint64_t base_seed = static_cast<std::uint64_t>(config.seed);
+    if (config.seed == kNoSeed) {
+      std::random_device rd;
+      base_seed = (static_cast<std::uint64_t>(rd()) << 32) | rd();
+    }
+    base_seeds.emplace_back(base_seed);
+    // Pre-size so that each trial writes its own slot without locking.
+    if (trends != nullptr) (*trends)[n_config.first].assign(last_trial - first_trial, 0);
+  }
+  const int num_ns = static_cast<int>(ns.size());
+  bool overflow = false;
+
+#pragma omp parallel
+  {
+    TrendSummaries local_summaries;
+
+#pragma omp for collapse(2) schedule(dynamic)
+    for (int trial = first_trial; trial < last_trial; ++trial) {
+      for (int i = 0; i < num_ns; ++i) {
+        const int n = ns[i];
+        Xoshiro256 rng(base_seeds[i], static_cast<std::uint64_t>(trial));
+        long long steps;
+        if (!RunLumpedTrial(configs.at(n), graphs[i], rng, &steps)) {
+#pragma omp atomic write
+          overflow = true;
+        }
+        RecordTrialProgress(steps);
+        if (trends != nullptr) trends->at(n)[trial - first_trial] = steps;
+        if (summaries != nullptr) local_summaries[n].Add(static_cast<double>(steps));
+      }
+    }
+
+    if (summaries != nullptr) {
+#pragma omp critical
+      for (const auto& summary : local_summaries) (*summaries)[summary.first].Merge(summary.second);
+    }
+  }
+  return !overflow;
+}
+
+} // namespace equilibrium
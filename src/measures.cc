@@ -0,0 +1,371 @@
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <queue>
+#include <sstream>
+
+#include <equilibrium/measures.h>
+
+namespace equilibrium {
+
+void MeasureTracker::Reset(const std::vector<int>* location_to_type) {
+  location_to_type_ = location_to_type;
+  step_ = 0;
+  DoReset();
+}
+
+void MeasureTracker::ResizeValues(int size) {
+  values_.assign(size, 0.);
+  integrals_.assign(size, 0.);
+  last_steps_.assign(size, 0);
+}
+
+void MeasureTracker::Replace(int location, int old_type, int new_type, int step) {
+  if (old_type == new_type) return;
+  step_ = step;
+  DoReplace(location, old_type, new_type);
+}
+
+void MeasureTracker::SetValue(int index, double value) {
+  integrals_[index] += values_[index] * (step_ - last_steps_[index]);
+  last_steps_[index] = step_;
+  values_[index] = value;
+}
+
+void MeasureTracker::GetResult(int step, MeasureResult* result) const {
+  result->name = name_;
+  result->final = values_;
+  result->time_average.resize(values_.size());
+  for (int i = 0; i < static_cast<int>(values_.size()); ++i) {
+    result->time_average[i] = step > 0
+        ? (integrals_[i] + values_[i] * (step - last_steps_[i])) / step
+        : values_[i];
+  }
+}
+
+namespace {
+
+/// Shared bookkeeping for measures that only depend on type abundances.
+class AbundanceMeasure : public MeasureTracker {
+ public:
+  using MeasureTracker::MeasureTracker;
+
+ protected:
+  void DoReset() override {
+    abundance_.assign(num_locations() + 1, 0);
+    for (const auto& type : location_to_type()) ++abundance_[type];
+    Init();
+  }
+
+  void DoReplace(int, int old_type, int new_type) override {
+    const int old_abundance = abundance_[old_type]--;
+    const int new_abundance = abundance_[new_type]++;
+    Move(old_abundance, new_abundance);
+  }
+
+  /// Called once abundance_ is filled.
+  virtual void Init() = 0;
+  /// A location left a type of abundance from and joined one of abundance
+  /// to (both counted before the move).
+  virtual void Move(int from, int to) = 0;
+
+  std::vector<int> abundance_;
+};
+
+class AbundanceSpectrum : public AbundanceMeasure {
+ public:
+  AbundanceSpectrum() : AbundanceMeasure("abundance_spectrum") {}
+  std::unique_ptr<MeasureTracker> Clone() const override {
+    return std::unique_ptr<MeasureTracker>(new AbundanceSpectrum());
+  }
+
+ protected:
+  void Init() override {
+    ResizeValues(num_locations());
+    for (const auto& a : abundance_) {
+      if (a > 0) SetValue(a - 1, value(a - 1) + 1);
+    }
+  }
+
+  void Move(int from, int to) override {
+    SetValue(from - 1, value(from - 1) - 1);
+    if (from > 1) SetValue(from - 2, value(from - 2) + 1);
+    if (to > 0) SetValue(to - 1, value(to - 1) - 1);
+    SetValue(to, value(to) + 1);
+  }
+};
+
+class Shannon : public AbundanceMeasure {
+ public:
+  Shannon() : AbundanceMeasure("shannon") {}
+  std::unique_ptr<MeasureTracker> Clone() const override {
+    return std::unique_ptr<MeasureTracker>(new Shannon());
+  }
+
+ protected:
+  void Init() override {
+    ResizeValues(1);
+    a_log_a_.resize(num_locations() + 1);
+    for (int a = 0; a <= num_locations(); ++a) a_log_a_[a] = a > 0 ? a * std::log(a) : 0.;
+    sum_ = 0;
+    for (const auto& a : abundance_) sum_ += a_log_a_[a];
+    Publish();
+  }
+
+  void Move(int from, int to) override {
+    sum_ += a_log_a_[from - 1] - a_log_a_[from] + a_log_a_[to + 1] - a_log_a_[to];
+    Publish();
+  }
+
+ private:
+  // H = log N - sum(a log a) / N.
+  void Publish() {
+    const double n = num_locations();
+    SetValue(0, std::log(n) - sum_ / n);
+  }
+
+  std::vector<double> a_log_a_;
+  double sum_ = 0;
+};
+
+/// Tracks the sum of squared abundances exactly.
+class SquaredAbundanceMeasure : public AbundanceMeasure {
+ public:
+  using AbundanceMeasure::AbundanceMeasure;
+
+ protected:
+  void Init() override {
+    ResizeValues(1);
+    sum_squares_ = 0;
+    for (const auto& a : abundance_) sum_squares_ += static_cast<long long>(a) * a;
+    Publish();
+  }
+
+  void Move(int from, int to) override {
+    // (a-1)^2 - a^2 and (b+1)^2 - b^2.
+    sum_squares_ += 2LL * (to - from) + 2;
+    Publish();
+  }
+
+  virtual void Publish() = 0;
+
+  long long sum_squares_ = 0;
+};
+
+class Simpson : public SquaredAbundanceMeasure {
+ public:
+  Simpson() : SquaredAbundanceMeasure("simpson") {}
+  std::unique_ptr<MeasureTracker> Clone() const override {
+    return std::unique_ptr<MeasureTracker>(new Simpson());
+  }
+
+ protected:
+  void Publish() override {
+    const long long n = num_locations();
+    SetValue(0, n > 1 ? static_cast<double>(sum_squares_ - n) / static_cast<double>(n * (n - 1)) : 1.);
+  }
+};
+
+class UnmatchingPairs : public SquaredAbundanceMeasure {
+ public:
+  UnmatchingPairs() : SquaredAbundanceMeasure("unmatching_pairs") {}
+  std::unique_ptr<MeasureTracker> Clone() const override {
+    return std::unique_ptr<MeasureTracker>(new UnmatchingPairs());
+  }
+
+ protected:
+  void Publish() override {
+    const long long n = num_locations();
+    SetValue(0, static_cast<double>((n * n - sum_squares_) / 2));
+  }
+};
+
+class UnmatchingLinks : public MeasureTracker {
+ public:
+  explicit UnmatchingLinks(const Graph& graph)
+      : MeasureTracker("unmatching_links"), graph_(std::make_shared<Graph>(graph)) {}
+  std::unique_ptr<MeasureTracker> Clone() const override {
+    return std::unique_ptr<MeasureTracker>(new UnmatchingLinks(*this));
+  }
+
+ protected:
+  void DoReset() override {
+    ResizeValues(1);
+    const auto& types = location_to_type();
+    long long count = 0;
+    for (int i = 0; i < graph_->size(); ++i) {
+      for (const auto& j : graph_->out_edges()[i]) count += types[i] != types[j];
+    }
+    SetValue(0, static_cast<double>(count));
+  }
+
+  void DoReplace(int location, int old_type, int new_type) override {
+    const auto& types = location_to_type();
+    long long delta = 0;
+    for (const auto& j : graph_->out_edges()[location]) {
+      delta += (new_type != types[j]) - (old_type != types[j]);
+    }
+    for (const auto& j : graph_->in_edges()[location]) {
+      delta += (new_type != types[j]) - (old_type != types[j]);
+    }
+    SetValue(0, value(0) + static_cast<double>(delta));
+  }
+
+ private:
+  std::shared_ptr<const Graph> graph_;
+};
+
+/// Locations exactly k undirected hops from each location, as CSR.
+struct DistanceTable {
+  std::vector<int> offsets;
+  std::vector<int> locations;
+};
+
+std::shared_ptr<const DistanceTable> ComputeDistanceTable(const Graph& graph, int k) {
+  std::vector<std::vector<int>> neighbors(graph.size());
+  for (int i = 0; i < graph.size(); ++i) {
+    for (const auto& j : graph.out_edges()[i]) {
+      neighbors[i].push_back(j);
+      neighbors[j].push_back(i);
+    }
+  }
+
+  auto table = std::make_shared<DistanceTable>();
+  table->offsets.push_back(0);
+  std::vector<int> distance(graph.size(), -1);
+  std::vector<int> visited;
+  for (int source = 0; source < graph.size(); ++source) {
+    std::queue<int> frontier;
+    frontier.push(source);
+    distance[source] = 0;
+    visited.assign(1, source);
+    while (!frontier.empty()) {
+      const int i = frontier.front();
+      frontier.pop();
+      if (distance[i] == k) {
+        table->locations.push_back(i);
+        continue;
+      }
+      for (const auto& j : neighbors[i]) {
+        if (distance[j] >= 0) continue;
+        distance[j] = distance[i] + 1;
+        visited.push_back(j);
+        frontier.push(j);
+      }
+    }
+    for (const auto& i : visited) distance[i] = -1;
+    table->offsets.push_back(static_cast<int>(table->locations.size()));
+  }
+  return table;
+}
+
+class Autocorrelation : public SquaredAbundanceMeasure {
+ public:
+  Autocorrelation(const std::string& name, std::shared_ptr<const DistanceTable> table)
+      : SquaredAbundanceMeasure(name), table_(table) {}
+  std::unique_ptr<MeasureTracker> Clone() const override {
+    return std::unique_ptr<MeasureTracker>(new Autocorrelation(name(), table_));
+  }
+
+ protected:
+  void Init() override {
+    const auto& types = location_to_type();
+    matching_ = 0;
+    for (int i = 0; i < num_locations(); ++i) {
+      for (int p = table_->offsets[i]; p < table_->offsets[i+1]; ++p) {
+        matching_ += types[i] == types[table_->locations[p]];
+      }
+    }
+    SquaredAbundanceMeasure::Init();
+  }
+
+  void DoReplace(int location, int old_type, int new_type) override {
+    const auto& types = location_to_type();
+    for (int p = table_->offsets[location]; p < table_->offsets[location+1]; ++p) {
+      const int j = types[table_->locations[p]];
+      // Each unordered pair is listed from both ends.
+      matching_ += 2 * ((new_type == j) - (old_type == j));
+    }
+    SquaredAbundanceMeasure::DoReplace(location, old_type, new_type);
+  }
+
+  void Publish() override {
+    const long long n = num_locations();
+    if (table_->locations.empty() || n < 2 || sum_squares_ == n * n) {
+      SetValue(0, 0.);
+      return;
+    }
+    const double f_k = static_cast<double>(matching_) / static_cast<double>(table_->locations.size());
+    const double f = static_cast<double>(sum_squares_ - n) / static_cast<double>(n * (n - 1));
+    SetValue(0, (f_k - f) / (1 - f));
+  }
+
+ private:
+  std::shared_ptr<const DistanceTable> table_;
+  long long matching_ = 0;
+};
+
+const char kAutocorrelationPrefix[] = "autocorrelation_";
+
+}  // namespace
+
+bool MakeMeasureTracker(const std::string& name, const Graph& graph, std::shared_ptr<const MeasureTracker>* tracker) {
+  if (name == "abundance_spectrum") {
+    tracker->reset(new AbundanceSpectrum());
+  } else if (name == "shannon") {
+    tracker->reset(new Shannon());
+  } else if (name == "simpson") {
+    tracker->reset(new Simpson());
+  } else if (name == "unmatching_pairs") {
+    tracker->reset(new UnmatchingPairs());
+  } else if (name == "unmatching_links") {
+    tracker->reset(new UnmatchingLinks(graph));
+  } else if (name.compare(0, sizeof(kAutocorrelationPrefix) - 1, kAutocorrelationPrefix) == 0) {
+    const std::string k_str = name.substr(sizeof(kAutocorrelationPrefix) - 1);
+    char* end = nullptr;
+    const long k = std::strtol(k_str.c_str(), &end, 10);
+    if (k_str.empty() || *end != '\0' || k < 1 || k > std::numeric_limits<int>::max()) return false;
+    tracker->reset(new Autocorrelation(name, ComputeDistanceTable(graph, static_cast<int>(k))));
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool MakeMeasureTrackers(const std::string& names, const Graph& graph,
+                         std::vector<std::shared_ptr<const MeasureTracker>>* trackers) {
+  trackers->clear();
+  std::stringstream ss(names);
+  std::string name;
+  while (std::getline(ss, name, ',')) {
+    if (name.empty()) continue;
+    std::shared_ptr<const MeasureTracker> tracker;
+    if (!MakeMeasureTracker(name, graph, &tracker)) return false;
+    trackers->push_back(tracker);
+  }
+  return true;
+}
+
+void AddMeasureResult(const MeasureResult& result, MeasureSummaries* summaries) {
+  auto& summary = (*summaries)[result.name];
+  summary.final.resize(result.final.size());
+  summary.time_average.resize(result.time_average.size());
+  for (int i = 0; i < static_cast<int>(result.final.size()); ++i) summary.final[i].Add(result.final[i]);
+  for (int i = 0; i < static_cast<int>(result.time_average.size()); ++i) {
+    summary.time_average[i].Add(result.time_average[i]);
+  }
+}
+
+void MergeMeasureSummaries(const MeasureSummaries& from, MeasureSummaries* to) {
+  for (const auto& entry : from) {
+    auto& summary = (*to)[entry.first];
+    summary.final.resize(entry.second.final.size());
+    summary.time_average.resize(entry.second.time_average.size());
+    for (int i = 0; i < static_cast<int>(entry.second.final.size()); ++i) summary.final[i].Merge(entry.second.final[i]);
+    for (int i = 0; i < static_cast<int>(entry.second.time_average.size()); ++i) {
+      summary.time_average[i].Merge(entry.second.time_average[i]);
+    }
+  }
+}
+
+} // namespace equilibrium
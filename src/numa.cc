@@ -0,0 +1,127 @@
+#include <cstddef>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <equilibrium/numa.h>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+namespace equilibrium {
+
+namespace {
+
+/// Parses a kernel cpulist such as "0-3,8,10-11".
+std::vector<int> ParseCpuList(const std::string& list) {
+  std::vector<int> cpus;
+  std::istringstream is(list);
+  std::string range;
+  while (std::getline(is, range, ',')) {
+    const auto dash = range.find('-');
+    try {
+      const int first = std::stoi(range.substr(0, dash));
+      const int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+      for (int cpu = first; cpu <= last; ++cpu) cpus.emplace_back(cpu);
+    } catch (const std::exception&) {
+      // Blank or malformed entry.
+    }
+  }
+  return cpus;
+}
+
+}  // namespace
+
+void GetNumaTopology(NumaTopology* topology) {
+  topology->node_cpus.clear();
+#ifdef __linux__
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return;
+
+  // Node ids may have gaps; stop after a long run of missing ones.
+  for (int node = 0, missing = 0; missing < 64; ++node) {
+    std::ifstream is("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+    std::string list;
+    if (!std::getline(is, list)) {
+      ++missing;
+      continue;
+    }
+    missing = 0;
+    std::vector<int> cpus;
+    for (const int cpu : ParseCpuList(list)) {
+      if (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed)) cpus.emplace_back(cpu);
+    }
+    if (!cpus.empty()) topology->node_cpus.emplace_back(cpus);
+  }
+
+  if (topology->node_cpus.empty()) {
+    topology->node_cpus.emplace_back();
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &allowed)) topology->node_cpus.back().emplace_back(cpu);
+    }
+  }
+#endif
+}
+
+int PinThread(const NumaTopology& topology, int thread) {
+#ifdef __linux__
+  if (topology.num_nodes() == 0) return -1;
+  const int node = thread % topology.num_nodes();
+  const auto& cpus = topology.node_cpus[node];
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  CPU_SET(cpus[(thread / topology.num_nodes()) % cpus.size()], &cpu_set);
+  return sched_setaffinity(0, sizeof(cpu_set), &cpu_set) == 0 ? node : -1;
+#else
+  return -1;
+#endif
+}
+
+ScopedThreadPin::ScopedThreadPin(const NumaTopology& topology, int thread) {
+#ifdef __linux__
+  CPU_ZERO(&saved_mask_);
+  saved_ = sched_getaffinity(0, sizeof(saved_mask_), &saved_mask_) == 0;
+  // Pinning without a mask to go back to would leave the thread pinned.
+  if (!saved_) return;
+#endif
+  node_ = PinThread(topology, thread);
+}
+
+ScopedThreadPin::~ScopedThreadPin() {
+#ifdef __linux__
+  if (saved_) sched_setaffinity(0, sizeof(saved_mask_), &saved_mask_);
+#endif
+}
+
+std::size_t ReplicaBytes(const SimulationConfig& config) {
+  const auto& graph = config.graph;
+  std::size_t bytes = config.node_rates.size() * sizeof(double);
+  for (int i = 0; i < graph.size(); ++i) {
+    bytes += (graph.out_edges()[i].size() + graph.in_edges()[i].size()) * sizeof(int);
+    if (graph.weighted()) {
+      bytes += (graph.out_weights()[i].size() + graph.in_weights()[i].size()) * sizeof(double);
+    }
+  }
+  return bytes;
+}
+
+ConfigReplicas::ConfigReplicas(const SimulationConfig& config, int num_nodes)
+    : config_(config), replicas_(num_nodes) {}
+
+const SimulationConfig& ConfigReplicas::Get(int node, std::size_t* bytes_copied) {
+  *bytes_copied = 0;
+  if (node < 0 || node >= static_cast<int>(replicas_.size())) return config_;
+#pragma omp critical(equilibrium_config_replicas)
+  if (!replicas_[node]) {
+    replicas_[node].reset(new SimulationConfig(config_));
+    // Copies of a graph share its edges; the replica needs its own.
+    replicas_[node]->graph = config_.graph.DeepCopy();
+    *bytes_copied = ReplicaBytes(config_);
+  }
+  return *replicas_[node];
+}
+
+} // namespace equilibrium
@@ -0,0 +1,259 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include <equilibrium/alias_table.h>
+#include <equilibrium/parallel_trajectory.h>
+#include <equilibrium/random.h>
+#include <omp.h>
+
+namespace equilibrium {
+
+namespace {
+
+struct Event {
+  double time;
+  int birther;
+  int dier;
+  /// Global type the dier takes on when the birth mutates, otherwise -1.
+  int mutant_type;
+  /// Next event on the birther and on the dier, or -1.
+  int next[2];
+};
+
+/// Exp(rate) waiting time; infinite when the location never fires.
+double WaitingTime(Xoshiro256& rng, double rate) {
+  if (!(rate > 0)) return std::numeric_limits<double>::infinity();
+  return -std::log(1. - UniformReal(rng)) / rate;
+}
+
+/// Exclusive prefix sum of counts[0, n) into counts[0, n], returning the total.
+int PrefixSum(std::vector<int>* counts, int n) {
+  int total = 0;
+  for (int i = 0; i < n; ++i) {
+    const int count = (*counts)[i];
+    (*counts)[i] = total;
+    total += count;
+  }
+  (*counts)[n] = total;
+  return total;
+}
+
+}  // namespace
+
+bool SupportsParallelTrajectory(const SimulationConfig& config) {
+  return !config.run_until_homogeneous &&
+      !(config.independent_mutation_rate > 0) &&
+      (config.node_rates.empty() || static_cast<int>(config.node_rates.size()) == config.graph.size()) &&
+      !config.capture_history &&
+      !config.track_genealogy &&
+      config.measures.empty() &&
+      config.checkpoints.empty();
+}
+
+void SimulateParallel(const SimulationConfig& config, int trial, double end_time, Stats* stats,
+                      std::vector<int>* location_to_type) {
+  assert(SupportsParallelTrajectory(config));
+  assert(config.graph.size() > 0);
+  assert(!config.compute_stats || stats != nullptr);
+  const int N = config.graph.size();
+  const bool birth_death = config.dynamic == Dynamic::BIRTH_DEATH;
+  // Assuming there are only two dynamics: bd and db.
+  const auto& neighbors = birth_death ? config.graph.out_edges() : config.graph.in_edges();
+  AliasTable neighbor_weights;
+  if (config.graph.weighted()) {
+    neighbor_weights = AliasTable(birth_death ? config.graph.out_weights() : config.graph.in_weights());
+  }
+  const auto rate = [&config](int i) { return config.node_rates.empty() ? 1. : config.node_rates[i]; };
+  double total_rate = 0;
+  for (int i = 0; i < N; ++i) total_rate += rate(i);
+
+  std::uint64_t seed = static_cast<std::uint64_t>(config.seed);
+  if (config.seed == kNoSeed) {
+    std::random_device rd;
+    seed = (static_cast<std::uint64_t>(rd()) << 32) | rd();
+  }
+  const std::uint64_t trial_seed = Xoshiro256(seed, static_cast<std::uint64_t>(trial))();
+
+  // Each location draws its firing times, neighbors and mutations from its
+  // own stream, so nothing drawn depends on the threads or the windows.
+  std::vector<Xoshiro256> rngs(N, Xoshiro256(0, 0));
+  std::vector<double> next_time(N);
+  std::vector<int> types(N);
+#pragma omp parallel for schedule(static)
+  for (int i = 0; i < N; ++i) {
+    rngs[i] = Xoshiro256(trial_seed, static_cast<std::uint64_t>(i));
+    next_time[i] = WaitingTime(rngs[i], rate(i));
+    types[i] = config.start_with_max_diversity ? i : 0;
+  }
+  int next_type = config.start_with_max_diversity ? N : 1;
+  long long num_steps = 0;
+
+  const int max_threads = omp_get_max_threads();
+  std::vector<std::vector<Event>> thread_events(max_threads);
+  std::vector<int> thread_offsets(max_threads + 1);
+  std::vector<int> thread_mutations(max_threads + 1);
+  std::vector<Event> events;
+  std::vector<int> dependencies;
+  std::vector<int> touch_offsets(N + 1);
+  std::vector<int> touch_cursors(N);
+  std::vector<int> touches;
+  std::vector<int> ready;
+  std::vector<int> next_ready;
+
+  const double window = total_rate > 0 ? kParallelWindowEvents * N / total_rate : end_time;
+  for (double window_begin = 0; window_begin < end_time && total_rate > 0; window_begin += window) {
+    const double window_end = std::min(window_begin + window, end_time);
+
+    // Generate the window's events. A static schedule hands each thread a
+    // contiguous block of locations in thread order, so concatenating the
+    // thread buffers lists events by location whatever the number of threads,
+    // and mutant types are numbered in that order.
+    int num_threads = 1;
+    long long window_steps = 0;
+#pragma omp parallel reduction(+:window_steps)
+    {
+      const int thread = omp_get_thread_num();
+      auto& local_events = thread_events[thread];
+      local_events.clear();
+      int local_mutations = 0;
+
+#pragma omp for schedule(static)
+      for (int i = 0; i < N; ++i) {
+        auto& rng = rngs[i];
+        const int degree = static_cast<int>(neighbors[i].size());
+        while (next_time[i] < window_end) {
+          ++window_steps;
+          // An isolated location, or one whose edges all have weight 0,
+          // still uses up a step, as in Simulate.
+          const int k = degree == 0 ? -1
+              : config.graph.weighted()
+              ? neighbor_weights.Sample(i, UniformReal(rng))
+              : static_cast<int>(UniformIndex(rng, static_cast<std::uint32_t>(degree)));
+          if (k >= 0) {
+            const int second = neighbors[i][k];
+            const bool mutates = UniformReal(rng) < config.birth_mutation_rate;
+            local_mutations += mutates;
+            local_events.push_back({next_time[i], birth_death ? i : second, birth_death ? second : i,
+                                    mutates ? 0 : -1, {-1, -1}});
+          }
+          next_time[i] += WaitingTime(rng, rate(i));
+        }
+      }
+
+      thread_offsets[thread] = static_cast<int>(local_events.size());
+      thread_mutations[thread] = local_mutations;
+#pragma omp barrier
+#pragma omp single
+      {
+        num_threads = omp_get_num_threads();
+        events.resize(PrefixSum(&thread_offsets, num_threads));
+        PrefixSum(&thread_mutations, num_threads);
+      }
+
+      int mutant_type = next_type + thread_mutations[thread];
+      int e = thread_offsets[thread];
+      for (auto& event : local_events) {
+        if (event.mutant_type >= 0) event.mutant_type = mutant_type++;
+        events[e++] = event;
+      }
+    }
+    num_steps += window_steps;
+    next_type += thread_mutations[num_threads];
+    const int num_events = static_cast<int>(events.size());
+
+    // List the events touching each location, in time order. Event k runs
+    // once every earlier event on its birther and dier has run.
+    dependencies.assign(num_events, 0);
+    std::fill(touch_offsets.begin(), touch_offsets.end(), 0);
+#pragma omp parallel for schedule(static)
+    for (int e = 0; e < num_events; ++e) {
+#pragma omp atomic
+      ++touch_offsets[events[e].birther];
+      if (events[e].dier != events[e].birther) {
+#pragma omp atomic
+        ++touch_offsets[events[e].dier];
+      }
+    }
+    touches.resize(PrefixSum(&touch_offsets, N));
+    std::copy(touch_offsets.begin(), touch_offsets.end() - 1, touch_cursors.begin());
+#pragma omp parallel for schedule(static)
+    for (int e = 0; e < num_events; ++e) {
+      // A self-loop touches its location once.
+      const int num_touched = events[e].dier == events[e].birther ? 1 : 2;
+      for (int k = 0; k < num_touched; ++k) {
+        const int location = k == 0 ? events[e].birther : events[e].dier;
+        int position;
+#pragma omp atomic capture
+        position = touch_cursors[location]++;
+        touches[position] = e;
+      }
+    }
+#pragma omp parallel for schedule(static)
+    for (int location = 0; location < N; ++location) {
+      const auto begin = touches.begin() + touch_offsets[location];
+      const auto end = touches.begin() + touch_offsets[location + 1];
+      std::sort(begin, end, [&events](int a, int b) {
+        return std::tie(events[a].time, a) < std::tie(events[b].time, b);
+      });
+      for (auto it = begin; it != end; ++it) {
+        auto& event = events[*it];
+        if (it + 1 != end) event.next[location == event.birther ? 0 : 1] = *(it + 1);
+        if (it != begin) {
+#pragma omp atomic
+          ++dependencies[*it];
+        }
+      }
+    }
+
+    // Run the events level by level. The ready events touch disjoint
+    // locations, so they commute and the outcome is that of running every
+    // event in time order.
+    ready.clear();
+    for (int e = 0; e < num_events; ++e) {
+      if (dependencies[e] == 0) ready.emplace_back(e);
+    }
+    while (!ready.empty()) {
+      next_ready.clear();
+      const int num_ready = static_cast<int>(ready.size());
+#pragma omp parallel
+      {
+        std::vector<int> local_ready;
+#pragma omp for schedule(static) nowait
+        for (int r = 0; r < num_ready; ++r) {
+          const auto& event = events[ready[r]];
+          types[event.dier] = event.mutant_type >= 0 ? event.mutant_type : types[event.birther];
+          for (const int next : event.next) {
+            if (next < 0) continue;
+            int remaining;
+#pragma omp atomic capture
+            remaining = --dependencies[next];
+            if (remaining == 0) local_ready.emplace_back(next);
+          }
+        }
+#pragma omp critical
+        next_ready.insert(next_ready.end(), local_ready.begin(), local_ready.end());
+      }
+      ready.swap(next_ready);
+    }
+  }
+
+  if (config.compute_stats) {
+    stats->number_of_types = NumberOfTypes(types);
+    stats->number_of_unmatching_pairs = NumberOfUnmatchingPairs(types);
+    stats->number_of_unmatching_links = NumberOfUnmatchingLinks(types, config.graph);
+    stats->number_of_steps = num_steps;
+    stats->time = end_time;
+    stats->time_to_mrca = -1;
+    stats->measures.clear();
+    stats->trajectory.clear();
+  }
+  if (location_to_type != nullptr) location_to_type->swap(types);
+}
+
+} // namespace equilibrium
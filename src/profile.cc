@@ -0,0 +1,65 @@
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include <equilibrium/profile.h>
+#include <omp.h>
+
+namespace equilibrium {
+
+namespace {
+
+// A deque never moves its elements, so each thread can keep a pointer.
+std::mutex registry_mutex;
+std::deque<Profile> registry;
+
+}  // namespace
+
+void MergeProfile(const Profile& from, Profile* into) {
+  into->trials += from.trials;
+  into->steps += from.steps;
+  into->effective_steps += from.effective_steps;
+  into->mutations += from.mutations;
+  into->rng_draws += from.rng_draws;
+  into->history_snapshots += from.history_snapshots;
+  into->burn_in_seconds += from.burn_in_seconds;
+  into->stats_seconds += from.stats_seconds;
+  into->serialisation_seconds += from.serialisation_seconds;
+  into->replica_bytes += from.replica_bytes;
+}
+
+Profile& ThreadProfile() {
+  thread_local Profile* profile = nullptr;
+  if (profile == nullptr) {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    registry.emplace_back();
+    profile = &registry.back();
+    profile->thread = omp_get_thread_num();
+  }
+  return *profile;
+}
+
+void CollectProfiles(std::vector<Profile>* profiles) {
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  profiles->assign(registry.begin(), registry.end());
+  std::stable_sort(profiles->begin(), profiles->end(), [](const Profile& a, const Profile& b) {
+    return a.thread < b.thread;
+  });
+}
+
+void ResetProfiles() {
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  for (auto& profile : registry) {
+    const int thread = profile.thread;
+    profile = Profile();
+    profile.thread = thread;
+  }
+}
+
+double SecondsSince(const std::chrono::steady_clock::time_point& start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+}  // namespace equilibrium
@@ -0,0 +1,160 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+
+#include <equilibrium/profile.h>
+#include <equilibrium/progress.h>
+#include <nlohmann/json.hpp>
+
+namespace equilibrium {
+
+namespace {
+
+/// Owned by one thread. Slots are 128 bytes with the counters first, so the
+/// counters of two slots are always at least 64 bytes apart, whatever the
+/// alignment of the storage.
+struct ProgressSlot {
+  std::atomic<long long> trials{0};
+  std::atomic<long long> steps{0};
+  char padding[128 - 2 * sizeof(std::atomic<long long>)];
+};
+
+// A deque never moves its elements, so each thread can keep a pointer.
+std::mutex registry_mutex;
+std::deque<ProgressSlot> registry;
+
+ProgressSlot* RegisterSlot() {
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  registry.emplace_back();
+  return &registry.back();
+}
+
+ProgressSlot* ThreadSlot() {
+  thread_local ProgressSlot* slot = nullptr;
+  if (slot == nullptr) slot = RegisterSlot();
+  return slot;
+}
+
+}  // namespace
+
+void RecordTrialProgress(long long steps) {
+  ProgressSlot* slot = ThreadSlot();
+  slot->trials.store(slot->trials.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  slot->steps.store(slot->steps.load(std::memory_order_relaxed) + steps, std::memory_order_relaxed);
+}
+
+void RecordStepProgress(long long steps) {
+  ProgressSlot* slot = ThreadSlot();
+  slot->steps.store(slot->steps.load(std::memory_order_relaxed) + steps, std::memory_order_relaxed);
+}
+
+void GetTrialProgress(long long* trials, long long* steps) {
+  *trials = 0;
+  *steps = 0;
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  for (const auto& slot : registry) {
+    *trials += slot.trials.load(std::memory_order_relaxed);
+    *steps += slot.steps.load(std::memory_order_relaxed);
+  }
+}
+
+void WriteProgressLine(const ProgressStatus& status, std::ostream* os) {
+  *os << "progress: " << status.trials;
+  if (status.total_trials > 0) {
+    *os << "/" << status.total_trials << " trials (" << std::fixed << std::setprecision(1)
+        << 100. * static_cast<double>(status.trials) / static_cast<double>(status.total_trials) << "%)";
+  } else {
+    *os << " trials";
+  }
+  *os << std::scientific << std::setprecision(3) << ", " << status.trials_per_second << " trials/s, "
+      << status.steps_per_second << " steps/s" << std::fixed << std::setprecision(1);
+  if (status.done) {
+    *os << ", done in " << status.elapsed_seconds << "s";
+  } else if (status.eta_seconds >= 0) {
+    *os << ", eta " << status.eta_seconds << "s";
+  }
+  *os << std::defaultfloat << std::setprecision(6) << std::endl;
+}
+
+void WriteProgressJson(const ProgressStatus& status, std::ostream* os) {
+  nlohmann::json json = {
+      {"trials", status.trials},
+      {"total_trials", status.total_trials},
+      {"steps", status.steps},
+      {"total_steps", status.total_steps},
+      {"elapsed_seconds", status.elapsed_seconds},
+      {"trials_per_second", status.trials_per_second},
+      {"steps_per_second", status.steps_per_second},
+      {"eta_seconds", status.eta_seconds},
+      {"done", status.done},
+  };
+  *os << json << std::endl;
+}
+
+ProgressReporter::ProgressReporter(long long total_trials, long long total_steps, double interval_seconds,
+                                   const std::string& status_file)
+    : total_trials_(total_trials),
+      total_steps_(total_steps),
+      interval_(interval_seconds),
+      status_file_(status_file),
+      start_(std::chrono::steady_clock::now()) {
+  GetTrialProgress(&start_trials_, &start_steps_);
+  thread_ = std::thread([this]() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_.wait_for(lock, interval_, [this]() { return stopping_; })) Report(false);
+  });
+}
+
+ProgressReporter::~ProgressReporter() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  stop_.notify_one();
+  thread_.join();
+  Report(true);
+}
+
+ProgressStatus ProgressReporter::GetStatus() const {
+  ProgressStatus status;
+  GetTrialProgress(&status.trials, &status.steps);
+  status.trials -= start_trials_;
+  status.steps -= start_steps_;
+  status.total_trials = total_trials_;
+  status.total_steps = total_steps_;
+  status.elapsed_seconds = SecondsSince(start_);
+  if (status.elapsed_seconds > 0) {
+    status.trials_per_second = static_cast<double>(status.trials) / status.elapsed_seconds;
+    status.steps_per_second = static_cast<double>(status.steps) / status.elapsed_seconds;
+  }
+  if (total_steps_ > 0 && status.steps_per_second > 0) {
+    status.eta_seconds = static_cast<double>(std::max(0LL, total_steps_ - status.steps)) / status.steps_per_second;
+  } else if (total_trials_ > 0 && status.trials_per_second > 0) {
+    status.eta_seconds = static_cast<double>(std::max(0LL, total_trials_ - status.trials)) / status.trials_per_second;
+  }
+  return status;
+}
+
+void ProgressReporter::Report(bool done) {
+  auto status = GetStatus();
+  status.done = done;
+  if (done) status.eta_seconds = 0;
+  WriteProgressLine(status, &std::cerr);
+  if (status_file_.empty()) return;
+
+  const std::string temporary_file = status_file_ + ".tmp";
+  {
+    std::ofstream ofs{temporary_file};
+    WriteProgressJson(status, &ofs);
+  }
+  std::rename(temporary_file.c_str(), status_file_.c_str());
+}
+
+}  // namespace equilibrium
@@ -0,0 +1,233 @@
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <equilibrium/result_cache.h>
+
+namespace equilibrium {
+
+namespace {
+
+void AppendDouble(double x, std::ostringstream* os) {
+  char buffer[32];
+  std::snprintf(buffer, sizeof(buffer), "%.17g", x);
+  (*os) << buffer;
+}
+
+uint64_t HashGraph(const Graph& graph) {
+  std::ostringstream os;
+  for (int i = 0; i < graph.size(); ++i) {
+    for (int k = 0; k < static_cast<int>(graph.out_edges()[i].size()); ++k) {
+      os << graph.out_edges()[i][k];
+      if (graph.weighted()) {
+        os << ':';
+        AppendDouble(graph.out_weights()[i][k], &os);
+      }
+      os << ',';
+    }
+    os << ';';
+  }
+  return Fnv1a(os.str());
+}
+
+/// Rows for trials [0, num_trials): cached ones first, the rest simulated in
+/// parallel and appended. False, with nothing cached, when ComputeTrends is.
+bool GetTrialRows(const SimulationConfig& config, int num_trials, const ResultCache& cache,
+                  const std::function<std::vector<long long>(const Stats&)>& to_row,
+                  std::vector<std::vector<long long>>* rows, int* cached_trials) {
+  const bool cacheable = config.seed != kNoSeed;
+  const std::string key = CanonicalConfig(config);
+  rows->clear();
+  if (cacheable) cache.Load(key, rows);
+  if (static_cast<int>(rows->size()) > num_trials) rows->resize(num_trials);
+  *cached_trials = static_cast<int>(rows->size());
+
+  const int first_missing = static_cast<int>(rows->size());
+  rows->resize(num_trials);
+  if (config.engine == SimulationEngine::ENSEMBLE || config.engine == SimulationEngine::LUMPED) {
+    // The ensemble and lumped engines only report the number of steps.
+    Trends trends;
+    if (!ComputeTrends({{config.graph.size(), config}}, first_missing, num_trials, &trends)) return false;
+    for (int trial = first_missing; trial < num_trials; ++trial) {
+      (*rows)[trial] = {trends.begin()->second[trial - first_missing]};
+    }
+  } else {
+#pragma omp parallel
+    {
+      SimulationWorkspace workspace(config);
+      Stats stats;
+
+#pragma omp for schedule(dynamic)
+      for (int trial = first_missing; trial < num_trials; ++trial) {
+        Simulate(config, trial, &workspace, &stats, nullptr);
+        (*rows)[trial] = to_row(stats);
+      }
+    }
+  }
+
+  if (cacheable && first_missing < num_trials &&
+      !cache.Append(key, first_missing,
+                    std::vector<std::vector<long long>>(rows->begin() + first_missing, rows->end()))) {
+    // The results are still good, only later runs recompute them.
+    std::cerr << "cannot append to the result cache " << cache.PathFor(key) << std::endl;
+  }
+  return true;
+}
+
+}  // namespace
+
+std::string CanonicalConfig(const SimulationConfig& config) {
+  std::ostringstream os;
+  std::string dynamic_str;
+  ToString(config.dynamic, &dynamic_str);
+  os << "engine_version=" << kEngineVersion
+     << ";seed=" << config.seed
+     << ";graph_name=" << config.graph.name()
+     << ";N=" << config.graph.size()
+     << ";graph_hash=" << HashGraph(config.graph)
+     << ";dynamic=" << dynamic_str
+     << ";birth_mutation_rate=";
+  AppendDouble(config.birth_mutation_rate, &os);
+  os << ";independent_mutation_rate=";
+  AppendDouble(config.independent_mutation_rate, &os);
+  os << ";num_steps=" << config.num_steps
+     << ";start_with_max_diversity=" << config.start_with_max_diversity
+     << ";run_until_homogeneous=" << config.run_until_homogeneous
+     << ";continuous_time=" << config.continuous_time
+     << ";node_rates=";
+  for (const auto& rate : config.node_rates) {
+    AppendDouble(rate, &os);
+    os << ',';
+  }
+  // Left out for the scalar engine, so keys from before engines existed still match.
+  if (config.engine != SimulationEngine::SCALAR) {
+    std::string engine_str;
+    ToString(config.engine, &engine_str);
+    os << ";engine=" << engine_str;
+  }
+  if (config.common_random_numbers) os << ";common_random_numbers=1";
+  return os.str();
+}
+
+uint64_t Fnv1a(const std::string& data) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (const auto& c : data) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+ResultCache::ResultCache(const std::string& directory) : directory_(directory) {
+  // Fine if it already exists; a failure shows up as an unreadable cache.
+  mkdir(directory_.c_str(), 0755);
+}
+
+std::string ResultCache::PathFor(const std::string& key) const {
+  char name[32];
+  std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(Fnv1a(key)));
+  return directory_ + "/" + name + ".txt";
+}
+
+void ResultCache::Load(const std::string& key, std::vector<std::vector<long long>>* rows) const {
+  rows->clear();
+  std::ifstream ifs{PathFor(key)};
+  std::string line;
+  // A different key under the same hash is treated as a miss.
+  if (!std::getline(ifs, line) || line != key) return;
+  while (std::getline(ifs, line)) {
+    std::istringstream row_stream(line);
+    int trial;
+    if (!(row_stream >> trial)) break;
+    // Skip repeats from overlapping runs; stop at a gap.
+    const int num_rows = static_cast<int>(rows->size());
+    if (trial < num_rows) continue;
+    if (trial > num_rows) break;
+    std::vector<long long> row;
+    long long value;
+    while (row_stream >> value) row.push_back(value);
+    rows->push_back(row);
+  }
+}
+
+bool ResultCache::Append(const std::string& key, int first_trial,
+                         const std::vector<std::vector<long long>>& rows) const {
+  const std::string path = PathFor(key);
+  std::string header;
+  {
+    std::ifstream ifs{path};
+    std::getline(ifs, header);
+  }
+  if (!header.empty() && header != key) return false;
+
+  std::ofstream ofs{path, std::ios::app};
+  if (header.empty()) ofs << key << '\n';
+  for (int i = 0; i < static_cast<int>(rows.size()); ++i) {
+    ofs << first_trial + i;
+    for (const auto& value : rows[i]) ofs << ' ' << value;
+    ofs << '\n';
+  }
+  return static_cast<bool>(ofs);
+}
+
+int CachedTrials(const SimulationConfig& config, int num_trials, const ResultCache& cache) {
+  if (config.seed == kNoSeed) return 0;
+  std::vector<std::vector<long long>> rows;
+  cache.Load(CanonicalConfig(config), &rows);
+  return std::min(static_cast<int>(rows.size()), num_trials);
+}
+
+void ComputeDiversityCounts(const SimulationConfig& config, const ResultCache& cache, DiversityCounts* diversity_counts,
+                            int* cached_trials) {
+  std::vector<std::vector<long long>> rows;
+  GetTrialRows(config, config.num_simulations, cache, [](const Stats& stats) {
+    std::vector<long long> row;
+    for (const auto& measure : DIVERSITY_MEASURES) row.push_back(GetMeasureResult(stats, measure));
+    return row;
+  }, &rows, cached_trials);
+
+  for (const auto& row : rows) {
+    for (int i = 0; i < static_cast<int>(DIVERSITY_MEASURES.size()); ++i) {
+      ++(*diversity_counts)[DIVERSITY_MEASURES[i]][static_cast<int>(row[i])];
+    }
+  }
+}
+
+bool ComputeTrends(const std::map<int, SimulationConfig>& configs, int num_trials, const ResultCache& cache,
+                   Trends* trends, int* cached_trials) {
+  return ComputeTrends(configs, num_trials, cache, trends, nullptr, cached_trials);
+}
+
+bool ComputeTrends(const std::map<int, SimulationConfig>& configs, int num_trials, const ResultCache& cache,
+                   Trends* trends, TrendSummaries* summaries, int* cached_trials) {
+  *cached_trials = 0;
+  for (const auto& n_config : configs) {
+    std::vector<std::vector<long long>> rows;
+    int cached = 0;
+    if (!GetTrialRows(n_config.second, num_trials, cache, [](const Stats& stats) {
+      return std::vector<long long>(1, stats.number_of_steps);
+    }, &rows, &cached)) {
+      return false;
+    }
+    *cached_trials += cached;
+
+    if (summaries != nullptr) {
+      auto& summary = (*summaries)[n_config.first];
+      for (const auto& row : rows) summary.Add(static_cast<double>(row[0]));
+    }
+    if (trends != nullptr) {
+      auto& times = (*trends)[n_config.first];
+      times.clear();
+      for (const auto& row : rows) times.push_back(row[0]);
+    }
+  }
+  return true;
+}
+
+} // namespace equilibrium
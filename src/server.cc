@@ -0,0 +1,199 @@
+#include <chrono>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include <equilibrium/fixation.h>
+#include <equilibrium/measures.h>
+#include <equilibrium/server.h>
+#include <equilibrium/simulation.h>
+#include <equilibrium/writer.h>
+
+#include <nlohmann/json.hpp>
+#include <omp.h>
+
+namespace equilibrium {
+
+namespace {
+
+void GetJobGraph(const nlohmann::json& job, GraphCache* graphs, Graph* graph) {
+  const std::string graph_name = job.value("graph_name", "complete");
+  if (!graphs->Get(graph_name, job.value("N", 1), graph)) {
+    throw std::invalid_argument("No graph named '" + graph_name + "'");
+  }
+}
+
+void GetJobDynamic(const nlohmann::json& job, Dynamic* dynamic) {
+  const std::string dynamic_name = job.value("dynamic", "birth-death");
+  if (!FromString(dynamic_name, dynamic)) {
+    throw std::invalid_argument("No dynamic named '" + dynamic_name + "'");
+  }
+}
+
+/// Mirrors apps/diversity_counts.cc.
+nlohmann::json RunDiversityCountsJob(const nlohmann::json& job, const MetaData& started, GraphCache* graphs) {
+  SimulationConfig config;
+  config.birth_mutation_rate = job.value("birth_mutation_rate", 0.);
+  config.independent_mutation_rate = job.value("independent_mutation_rate", 0.);
+  config.num_steps = job.value("num_steps", 0);
+  config.num_simulations = job.value("num_simulations", 1);
+  config.compute_stats = true;
+  config.capture_history = false;
+  config.history_sample_rate = -1;
+  config.start_with_max_diversity = job.value("start_with_max_diversity", false);
+  config.run_until_homogeneous = false;
+  config.seed = job.value("seed", kNoSeed);
+  config.continuous_time = job.value("continuous_time", false);
+  GetJobGraph(job, graphs, &config.graph);
+  GetJobDynamic(job, &config.dynamic);
+
+  if (job.count("node_rates")) {
+    config.node_rates = job["node_rates"].get<std::vector<double>>();
+    if (!ValidNodeRates(config.node_rates, config.graph.size())) {
+      throw std::invalid_argument("Need one non-negative node rate per location, not all zero");
+    }
+  }
+
+  const std::string measures = job.value("measures", "");
+  if (!MakeMeasureTrackers(measures, config.graph, &config.measures)) {
+    throw std::invalid_argument("Bad measures '" + measures + "'");
+  }
+
+  DiversityCounts diversity_counts;
+  MeasureSummaries measure_summaries;
+  ComputeDiversityCounts(config, 0, config.num_simulations, &diversity_counts, &measure_summaries);
+
+  MetaData metadata = started;
+  metadata.end_time = std::chrono::system_clock::now();
+  std::stringstream ss;
+  WriteDiversityCountsToStream(diversity_counts, measure_summaries, config, metadata, &ss);
+  return nlohmann::json::parse(ss);
+}
+
+/// Mirrors apps/fixation.cc.
+nlohmann::json RunFixationJob(const nlohmann::json& job, const MetaData& started, GraphCache* graphs) {
+  FixationConfig config;
+  config.mutant_fitness = job.value("mutant_fitness", 1.);
+  config.start_node = job.value("start_node", kRandomStartNode);
+  config.num_simulations = job.value("num_simulations", 1);
+  config.seed = job.value("seed", kNoSeed);
+  config.max_steps = job.value("max_steps", 0LL);
+  config.batch_size = job.value("batch_size", 1024);
+  GetJobGraph(job, graphs, &config.graph);
+  GetJobDynamic(job, &config.dynamic);
+
+  const std::string engine = job.value("engine", "scalar");
+  if (!FromString(engine, &config.engine)) {
+    throw std::invalid_argument("No engine named '" + engine + "'");
+  }
+  if (config.start_node >= config.graph.size() || config.start_node < kEveryStartNode) {
+    throw std::invalid_argument("No node " + std::to_string(config.start_node));
+  }
+  if (!IsValidFitness(config.mutant_fitness)) {
+    throw std::invalid_argument("Mutant fitness must be finite and positive");
+  }
+
+  FixationResults results;
+  ComputeFixation(config, &results);
+
+  MetaData metadata = started;
+  metadata.end_time = std::chrono::system_clock::now();
+  std::stringstream ss;
+  WriteFixationToStream(results, config, metadata, &ss);
+  return nlohmann::json::parse(ss);
+}
+
+}  // namespace
+
+bool GraphCache::Get(const std::string& graph_name, int N, Graph* graph) {
+  const auto key = std::make_pair(graph_name, N);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = graphs_.find(key);
+    if (it != graphs_.end()) {
+      *graph = it->second;
+      return true;
+    }
+  }
+  // Built outside the lock; two jobs racing on a new graph both build it.
+  if (!GetGraph(graph_name, N, graph)) return false;
+  std::lock_guard<std::mutex> lock(mutex_);
+  graphs_.emplace(key, *graph);
+  return true;
+}
+
+int GraphCache::size() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return static_cast<int>(graphs_.size());
+}
+
+std::string RunJob(const std::string& job_line, GraphCache* graphs) {
+  nlohmann::json reply;
+  try {
+    const auto job = nlohmann::json::parse(job_line);
+    if (job.count("id")) reply["id"] = job["id"];
+
+    MetaData metadata;
+    metadata.tag = job.value("tag", "");
+    metadata.start_time = std::chrono::system_clock::now();
+
+    const std::string kind = job.value("kind", "");
+    if (kind == "diversity_counts") {
+      reply["result"] = RunDiversityCountsJob(job, metadata, graphs);
+    } else if (kind == "fixation") {
+      reply["result"] = RunFixationJob(job, metadata, graphs);
+    } else {
+      throw std::invalid_argument("No job kind '" + kind + "'");
+    }
+  } catch (const std::exception& e) {
+    reply["error"] = e.what();
+  }
+  return reply.dump();
+}
+
+JobQueue::JobQueue(int num_workers, int threads_per_worker) {
+  for (int i = 0; i < num_workers; ++i) {
+    workers_.emplace_back(&JobQueue::Work, this, threads_per_worker);
+  }
+}
+
+JobQueue::~JobQueue() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  ready_.notify_all();
+  for (auto& worker : workers_) worker.join();
+}
+
+void JobQueue::Push(std::function<void()> job) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    jobs_.push_back(std::move(job));
+  }
+  ready_.notify_one();
+}
+
+int JobQueue::pending() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return static_cast<int>(jobs_.size());
+}
+
+void JobQueue::Work(int threads_per_worker) {
+  // Applies to parallel regions started from this thread only, and keeps its
+  // OpenMP team alive between jobs.
+  omp_set_num_threads(threads_per_worker);
+  while (true) {
+    std::function<void()> job;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      ready_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+      if (jobs_.empty()) return;
+      job = std::move(jobs_.front());
+      jobs_.pop_front();
+    }
+    job();
+  }
+}
+
+} // namespace equilibrium
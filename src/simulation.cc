@@ -1,9 +1,21 @@
+#include <algorithm>
 #include <cassert>
+#include <limits>
 #include <map>
+#include <memory>
 #include <random>
 #include <set>
 
+#include <equilibrium/ensemble.h>
+#include <equilibrium/genealogy.h>
+#include <equilibrium/lumped.h>
+#include <equilibrium/numa.h>
+#include <equilibrium/profile.h>
+#include <equilibrium/progress.h>
+#include <equilibrium/random.h>
 #include <equilibrium/simulation.h>
+#include <equilibrium/type_allocator.h>
+#include <omp.h>
 
 namespace equilibrium {
 
@@ -12,26 +24,49 @@ StepConfig::StepConfig(
     const Graph& graph,
     std::uniform_int_distribution<>& first_step_dist,
     std::vector<std::uniform_int_distribution<>>& second_step_idx_dists,
-    std::mt19937& rng
+    std::mt19937& rng,
+    const FenwickTree* first_step_weights,
+    const AliasTable* second_step_weights
 ) : dynamic(dynamic),
     graph(graph),
     first_step_dist(first_step_dist),
-    second_step_idx_dists(second_step_idx_dists), rng(rng) {}
+    second_step_idx_dists(second_step_idx_dists), rng(rng),
+    first_step_weights(first_step_weights),
+    second_step_weights(second_step_weights) {}
+
+int FirstStepLocation(const StepConfig& step_config) {
+  if (step_config.first_step_weights == nullptr) {
+    return step_config.first_step_dist(step_config.rng);
+  }
+  std::uniform_real_distribution<> u_dist(0., step_config.first_step_weights->total());
+  return step_config.first_step_weights->Find(u_dist(step_config.rng));
+}
+
+int SecondStepIdx(const StepConfig& step_config, int location) {
+  if (step_config.second_step_weights == nullptr) {
+    return step_config.second_step_idx_dists[location](step_config.rng);
+  }
+  // Isolated locations are rejected by the caller, as are the -1 of
+  // locations whose edges all have weight 0.
+  if (step_config.second_step_weights->row_size(location) == 0) return 0;
+  std::uniform_real_distribution<> u_dist(0., 1.);
+  return step_config.second_step_weights->Sample(location, u_dist(step_config.rng));
+}
 
 bool BirthDeathStep(const StepConfig& step_config, Step* step) {
   // bd step.
-  step->birther = step_config.first_step_dist(step_config.rng);
-  const auto dier_idx = step_config.second_step_idx_dists[step->birther](step_config.rng);
-  if (step_config.graph.out_edges()[step->birther].empty()) return false;
+  step->birther = FirstStepLocation(step_config);
+  const auto dier_idx = SecondStepIdx(step_config, step->birther);
+  if (step_config.graph.out_edges()[step->birther].empty() || dier_idx < 0) return false;
   step->dier = step_config.graph.out_edges()[step->birther][dier_idx];
   return true;
 }
 
 bool DeathBirthStep(const StepConfig& step_config, Step* step) {
   // db step.
-  step->dier = step_config.first_step_dist(step_config.rng);
-  const auto birther_idx = step_config.second_step_idx_dists[step->dier](step_config.rng);
-  if (step_config.graph.in_edges()[step->dier].empty()) return false;
+  step->dier = FirstStepLocation(step_config);
+  const auto birther_idx = SecondStepIdx(step_config, step->dier);
+  if (step_config.graph.in_edges()[step->dier].empty() || birther_idx < 0) return false;
   step->birther = step_config.graph.in_edges()[step->dier][birther_idx];
   return true;
 }
@@ -46,7 +81,101 @@ bool MakeStep(const StepConfig& step_config, Step* step) {
   return false;
 }
 
+std::mt19937 MakeTrialRng(int seed, int trial) {
+  std::mt19937 rng;
+  SeedTrialRng(seed, trial, &rng);
+  return rng;
+}
+
+std::mt19937 MakeTrialRng(int seed, int trial, int stream) {
+  std::mt19937 rng;
+  SeedTrialRng(seed, trial, stream, &rng);
+  return rng;
+}
+
+void SeedTrialRng(int seed, int trial, std::mt19937* rng) {
+  if (seed == kNoSeed) {
+    std::random_device rd;
+    rng->seed(rd());
+    return;
+  }
+  SeedSequence seq(seed, trial);
+  rng->seed(seq);
+}
+
+void SeedTrialRng(int seed, int trial, int stream, std::mt19937* rng) {
+  if (seed == kNoSeed) {
+    std::random_device rd;
+    rng->seed(rd());
+    return;
+  }
+  SeedSequence seq(seed, trial, stream);
+  rng->seed(seq);
+}
+
+bool ValidNodeRates(const std::vector<double>& rates, int size) {
+  if (static_cast<int>(rates.size()) != size) return false;
+  double total = 0;
+  for (const auto& rate : rates) {
+    if (rate < 0) return false;
+    total += rate;
+  }
+  return total > 0;
+}
+
+bool ReadNodeRates(std::istream* is, int size, std::vector<double>* rates) {
+  rates->clear();
+  double rate;
+  while ((*is) >> rate) rates->push_back(rate);
+  return is->eof() && ValidNodeRates(*rates, size);
+}
+
+bool HasUniformRates(const std::vector<double>& rates) {
+  for (const auto& rate : rates) {
+    if (rate < rates[0] || rate > rates[0]) return false;
+  }
+  return true;
+}
+
 void Simulate(const SimulationConfig& config, Stats* stats, SimulationHistory* history) {
+  Simulate(config, 0, stats, history);
+}
+
+SimulationWorkspace::SimulationWorkspace(const SimulationConfig& config)
+    : first_step_dist(0, config.graph.size()-1),
+      uniform_rates(HasUniformRates(config.node_rates)),
+      total_rate(config.node_rates.empty() ? config.graph.size() : config.node_rates[0] * config.graph.size()),
+      location_to_type(config.graph.size(), 0) {
+  // Heterogeneous rates pick the first location through a Fenwick tree.
+  assert(config.node_rates.empty() || static_cast<int>(config.node_rates.size()) == config.graph.size());
+  if (!uniform_rates) first_step_weights.Reset(config.node_rates);
+
+  if (config.graph.weighted()) {
+    // Weighted graphs pick the neighbor through per-location alias tables.
+    second_step_weights = AliasTable(
+        config.dynamic == Dynamic::BIRTH_DEATH ? config.graph.out_weights() : config.graph.in_weights());
+  } else {
+    // Assuming there are only two dynamics: bd and db.
+    const auto& neighbors =
+        config.dynamic == Dynamic::BIRTH_DEATH ? config.graph.out_edges() : config.graph.in_edges();
+    second_step_idx_dists.resize(config.graph.size());
+    for (int i = 0; i < config.graph.size(); ++i) {
+      if (neighbors[i].size() > 0) {
+        second_step_idx_dists[i] = std::uniform_int_distribution<>(0, static_cast<int>(neighbors[i].size()) - 1);
+      }
+    }
+  }
+
+  for (const auto& prototype : config.measures) trackers.push_back(prototype->Clone());
+}
+
+void Simulate(const SimulationConfig& config, int trial, Stats* stats, SimulationHistory* history) {
+  SimulationWorkspace workspace(config);
+  Simulate(config, trial, &workspace, stats, history);
+}
+
+void Simulate(const SimulationConfig& config, int trial, SimulationWorkspace* workspace, Stats* stats,
+              SimulationHistory* history) {
   assert(config.graph.size() > 0);
   assert(config.graph.out_edges().size() == config.graph.size());
   // assert(!config.capture_history || config.num_simulations == 1);
@@ -54,104 +183,217 @@ void Simulate(const SimulationConfig& config, Stats* stats, SimulationHistory* h
   assert(config.capture_history || history == nullptr);
   assert(!config.compute_stats || stats != nullptr);
   assert(config.compute_stats || stats == nullptr);
+  assert(static_cast<int>(workspace->location_to_type.size()) == config.graph.size());
+  assert(workspace->trackers.size() == config.measures.size());
 
   // Initialize distributions.
-  std::random_device rd;
-  std::mt19937 rng(rd());
-  std::uniform_int_distribution<> first_step_dist(0, config.graph.size()-1);
-  std::vector<std::uniform_int_distribution<>> second_step_idx_dists(config.graph.size());
-
-  // Assuming there are only two dynamics: bd and db.
-  const auto& neighbors = config.dynamic == Dynamic::BIRTH_DEATH ? config.graph.out_edges() : config.graph.in_edges();
-  for (int i = 0; i < config.graph.size(); ++i) {
-    if (neighbors[i].size() > 0) {
-      second_step_idx_dists[i] = std::uniform_int_distribution<>(0, neighbors[i].size()-1);
-    }
-  }
+  std::mt19937& rng = workspace->rng;
+  SeedTrialRng(config.seed, trial, &rng);
   std::uniform_real_distribution<> birth_mutation_dist(0.0, 1.0);
   std::uniform_real_distribution<> independent_mutation_dist(0.0, 1.0);
   std::uniform_int_distribution<> independent_mutation_location_dist(0, config.graph.size()-1);
+  const bool uniform_rates = workspace->uniform_rates;
+  const bool common_random_numbers = config.common_random_numbers;
+  std::mt19937& mutation_rng = common_random_numbers ? workspace->mutation_rng : rng;
+  std::mt19937& independent_mutation_rng = common_random_numbers ? workspace->independent_mutation_rng : rng;
+  if (common_random_numbers) {
+    // Stream 1 is the clock.
+    SeedTrialRng(config.seed, trial, 2, &mutation_rng);
+    SeedTrialRng(config.seed, trial, 3, &independent_mutation_rng);
+  }
 
   // Configure the step options.
-  StepConfig step_config(config.dynamic, config.graph, first_step_dist, second_step_idx_dists, rng);
+  StepConfig step_config(config.dynamic, config.graph, workspace->first_step_dist, workspace->second_step_idx_dists,
+                         rng, uniform_rates ? nullptr : &workspace->first_step_weights,
+                         config.graph.weighted() ? &workspace->second_step_weights : nullptr);
   Step step;
 
-  int max_type = 0;
-  std::vector<int> location_to_type(config.graph.size(), 0);
-  if (config.start_with_max_diversity) {
-    for (int i = 0; i < location_to_type.size(); ++i) {
-      location_to_type[i] = i;
-    }
-    max_type = config.graph.size() - 1;
+  // The clock has its own stream so it never perturbs the trajectory.
+  double time = 0;
+  std::mt19937& time_rng = workspace->time_rng;
+  std::exponential_distribution<> waiting_time_dist(
+      uniform_rates ? workspace->total_rate : workspace->first_step_weights.total());
+  if (config.continuous_time) SeedTrialRng(config.seed, trial, 1, &time_rng);
+  Profile profile;
+
+  // Locations hold recycled ids; the allocator maps them to global types.
+  std::vector<int>& location_to_type = workspace->location_to_type;
+  for (int i = 0; i < static_cast<int>(location_to_type.size()); ++i) {
+    location_to_type[i] = config.start_with_max_diversity ? i : 0;
   }
+  TypeAllocator& types = workspace->types;
+  types.Reset(config.graph.size(), config.start_with_max_diversity ? config.graph.size() : 1);
+
   if (config.capture_history && history != nullptr) {
-    history->location_to_types.reserve(config.num_steps / config.history_sample_rate + 1);
+    const int num_snapshots = config.num_steps / config.history_sample_rate + 1;
+    history->location_to_types.reserve(num_snapshots);
+    if (config.continuous_time) history->times.reserve(num_snapshots);
     history->location_to_types.emplace_back(location_to_type);
+    if (config.continuous_time) history->times.push_back(time);
+    if (kProfile) ++profile.history_snapshots;
 
-    history->ancestry.reserve(config.num_steps + 1);
-    // Type 0 has no ancestry.
-    history->ancestry.emplace_back(kNoAncestry);
+    if (!config.track_genealogy) {
+      history->ancestry.reserve(config.num_steps + 1);
+      // Initial types have no ancestry.
+      history->ancestry.assign(types.num_global_types(), kNoAncestry);
+    }
   }
 
+  Genealogy& genealogy = workspace->genealogy;
+  if (config.track_genealogy) genealogy.Reset(location_to_type);
+
+  const auto& trackers = workspace->trackers;
+  for (const auto& tracker : trackers) tracker->Reset(&location_to_type);
+
+  // Only the measures are kept at checkpoints, never the population.
+  const int num_checkpoints = static_cast<int>(config.checkpoints.size());
+  int next_checkpoint = 0;
+  std::vector<std::vector<double>> trajectory;
+  const auto record_checkpoints = [&](int step_num) {
+    while (next_checkpoint < num_checkpoints && config.checkpoints[next_checkpoint] <= step_num) {
+      trajectory.emplace_back(1, types.num_types());
+      for (const auto& tracker : trackers) {
+        trajectory.back().insert(trajectory.back().end(), tracker->values().begin(), tracker->values().end());
+      }
+      ++next_checkpoint;
+    }
+  };
+  record_checkpoints(0);
+
+  const auto burn_in_start = ProfileNow();
+
   // Evolve!
   int step_num;
   for (step_num = 1;
-       config.run_until_homogeneous ? !IsHomogeneous(location_to_type) : (step_num <= config.num_steps);
+       config.run_until_homogeneous ? types.num_types() != 1 : (step_num <= config.num_steps);
        ++step_num) {
+    if (kProfile) profile.rng_draws += 2;
+    if (config.continuous_time) time += waiting_time_dist(time_rng);
+    // Whether this step changed the type of some location, for the profile.
+    bool effective = false;
     if (MakeStep(step_config, &step)) {
-      location_to_type[step.dier] = location_to_type[step.birther];
+      if (kProfile) ++profile.rng_draws;
+      const auto birther_id = location_to_type[step.birther];
+      const auto replaced_id = location_to_type[step.dier];
+      const auto replaced_type = types.global_type(replaced_id);
+      const bool copy_changed = replaced_id != birther_id;
+      if (kProfile && copy_changed) effective = true;
+      location_to_type[step.dier] = birther_id;
+      types.Replace(replaced_id, birther_id);
+      for (auto& tracker : trackers) tracker->Replace(step.dier, replaced_id, birther_id, step_num);
+      if (config.track_genealogy) genealogy.Replace(replaced_type, types.global_type(birther_id));
 
       // Possibly mutate birth.
-      if (birth_mutation_dist(rng) < config.birth_mutation_rate) {
-        location_to_type[step.dier] = ++max_type;
-
-        if (config.capture_history && history != nullptr) {
-          history->ancestry.emplace_back(location_to_type[step.birther]);
-          assert(history->ancestry.size() == max_type+1);
+      if (birth_mutation_dist(mutation_rng) < config.birth_mutation_rate) {
+        if (kProfile) {
+          ++profile.mutations;
+          // A mutation changes the dier's type even when the copy did not.
+          effective = true;
+        }
+        const auto mutant_id = types.Allocate();
+        location_to_type[step.dier] = mutant_id;
+        types.Replace(birther_id, mutant_id);
+        for (auto& tracker : trackers) tracker->Replace(step.dier, birther_id, mutant_id, step_num);
+
+        if (config.track_genealogy) {
+          genealogy.AddType(types.global_type(mutant_id), types.global_type(birther_id), step_num);
+          genealogy.Replace(types.global_type(birther_id), types.global_type(mutant_id));
+        } else if (config.capture_history && history != nullptr) {
+          history->ancestry.emplace_back(types.global_type(birther_id));
+          assert(static_cast<int>(history->ancestry.size()) == types.num_global_types());
         }
       }
     }
 
     // Possibly independent mutation.
-    if (independent_mutation_dist(rng) < config.independent_mutation_rate) {
-      const auto mutated_location = independent_mutation_location_dist(rng);
-      location_to_type[mutated_location] = ++max_type;
-
-      if (config.capture_history && history != nullptr) {
+    if (kProfile) ++profile.rng_draws;
+    const bool mutates = independent_mutation_dist(independent_mutation_rng) < config.independent_mutation_rate;
+    // Common random numbers draw the location either way, to stay aligned
+    // across mutation rates.
+    const int mutated_location =
+        mutates || common_random_numbers ? independent_mutation_location_dist(independent_mutation_rng) : -1;
+    if (kProfile && (mutates || common_random_numbers)) ++profile.rng_draws;
+    if (mutates) {
+      if (kProfile) {
+        ++profile.mutations;
+        effective = true;
+      }
+      const auto replaced_id = location_to_type[mutated_location];
+      const auto replaced_type = types.global_type(replaced_id);
+      const auto mutant_id = types.Allocate();
+      location_to_type[mutated_location] = mutant_id;
+      types.Replace(replaced_id, mutant_id);
+      for (auto& tracker : trackers) tracker->Replace(mutated_location, replaced_id, mutant_id, step_num);
+
+      if (config.track_genealogy) {
+        genealogy.AddType(types.global_type(mutant_id), kNoAncestry, step_num);
+        genealogy.Replace(replaced_type, types.global_type(mutant_id));
+      } else if (config.capture_history && history != nullptr) {
         history->ancestry.emplace_back(kNoAncestry);
-        assert(history->ancestry.size() == max_type+1);
+        assert(static_cast<int>(history->ancestry.size()) == types.num_global_types());
       }
     }
+    if (kProfile && effective) ++profile.effective_steps;
+
+    if (next_checkpoint < num_checkpoints) record_checkpoints(step_num);
 
     // This is slow because of a copy, be careful!
     if (config.capture_history && history != nullptr && step_num % config.history_sample_rate == 0) {
-      history->location_to_types.emplace_back(location_to_type);
+      history->location_to_types.emplace_back();
+      types.ToGlobal(location_to_type, &history->location_to_types.back());
+      if (config.continuous_time) history->times.push_back(time);
+      if (kProfile) ++profile.history_snapshots;
     }
+
+    if (step_num % kProgressStepsPerFlush == 0) RecordStepProgress(kProgressStepsPerFlush);
+  }
+
+  if (kProfile) {
+    profile.burn_in_seconds = SecondsSince(burn_in_start);
+    profile.steps = step_num-1;
+    profile.trials = 1;
   }
 
   // Record stats.
   if (config.compute_stats) {
-    stats->number_of_types = NumberOfTypes(location_to_type);
-    stats->number_of_unmatching_pairs =
-        NumberOfUnmatchingPairs(location_to_type);
+    const auto stats_start = ProfileNow();
+    stats->number_of_types = types.num_types();
+    stats->number_of_unmatching_pairs = NumberOfUnmatchingPairs(types);
     stats->number_of_unmatching_links =
         NumberOfUnmatchingLinks(location_to_type, config.graph);
     stats->number_of_steps = step_num-1;
+    stats->time = time;
+    stats->time_to_mrca = config.track_genealogy ? genealogy.TimeToMostRecentCommonAncestor(step_num-1) : -1;
+    stats->measures.resize(trackers.size());
+    for (int i = 0; i < static_cast<int>(trackers.size()); ++i) trackers[i]->GetResult(step_num-1, &stats->measures[i]);
+    stats->trajectory.swap(trajectory);
+    if (kProfile) profile.stats_seconds = SecondsSince(stats_start);
   }
+
+  if (config.track_genealogy && config.capture_history && history != nullptr) {
+    genealogy.GetNodes(&history->genealogy);
+    history->time_to_mrca = genealogy.TimeToMostRecentCommonAncestor(step_num-1);
+  }
+
+  if (kProfile) MergeProfile(profile, &ThreadProfile());
+  RecordTrialProgress((step_num - 1) % kProgressStepsPerFlush);
 }
 
 void ComputeSimulationHistories(
     const SimulationConfig& config,
     SimulationHistories* simulation_histories
 ) {
-#pragma omp parallel for
-  for (int trial = 0; trial < config.num_simulations; ++trial) {
-    equilibrium::SimulationHistory history;
-    equilibrium::Simulate(config, nullptr, &history);
+  // Each trial fills its own slot in place: no copy, no lock, trial order.
+  const int offset = static_cast<int>(simulation_histories->size());
+  simulation_histories->resize(offset + config.num_simulations);
 
-#pragma omp critical
-    {
-      simulation_histories->emplace_back(history);
+#pragma omp parallel
+  {
+    SimulationWorkspace workspace(config);
+
+#pragma omp for schedule(dynamic)
+    for (int trial = 0; trial < config.num_simulations; ++trial) {
+      equilibrium::Simulate(config, trial, &workspace, nullptr, &(*simulation_histories)[offset + trial]);
     }
   }
 }
@@ -167,25 +409,114 @@ void ComputeDiversityCounts(
     const equilibrium::SimulationConfig& config,
     DiversityCounts* diversity_counts
 ) {
-#pragma omp parallel for
-  for (int trial = 0; trial < config.num_simulations; ++trial) {
+  ComputeDiversityCounts(config, 0, config.num_simulations, diversity_counts);
+}
+
+void ComputeDiversityCounts(
+    const equilibrium::SimulationConfig& config,
+    int first_trial,
+    int last_trial,
+    DiversityCounts* diversity_counts,
+    MeasureSummaries* measure_summaries
+) {
+  NumaTopology topology;
+  if (config.numa_replicas) GetNumaTopology(&topology);
+  ConfigReplicas replicas(config, topology.num_nodes());
+
+#pragma omp parallel
+  {
+    // Pin first, so that the replica and workspace are first touched on the
+    // thread's own node.
+    // Unpinned again when the region ends.
+    std::unique_ptr<ScopedThreadPin> pin;
+    const SimulationConfig* local_config = &config;
+    if (config.numa_replicas) {
+      pin.reset(new ScopedThreadPin(topology, omp_get_thread_num()));
+      const int node = pin->node();
+      std::size_t bytes_copied;
+      local_config = &replicas.Get(node, &bytes_copied);
+      if (kProfile) {
+        ThreadProfile().numa_node = node;
+        ThreadProfile().replica_bytes += bytes_copied;
+      }
+    }
+    SimulationWorkspace workspace(*local_config);
     Stats stats;
-    equilibrium::Simulate(config, &stats, nullptr);
+
+#pragma omp for
+    for (int trial = first_trial; trial < last_trial; ++trial) {
+      equilibrium::Simulate(*local_config, trial, &workspace, &stats, nullptr);
 
 #pragma omp critical
-    {
-      for (const auto& measure : DIVERSITY_MEASURES) {
-        ++(*diversity_counts)[measure][GetMeasureResult(stats, measure)];
+      {
+        for (const auto& measure : DIVERSITY_MEASURES) {
+          ++(*diversity_counts)[measure][GetMeasureResult(stats, measure)];
+        }
+        if (measure_summaries != nullptr) {
+          for (const auto& result : stats.measures) AddMeasureResult(result, measure_summaries);
+        }
       }
     }
   }
 }
 
-void ComputeTrends(
-    const equilibrium::SimulationConfig& config,
-    std::map<int, int>* absorption_times
+bool ComputeTrends(
+    const std::map<int, SimulationConfig>& configs,
+    int first_trial,
+    int last_trial,
+    Trends* trends
 ) {
+  return ComputeTrends(configs, first_trial, last_trial, trends, nullptr);
+}
 
+bool ComputeTrends(
+    const std::map<int, SimulationConfig>& configs,
+    int first_trial,
+    int last_trial,
+    Trends* trends,
+    TrendSummaries* summaries
+) {
+  if (!configs.empty() && configs.begin()->second.engine == SimulationEngine::ENSEMBLE) {
+    ComputeEnsembleTrends(configs, first_trial, last_trial, trends, summaries);
+    return true;
+  }
+  if (!configs.empty() && configs.begin()->second.engine == SimulationEngine::LUMPED) {
+    return ComputeLumpedTrends(configs, first_trial, last_trial, trends, summaries);
+  }
+
+  std::vector<int> ns;
+  for (const auto& n_config : configs) {
+    ns.emplace_back(n_config.first);
+    // Pre-size so that each trial writes its own slot without locking.
+    if (trends != nullptr) (*trends)[n_config.first].assign(last_trial - first_trial, 0);
+  }
+  const int num_ns = static_cast<int>(ns.size());
+
+#pragma omp parallel
+  {
+    TrendSummaries local_summaries;
+    // Built on first use: a thread may only ever see some of the n.
+    std::vector<std::unique_ptr<SimulationWorkspace>> workspaces(ns.size());
+    Stats stats;
+
+#pragma omp for collapse(2) schedule(dynamic)
+    for (int trial = first_trial; trial < last_trial; ++trial) {
+      for (int i = 0; i < num_ns; ++i) {
+        const int n = ns[i];
+        const auto& config = configs.at(n);
+        if (!workspaces[i]) workspaces[i].reset(new SimulationWorkspace(config));
+        Simulate(config, trial, workspaces[i].get(), &stats, nullptr);
+        if (trends != nullptr) trends->at(n)[trial - first_trial] = stats.number_of_steps;
+        if (summaries != nullptr) local_summaries[n].Add(static_cast<double>(stats.number_of_steps));
+      }
+    }
+
+    if (summaries != nullptr) {
+#pragma omp critical
+      for (const auto& summary : local_summaries) (*summaries)[summary.first].Merge(summary.second);
+    }
+  }
+  return true;
 }
 
 bool IsHomogeneous(const std::vector<int>& location_to_type) {
@@ -198,17 +529,36 @@ int NumberOfTypes(const std::vector<int>& location_to_type) {
 }
 
 int NumberOfUnmatchingPairs(const std::vector<int>& location_to_type) {
-  // Note: this considers unordered pairs exactly once.
-  int num = 0;
-  for (int i = 0; i < location_to_type.size(); ++i) {
-    for (int j = i+1; j < location_to_type.size(); ++j) {
-      if (location_to_type[i] != location_to_type[j]) {
-        ++num;
-      }
+  // Note: this considers unordered pairs exactly once. All pairs minus the
+  // matching ones, counted per type from sorted runs: O(N log N).
+  std::vector<int> sorted(location_to_type);
+  std::sort(sorted.begin(), sorted.end());
+  const int size = static_cast<int>(sorted.size());
+  const long long n = size;
+  long long num = n * (n - 1) / 2;
+  for (int run_start = 0, i = 1; i <= size; ++i) {
+    if (i == size || sorted[i] != sorted[run_start]) {
+      const long long run = i - run_start;
+      num -= run * (run - 1) / 2;
+      run_start = i;
     }
   }
 
-  return num;
+  assert(num <= std::numeric_limits<int>::max());
+  return static_cast<int>(num);
+}
+
+int NumberOfUnmatchingPairs(const TypeAllocator& types) {
+  long long n = 0;
+  long long matching = 0;
+  for (int id = 0; id < types.num_ids(); ++id) {
+    const long long abundance = types.abundance(id);
+    n += abundance;
+    matching += abundance * (abundance - 1) / 2;
+  }
+  const long long num = n * (n - 1) / 2 - matching;
+  assert(num <= std::numeric_limits<int>::max());
+  return static_cast<int>(num);
 }
 
 int NumberOfUnmatchingLinks(const std::vector<int>& location_to_type, const Graph& graph) {
@@ -266,4 +616,38 @@ bool ToString(const Dynamic& dynamic, std::string* dynamic_str) {
   return false;
 }
 
-}  // namespace equilibrium
\ No newline at end of file
+bool FromString(const std::string& engine_str, SimulationEngine* engine) {
+  if (engine_str == "scalar") {
+    *engine = SimulationEngine::SCALAR;
+    return true;
+  }
+  if (engine_str == "ensemble") {
+    *engine = SimulationEngine::ENSEMBLE;
+    return true;
+  }
+  if (engine_str == "lumped") {
+    *engine = SimulationEngine::LUMPED;
+    return true;
+  }
+
+  return false;
+}
+
+bool ToString(const SimulationEngine& engine, std::string* engine_str) {
+  if (engine == SimulationEngine::SCALAR) {
+    *engine_str = "scalar";
+    return true;
+  }
+  if (engine == SimulationEngine::ENSEMBLE) {
+    *engine_str = "ensemble";
+    return true;
+  }
+  if (engine == SimulationEngine::LUMPED) {
+    *engine_str = "lumped";
+    return true;
+  }
+
+  return false;
+}
+
+}  // namespace equilibrium
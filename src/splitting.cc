@@ -0,0 +1,151 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <equilibrium/random.h>
+#include <equilibrium/splitting.h>
+#include <equilibrium/statistics.h>
+
+namespace equilibrium {
+
+namespace {
+
+/// One invasion in flight.
+struct Clone {
+  TwoTypePopulation population;
+  long long steps = 0;
+};
+
+}  // namespace
+
+bool FromString(const std::string& coordinate_str, ProgressCoordinate* coordinate) {
+  if (coordinate_str == "mutant-count") {
+    *coordinate = ProgressCoordinate::MUTANT_COUNT;
+    return true;
+  }
+  if (coordinate_str == "steps") {
+    *coordinate = ProgressCoordinate::STEPS;
+    return true;
+  }
+
+  return false;
+}
+
+bool ToString(const ProgressCoordinate& coordinate, std::string* coordinate_str) {
+  if (coordinate == ProgressCoordinate::MUTANT_COUNT) {
+    *coordinate_str = "mutant-count";
+    return true;
+  }
+  if (coordinate == ProgressCoordinate::STEPS) {
+    *coordinate_str = "steps";
+    return true;
+  }
+
+  return false;
+}
+
+void MakeEvenLevels(long long start, long long target, int num_levels, std::vector<long long>* levels) {
+  levels->clear();
+  for (int i = 1; i <= num_levels; ++i) {
+    // Rounded up, so the last level is exactly target.
+    const long long level = start + ((target - start) * i + num_levels - 1) / num_levels;
+    if (levels->empty() || level > levels->back()) levels->emplace_back(level);
+  }
+}
+
+bool RunSplitting(const SplittingConfig& config, SplittingResult* result) {
+  const auto& fixation = config.fixation;
+  const int N = fixation.graph.size();
+  const bool by_mutants = config.coordinate == ProgressCoordinate::MUTANT_COUNT;
+  const int num_levels = static_cast<int>(config.levels.size());
+  const int num_clones = config.clones_per_level;
+  assert(N > 0);
+  assert(num_clones > 0 && config.num_replications > 0);
+
+  if (config.levels.empty() || config.levels[0] <= (by_mutants ? 1 : 0)) return false;
+  if (by_mutants && config.levels.back() > N) return false;
+  for (int l = 1; l < num_levels; ++l) {
+    if (config.levels[l] <= config.levels[l - 1]) return false;
+  }
+
+  std::uint64_t base_seed = static_cast<std::uint64_t>(fixation.seed);
+  if (fixation.seed == kNoSeed) {
+    std::random_device rd;
+    base_seed = (static_cast<std::uint64_t>(rd()) << 32) | rd();
+  }
+
+  *result = SplittingResult();
+  result->level_probabilities.assign(num_levels, 0.);
+  RunningMoments estimates;
+  double relative_variance = 0;
+  std::vector<Clone> clones(num_clones);
+  std::vector<Clone> next_clones(num_clones);
+  std::vector<char> reached(num_clones);
+  std::vector<int> survivors;
+  std::vector<int> parents(num_clones);
+
+  for (int replication = 0; replication < config.num_replications; ++replication) {
+    double estimate = 1;
+    for (int l = 0; l < num_levels; ++l) {
+      const long long level = config.levels[l];
+      long long level_steps = 0;
+
+#pragma omp parallel for schedule(dynamic, 16) reduction(+:level_steps)
+      for (int c = 0; c < num_clones; ++c) {
+        const auto stream = (static_cast<std::uint64_t>(replication) * num_levels + l) * num_clones + c;
+        Xoshiro256 rng(base_seed, stream);
+        auto& clone = clones[c];
+        if (l == 0) {
+          clone.population.Reset(N);
+          clone.population.Set(GetStartNode(fixation, c, rng), true);
+          clone.steps = 0;
+        }
+        const long long start_steps = clone.steps;
+        if (by_mutants) {
+          AdvanceFixation(fixation, static_cast<int>(level), fixation.max_steps, rng, &clone.population, &clone.steps);
+          reached[c] = clone.population.num_mutants() >= level;
+        } else {
+          AdvanceFixation(fixation, N, level, rng, &clone.population, &clone.steps);
+          reached[c] = !clone.population.IsAbsorbed();
+        }
+        level_steps += clone.steps - start_steps;
+      }
+      result->steps += level_steps;
+
+      survivors.clear();
+      for (int c = 0; c < num_clones; ++c) {
+        if (reached[c]) survivors.emplace_back(c);
+      }
+      const double p = static_cast<double>(survivors.size()) / num_clones;
+      result->level_probabilities[l] += p / config.num_replications;
+      estimate *= p;
+      if (p > 0) relative_variance += (1 - p) / (num_clones * p);
+      if (survivors.empty() || l + 1 == num_levels) break;
+
+      // The next level starts from survivors drawn uniformly with replacement.
+      Xoshiro256 resample_rng(~base_seed, static_cast<std::uint64_t>(replication) * num_levels + l);
+      for (auto& parent : parents) {
+        parent = survivors[UniformIndex(resample_rng, static_cast<std::uint32_t>(survivors.size()))];
+      }
+#pragma omp parallel for schedule(static)
+      for (int c = 0; c < num_clones; ++c) next_clones[c] = clones[parents[c]];
+      clones.swap(next_clones);
+    }
+    estimates.Add(estimate);
+  }
+
+  result->probability = estimates.mean();
+  if (config.num_replications > 1) {
+    result->standard_error = std::sqrt(estimates.variance() / config.num_replications);
+  } else {
+    result->standard_error = result->probability * std::sqrt(relative_variance);
+  }
+  result->lower = std::max(0., result->probability - 1.96 * result->standard_error);
+  result->upper = std::min(1., result->probability + 1.96 * result->standard_error);
+  return true;
+}
+
+} // namespace equilibrium
@@ -0,0 +1,322 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <equilibrium/statistics.h>
+
+namespace equilibrium {
+
+void RunningMoments::Add(double x) {
+  ++count_;
+  const double delta = x - mean_;
+  mean_ += delta / static_cast<double>(count_);
+  m2_ += delta * (x - mean_);
+}
+
+void RunningMoments::Merge(const RunningMoments& other) {
+  if (other.count_ == 0) return;
+  if (count_ == 0) {
+    *this = other;
+    return;
+  }
+  const double n_a = static_cast<double>(count_);
+  const double n_b = static_cast<double>(other.count_);
+  const double n = n_a + n_b;
+  const double delta = other.mean_ - mean_;
+  mean_ += delta * n_b / n;
+  m2_ += other.m2_ + delta * delta * n_a * n_b / n;
+  count_ += other.count_;
+}
+
+double RunningMoments::variance() const {
+  if (count_ < 2) return 0;
+  return m2_ / static_cast<double>(count_ - 1);
+}
+
+void TDigest::Add(double x, double weight) {
+  if (empty()) {
+    min_ = x;
+    max_ = x;
+  }
+  min_ = std::min(min_, x);
+  max_ = std::max(max_, x);
+  buffer_.push_back({x, weight});
+  buffer_weight_ += weight;
+  if (static_cast<double>(buffer_.size()) >= 8 * compression_) Compress();
+}
+
+void TDigest::Merge(const TDigest& other) {
+  if (other.empty()) return;
+  if (empty()) {
+    min_ = other.min_;
+    max_ = other.max_;
+  }
+  min_ = std::min(min_, other.min_);
+  max_ = std::max(max_, other.max_);
+  for (const auto& centroids : {&other.centroids_, &other.buffer_}) {
+    for (const auto& centroid : *centroids) {
+      buffer_.push_back(centroid);
+      buffer_weight_ += centroid.weight;
+    }
+  }
+  Compress();
+}
+
+void TDigest::Compress() const {
+  if (buffer_.empty()) return;
+  buffer_.insert(buffer_.end(), centroids_.begin(), centroids_.end());
+  std::sort(buffer_.begin(), buffer_.end(),
+            [](const Centroid& a, const Centroid& b) { return a.mean < b.mean; });
+  total_weight_ += buffer_weight_;
+  buffer_weight_ = 0;
+
+  // k1 scale: centroids may span at most one unit of k.
+  const double pi = std::acos(-1.);
+  const auto k = [&](double q) { return compression_ / (2 * pi) * std::asin(2 * q - 1); };
+  centroids_.clear();
+  Centroid current = buffer_[0];
+  double weight_so_far = 0;
+  for (int i = 1; i < static_cast<int>(buffer_.size()); ++i) {
+    const auto& next = buffer_[i];
+    const double q_left = weight_so_far / total_weight_;
+    const double q_right = std::min(1., (weight_so_far + current.weight + next.weight) / total_weight_);
+    if (k(q_right) - k(q_left) <= 1) {
+      current.weight += next.weight;
+      current.mean += (next.mean - current.mean) * next.weight / current.weight;
+    } else {
+      weight_so_far += current.weight;
+      centroids_.push_back(current);
+      current = next;
+    }
+  }
+  centroids_.push_back(current);
+  buffer_.clear();
+}
+
+double TDigest::Quantile(double q) const {
+  Compress();
+  if (centroids_.empty()) return 0;
+  if (centroids_.size() == 1) return centroids_[0].mean;
+  const double target = std::min(std::max(q, 0.), 1.) * total_weight_;
+
+  // Interpolate between centroid centres, and towards min/max at the ends.
+  double previous_center = 0;
+  double previous_mean = min_;
+  double cumulative = 0;
+  for (const auto& centroid : centroids_) {
+    const double center = cumulative + centroid.weight / 2;
+    if (target < center) {
+      const double span = center - previous_center;
+      return previous_mean + (centroid.mean - previous_mean) * (span > 0 ? (target - previous_center) / span : 0);
+    }
+    previous_center = center;
+    previous_mean = centroid.mean;
+    cumulative += centroid.weight;
+  }
+  const double span = total_weight_ - previous_center;
+  return previous_mean + (max_ - previous_mean) * (span > 0 ? (target - previous_center) / span : 0);
+}
+
+void LogHistogram::Add(double x) {
+  if (x < 1) {
+    ++underflow_;
+    return;
+  }
+  // Nudge exact powers of two into their own bucket despite rounding.
+  ++buckets_[static_cast<int>(std::floor(std::log2(x) * buckets_per_octave_ + 1e-9))];
+}
+
+void LogHistogram::Merge(const LogHistogram& other) {
+  underflow_ += other.underflow_;
+  for (const auto& bucket : other.buckets_) buckets_[bucket.first] += bucket.second;
+}
+
+double LogHistogram::lower(int bucket) const {
+  return std::exp2(static_cast<double>(bucket) / buckets_per_octave_);
+}
+
+void SampleSummary::Add(double x) {
+  moments.Add(x);
+  histogram.Add(x);
+  quantiles.Add(x);
+}
+
+void SampleSummary::Merge(const SampleSummary& other) {
+  moments.Merge(other.moments);
+  histogram.Merge(other.histogram);
+  quantiles.Merge(other.quantiles);
+}
+
+void ComputePairedDifference(const std::vector<double>& a, const std::vector<double>& b,
+                             PairedDifference* difference) {
+  assert(a.size() == b.size());
+  RunningMoments a_moments;
+  RunningMoments b_moments;
+  RunningMoments differences;
+  for (int k = 0; k < static_cast<int>(a.size()); ++k) {
+    a_moments.Add(a[k]);
+    b_moments.Add(b[k]);
+    differences.Add(b[k] - a[k]);
+  }
+  *difference = PairedDifference();
+  difference->num_pairs = differences.count();
+  if (difference->num_pairs == 0) return;
+  const double n = static_cast<double>(difference->num_pairs);
+  difference->mean = differences.mean();
+  difference->variance = differences.variance();
+  difference->standard_error = std::sqrt(differences.variance() / n);
+  difference->unpaired_standard_error = std::sqrt((a_moments.variance() + b_moments.variance()) / n);
+}
+
+void WilsonInterval(long long successes, long long trials, double z, double* lower, double* upper) {
+  if (trials == 0) {
+    *lower = 0;
+    *upper = 1;
+    return;
+  }
+  const double n = static_cast<double>(trials);
+  const double p = static_cast<double>(successes) / n;
+  const double z2 = z * z;
+  const double center = (p + z2 / (2 * n)) / (1 + z2 / n);
+  const double half_width = z * std::sqrt(p * (1 - p) / n + z2 / (4 * n * n)) / (1 + z2 / n);
+  *lower = std::max(0.0, center - half_width);
+  *upper = std::min(1.0, center + half_width);
+}
+
+namespace {
+
+/// both[x] holds the counts of x in a and in b.
+void JoinHistograms(const Histogram& a, const Histogram& b,
+                    std::map<long long, std::pair<long long, long long>>* both, long long* total_a, long long* total_b) {
+  *total_a = 0;
+  *total_b = 0;
+  for (const auto& count : a) {
+    (*both)[count.first].first += count.second;
+    *total_a += count.second;
+  }
+  for (const auto& count : b) {
+    (*both)[count.first].second += count.second;
+    *total_b += count.second;
+  }
+}
+
+}  // namespace
+
+double ChiSquarePValue(double statistic, int degrees_of_freedom) {
+  if (!(statistic > 0) || degrees_of_freedom <= 0) return 1;
+  // Regularised upper incomplete gamma Q(k / 2, x / 2): its series below
+  // k / 2 + 1, Lentz's continued fraction above.
+  const double a = degrees_of_freedom / 2.;
+  const double x = statistic / 2;
+  const double log_prefix = a * std::log(x) - x - std::lgamma(a);
+  const double epsilon = 1e-15;
+  if (x < a + 1) {
+    double term = 1 / a;
+    double sum = term;
+    for (int k = 1; k < 10000 && std::fabs(term) > std::fabs(sum) * epsilon; ++k) {
+      term *= x / (a + k);
+      sum += term;
+    }
+    return std::max(0., 1 - sum * std::exp(log_prefix));
+  }
+  const double tiny = 1e-300;
+  double b = x + 1 - a;
+  double c = 1 / tiny;
+  double d = 1 / b;
+  double fraction = d;
+  for (int k = 1; k < 10000; ++k) {
+    const double numerator = -k * (k - a);
+    b += 2;
+    d = numerator * d + b;
+    if (std::fabs(d) < tiny) d = tiny;
+    c = b + numerator / c;
+    if (std::fabs(c) < tiny) c = tiny;
+    d = 1 / d;
+    fraction *= d * c;
+    if (std::fabs(d * c - 1) < epsilon) break;
+  }
+  return std::min(1., std::exp(log_prefix) * fraction);
+}
+
+void ChiSquareTest(const Histogram& a, const Histogram& b, TestResult* result) {
+  *result = TestResult();
+  std::map<long long, std::pair<long long, long long>> both;
+  long long total_a;
+  long long total_b;
+  JoinHistograms(a, b, &both, &total_a, &total_b);
+  if (total_a == 0 || total_b == 0) return;
+
+  const double share_a = static_cast<double>(total_a) / static_cast<double>(total_a + total_b);
+  const double min_expected = 5;
+  std::vector<std::pair<long long, long long>> bins;
+  std::pair<long long, long long> bin(0, 0);
+  for (const auto& count : both) {
+    bin.first += count.second.first;
+    bin.second += count.second.second;
+    const double pooled = static_cast<double>(bin.first + bin.second);
+    if (pooled * share_a >= min_expected && pooled * (1 - share_a) >= min_expected) {
+      bins.push_back(bin);
+      bin = std::make_pair(0LL, 0LL);
+    }
+  }
+  // The short tail joins the last full bin.
+  if (bins.empty()) return;
+  bins.back().first += bin.first;
+  bins.back().second += bin.second;
+  if (bins.size() < 2) return;
+
+  for (const auto& full_bin : bins) {
+    const double pooled = static_cast<double>(full_bin.first + full_bin.second);
+    const double expected_a = pooled * share_a;
+    const double expected_b = pooled * (1 - share_a);
+    const double excess_a = static_cast<double>(full_bin.first) - expected_a;
+    const double excess_b = static_cast<double>(full_bin.second) - expected_b;
+    result->statistic += excess_a * excess_a / expected_a + excess_b * excess_b / expected_b;
+  }
+  result->degrees_of_freedom = static_cast<int>(bins.size()) - 1;
+  result->p_value = ChiSquarePValue(result->statistic, result->degrees_of_freedom);
+}
+
+void KolmogorovSmirnovTest(const Histogram& a, const Histogram& b, TestResult* result) {
+  *result = TestResult();
+  std::map<long long, std::pair<long long, long long>> both;
+  long long total_a;
+  long long total_b;
+  JoinHistograms(a, b, &both, &total_a, &total_b);
+  if (total_a == 0 || total_b == 0) return;
+
+  // Both CDFs only step at observed values.
+  long long below_a = 0;
+  long long below_b = 0;
+  for (const auto& count : both) {
+    below_a += count.second.first;
+    below_b += count.second.second;
+    const double distance = std::fabs(static_cast<double>(below_a) / static_cast<double>(total_a) -
+                                      static_cast<double>(below_b) / static_cast<double>(total_b));
+    result->statistic = std::max(result->statistic, distance);
+  }
+
+  const double n = static_cast<double>(total_a) * static_cast<double>(total_b) /
+      static_cast<double>(total_a + total_b);
+  const double lambda = (std::sqrt(n) + 0.12 + 0.11 / std::sqrt(n)) * result->statistic;
+  // The Kolmogorov series is 1 to double precision below 0.2, where it also
+  // converges slowly.
+  if (lambda < 0.2) return;
+  double p_value = 0;
+  for (int k = 1; k <= 100; ++k) {
+    const double term = 2 * std::exp(-2. * k * k * lambda * lambda);
+    p_value += k % 2 == 1 ? term : -term;
+    if (term < 1e-16) break;
+  }
+  result->p_value = std::min(1., std::max(0., p_value));
+}
+
+double KolmogorovSmirnovResolution(long long n, long long m, double alpha) {
+  const double critical = std::sqrt(-0.5 * std::log(alpha / 2));
+  return critical * std::sqrt(static_cast<double>(n + m) / (static_cast<double>(n) * static_cast<double>(m)));
+}
+
+}  // namespace equilibrium
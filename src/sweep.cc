@@ -0,0 +1,91 @@
+#include <cassert>
+#include <cstdint>
+#include <exception>
+#include <string>
+#include <vector>
+
+#include <equilibrium/random.h>
+#include <equilibrium/sweep.h>
+
+namespace equilibrium {
+
+namespace {
+
+void ComputeTrialSamples(const SimulationConfig& config, TrialSamples* samples) {
+  // Pre-size so that each trial writes its own slot without locking.
+  for (const auto& measure : DIVERSITY_MEASURES) (*samples)[measure].assign(config.num_simulations, 0);
+
+#pragma omp parallel
+  {
+    SimulationWorkspace workspace(config);
+    Stats stats;
+
+#pragma omp for schedule(dynamic)
+    for (int trial = 0; trial < config.num_simulations; ++trial) {
+      Simulate(config, trial, &workspace, &stats, nullptr);
+      for (const auto& measure : DIVERSITY_MEASURES) {
+        samples->at(measure)[trial] = GetMeasureResult(stats, measure);
+      }
+    }
+  }
+}
+
+/// A seed of its own for point p, hashed from (seed, p): seed + p overflows
+/// near INT_MAX. Non-negative, so never kNoSeed.
+int PointSeed(int seed, int p) {
+  std::uint32_t point_seed;
+  SeedSequence(static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(p)).generate(&point_seed, &point_seed + 1);
+  return static_cast<int>(point_seed & 0x7fffffffu);
+}
+
+}  // namespace
+
+bool SetSweepParameter(const std::string& parameter, const std::string& value, SimulationConfig* config) {
+  if (parameter == "dynamic") return FromString(value, &config->dynamic);
+
+  double rate;
+  try {
+    std::size_t end;
+    rate = std::stod(value, &end);
+    if (end != value.size()) return false;
+  } catch (const std::exception&) {
+    return false;
+  }
+  if (!(rate >= 0 && rate <= 1)) return false;
+  if (parameter == "birth_mutation_rate") {
+    config->birth_mutation_rate = rate;
+  } else if (parameter == "independent_mutation_rate") {
+    config->independent_mutation_rate = rate;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool ComputeSweep(const SimulationConfig& config, const std::string& parameter, const std::vector<std::string>& values,
+                  SweepResults* results) {
+  assert(config.seed != kNoSeed);
+  assert(config.compute_stats && !config.capture_history);
+  results->parameter = parameter;
+  results->values = values;
+  results->samples.assign(values.size(), TrialSamples());
+  results->differences.assign(values.size(), {});
+
+  const int num_values = static_cast<int>(values.size());
+  for (int p = 0; p < num_values; ++p) {
+    SimulationConfig point = config;
+    if (!SetSweepParameter(parameter, values[p], &point)) return false;
+    if (!config.common_random_numbers) point.seed = PointSeed(config.seed, p);
+    ComputeTrialSamples(point, &results->samples[p]);
+  }
+
+  for (int p = 1; p < num_values; ++p) {
+    for (const auto& measure : DIVERSITY_MEASURES) {
+      ComputePairedDifference(results->samples[0].at(measure), results->samples[p].at(measure),
+                              &results->differences[p][measure]);
+    }
+  }
+  return true;
+}
+
+} // namespace equilibrium
@@ -0,0 +1,110 @@
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+#include <equilibrium/trajectory.h>
+
+namespace equilibrium {
+
+void MakeCheckpoints(int num_steps, int num_checkpoints, bool log_spaced, std::vector<int>* checkpoints) {
+  checkpoints->clear();
+  checkpoints->push_back(0);
+  for (int i = 1; i <= num_checkpoints; ++i) {
+    const double fraction = static_cast<double>(i) / num_checkpoints;
+    const double step = log_spaced ? std::pow(num_steps, fraction) : fraction * num_steps;
+    checkpoints->push_back(static_cast<int>(std::lround(step)));
+  }
+  checkpoints->push_back(num_steps);
+  std::sort(checkpoints->begin(), checkpoints->end());
+  checkpoints->erase(std::unique(checkpoints->begin(), checkpoints->end()), checkpoints->end());
+}
+
+namespace {
+
+void AddTrajectory(const std::vector<std::vector<double>>& trajectory, TrajectorySummary* summary) {
+  for (int c = 0; c < static_cast<int>(trajectory.size()); ++c) {
+    for (int s = 0; s < static_cast<int>(trajectory[c].size()); ++s) {
+      summary->moments[c][s].Add(trajectory[c][s]);
+      summary->quantiles[c][s].Add(trajectory[c][s]);
+    }
+  }
+}
+
+void ResizeSummary(const std::vector<int>& checkpoints, const std::vector<std::string>& series,
+                   TrajectorySummary* summary) {
+  summary->checkpoints = checkpoints;
+  summary->series = series;
+  summary->moments.assign(checkpoints.size(), std::vector<RunningMoments>(series.size()));
+  summary->quantiles.assign(checkpoints.size(), std::vector<TDigest>(series.size()));
+}
+
+}  // namespace
+
+void ComputeTrajectories(const SimulationConfig& config, int first_trial, int last_trial, TrajectorySummary* summary) {
+  // The two pair measures are tracked incrementally alongside any extra ones.
+  SimulationConfig trajectory_config = config;
+  trajectory_config.compute_stats = true;
+  trajectory_config.capture_history = false;
+  trajectory_config.measures.clear();
+  for (const auto& name : {"unmatching_pairs", "unmatching_links"}) {
+    std::shared_ptr<const MeasureTracker> tracker;
+    MakeMeasureTracker(name, config.graph, &tracker);
+    trajectory_config.measures.push_back(tracker);
+  }
+  trajectory_config.measures.insert(trajectory_config.measures.end(), config.measures.begin(), config.measures.end());
+
+  std::vector<std::string> series = {"number_of_types", "number_of_unmatching_pairs", "number_of_unmatching_links"};
+  std::vector<int> sizes;
+  if (first_trial < last_trial) {
+    // Measure sizes depend on N; learn them from an empty run.
+    SimulationConfig probe_config = trajectory_config;
+    probe_config.num_steps = 0;
+    probe_config.run_until_homogeneous = false;
+    probe_config.checkpoints.clear();
+    Stats probe;
+    Simulate(probe_config, first_trial, &probe, nullptr);
+    for (int i = 2; i < static_cast<int>(probe.measures.size()); ++i) {
+      const auto& result = probe.measures[i];
+      if (result.final.size() == 1) {
+        series.push_back(result.name);
+        continue;
+      }
+      for (int k = 1; k <= static_cast<int>(result.final.size()); ++k) {
+        series.push_back(result.name + "_" + std::to_string(k));
+      }
+    }
+  }
+  ResizeSummary(config.checkpoints, series, summary);
+
+#pragma omp parallel
+  {
+    TrajectorySummary local;
+    ResizeSummary(config.checkpoints, series, &local);
+    SimulationWorkspace workspace(trajectory_config);
+    Stats stats;
+
+#pragma omp for schedule(dynamic)
+    for (int trial = first_trial; trial < last_trial; ++trial) {
+      Simulate(trajectory_config, trial, &workspace, &stats, nullptr);
+      AddTrajectory(stats.trajectory, &local);
+    }
+
+#pragma omp critical
+    MergeTrajectorySummary(local, summary);
+  }
+}
+
+void MergeTrajectorySummary(const TrajectorySummary& from, TrajectorySummary* to) {
+  if (to->checkpoints.empty() && to->series.empty()) {
+    *to = from;
+    return;
+  }
+  for (int c = 0; c < static_cast<int>(from.moments.size()); ++c) {
+    for (int s = 0; s < static_cast<int>(from.moments[c].size()); ++s) {
+      to->moments[c][s].Merge(from.moments[c][s]);
+      to->quantiles[c][s].Merge(from.quantiles[c][s]);
+    }
+  }
+}
+
+} // namespace equilibrium
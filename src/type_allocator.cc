@@ -0,0 +1,50 @@
+#include <cassert>
+
+#include <equilibrium/type_allocator.h>
+
+namespace equilibrium {
+
+void TypeAllocator::Reset(int num_locations, int num_initial_types) {
+  assert(num_initial_types == 1 || num_initial_types == num_locations);
+  // The old id of a location is released before a mutation allocates, so N
+  // ids are enough; one spare keeps Allocate safe in any order.
+  const int capacity = num_locations + 1;
+  abundance_.assign(capacity, 0);
+  global_types_.assign(capacity, -1);
+  free_ids_.clear();
+  for (int id = capacity - 1; id >= num_initial_types; --id) {
+    free_ids_.push_back(id);
+  }
+  for (int id = 0; id < num_initial_types; ++id) {
+    abundance_[id] = num_locations / num_initial_types;
+    global_types_[id] = id;
+  }
+  num_types_ = num_initial_types;
+  next_global_type_ = num_initial_types;
+}
+
+int TypeAllocator::Allocate() {
+  assert(!free_ids_.empty());
+  const int id = free_ids_.back();
+  free_ids_.pop_back();
+  global_types_[id] = next_global_type_++;
+  return id;
+}
+
+void TypeAllocator::Replace(int old_id, int new_id) {
+  if (old_id == new_id) return;
+  if (abundance_[new_id]++ == 0) ++num_types_;
+  if (--abundance_[old_id] == 0) {
+    --num_types_;
+    free_ids_.push_back(old_id);
+  }
+}
+
+void TypeAllocator::ToGlobal(const std::vector<int>& location_to_id, std::vector<int>* location_to_type) const {
+  location_to_type->resize(location_to_id.size());
+  for (int i = 0; i < static_cast<int>(location_to_id.size()); ++i) {
+    (*location_to_type)[i] = global_types_[location_to_id[i]];
+  }
+}
+
+} // namespace equilibrium
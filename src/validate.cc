@@ -0,0 +1,300 @@
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <equilibrium/ensemble.h>
+#include <equilibrium/fixation.h>
+#include <equilibrium/graph.h>
+#include <equilibrium/lumped.h>
+#include <equilibrium/parallel_trajectory.h>
+#include <equilibrium/random.h>
+#include <equilibrium/validate.h>
+
+namespace equilibrium {
+
+namespace {
+
+/// False when the candidate does not run config.
+bool ApplyCandidate(const ValidationCandidate& candidate, SimulationConfig* config) {
+  if (candidate == ValidationCandidate::ENSEMBLE) {
+    config->engine = SimulationEngine::ENSEMBLE;
+    return SupportsEnsemble(*config);
+  }
+  if (candidate == ValidationCandidate::LUMPED) {
+    config->engine = SimulationEngine::LUMPED;
+    return SupportsLumped(*config);
+  }
+  config->common_random_numbers = true;
+  return true;
+}
+
+void GetAbsorptionTimes(const SimulationConfig& config, Histogram* histogram) {
+  const int n = config.graph.size();
+  Trends trends;
+  ComputeTrends({{n, config}}, 0, config.num_simulations, &trends);
+  for (const auto& time : trends[n]) ++(*histogram)[time];
+}
+
+void GetDiversityCounts(const SimulationConfig& config, std::map<DiversityMeasure, Histogram>* histograms) {
+  DiversityCounts diversity_counts;
+  ComputeDiversityCounts(config, &diversity_counts);
+  for (const auto& measure_counts : diversity_counts) {
+    auto& histogram = (*histograms)[measure_counts.first];
+    for (const auto& count : measure_counts.second) histogram[count.first] += count.second;
+  }
+}
+
+/// Trial k of config lands in (*trials)[k], from either fixation engine.
+void GetFixationTrials(const FixationConfig& config, std::vector<FixationTrial>* trials) {
+  const auto base_seed = static_cast<std::uint64_t>(config.seed);
+  trials->assign(config.num_simulations, FixationTrial());
+  if (config.engine == FixationEngine::BATCHED) {
+    NeighborTable table;
+    GetNeighborTable(config.graph, config.dynamic, &table);
+    const int num_blocks = (config.num_simulations + config.batch_size - 1) / config.batch_size;
+#pragma omp parallel for schedule(dynamic)
+    for (int block = 0; block < num_blocks; ++block) {
+      const int first_trial = block * config.batch_size;
+      const int last_trial = std::min(config.num_simulations, first_trial + config.batch_size);
+      FixationResults results;
+      std::vector<FixationTrial> block_trials(last_trial - first_trial);
+      RunFixationBlock(config, table, base_seed, first_trial, last_trial, &results, &block_trials);
+      std::copy(block_trials.begin(), block_trials.end(), trials->begin() + first_trial);
+    }
+    return;
+  }
+
+#pragma omp parallel
+  {
+    TwoTypePopulation population;
+#pragma omp for schedule(dynamic, config.batch_size)
+    for (int trial = 0; trial < config.num_simulations; ++trial) {
+      Xoshiro256 rng(base_seed, static_cast<std::uint64_t>(trial));
+      RunFixationTrial(config, GetStartNode(config, trial, rng), rng, &population, &(*trials)[trial]);
+    }
+  }
+}
+
+/// Keyed by ValidationResult::quantity.
+void GetFixations(const FixationConfig& config, std::map<std::string, Histogram>* histograms) {
+  std::vector<FixationTrial> trials;
+  GetFixationTrials(config, &trials);
+  for (const auto& trial : trials) {
+    const bool fixation = trial.outcome == FixationOutcome::FIXATION;
+    ++(*histograms)["fixation"][fixation ? 1 : 0];
+    ++(*histograms)[fixation ? "fixation_time" : "extinction_time"][trial.steps];
+  }
+}
+
+/// Types of continuous-time Simulate's trial at end_time: the snapshot after
+/// the last step at or before it.
+void SimulateUntil(const SimulationConfig& config, int trial, double end_time, std::vector<int>* location_to_type) {
+  SimulationConfig timed = config;
+  timed.continuous_time = true;
+  timed.capture_history = true;
+  timed.history_sample_rate = 1;
+  timed.compute_stats = false;
+  // About N * end_time steps fall before end_time. A trial's steps do not
+  // depend on num_steps, so a longer rerun extends a short one.
+  timed.num_steps = 2 * static_cast<int>(config.graph.size() * end_time) + 100;
+  SimulationHistory history;
+  for (;;) {
+    history = SimulationHistory();
+    Simulate(timed, trial, nullptr, &history);
+    if (history.times.back() > end_time) break;
+    timed.num_steps *= 2;
+  }
+  int snapshot = 0;
+  while (history.times[snapshot + 1] <= end_time) ++snapshot;
+  location_to_type->swap(history.location_to_types[snapshot]);
+}
+
+/// Diversity counts at end_time, from SimulateParallel or continuous-time
+/// Simulate. Trials run across threads, so SimulateParallel's own parallel
+/// regions run on one thread each.
+void GetDiversityCountsAt(const SimulationConfig& config, double end_time, bool parallel,
+                          std::map<DiversityMeasure, Histogram>* histograms) {
+  std::vector<std::vector<int>> final_types(config.num_simulations);
+#pragma omp parallel for schedule(dynamic)
+  for (int trial = 0; trial < config.num_simulations; ++trial) {
+    if (parallel) {
+      Stats stats;
+      SimulateParallel(config, trial, end_time, &stats, &final_types[trial]);
+    } else {
+      SimulateUntil(config, trial, end_time, &final_types[trial]);
+    }
+  }
+  auto& types = (*histograms)[DiversityMeasure::NUMBER_OF_TYPES];
+  auto& pairs = (*histograms)[DiversityMeasure::NUMBER_OF_UNMATCHING_PAIRS];
+  auto& links = (*histograms)[DiversityMeasure::NUMBER_OF_UNMATCHING_LINKS];
+  for (const auto& location_to_type : final_types) {
+    ++types[NumberOfTypes(location_to_type)];
+    ++pairs[NumberOfUnmatchingPairs(location_to_type)];
+    ++links[NumberOfUnmatchingLinks(location_to_type, config.graph)];
+  }
+}
+
+void Compare(const Histogram& reference, const Histogram& candidate, ValidationResult* result) {
+  ChiSquareTest(reference, candidate, &result->chi_square);
+  KolmogorovSmirnovTest(reference, candidate, &result->kolmogorov_smirnov);
+}
+
+}  // namespace
+
+bool FromString(const std::string& candidate_str, ValidationCandidate* candidate) {
+  if (candidate_str == "ensemble") {
+    *candidate = ValidationCandidate::ENSEMBLE;
+    return true;
+  }
+  if (candidate_str == "lumped") {
+    *candidate = ValidationCandidate::LUMPED;
+    return true;
+  }
+  if (candidate_str == "common-random-numbers") {
+    *candidate = ValidationCandidate::COMMON_RANDOM_NUMBERS;
+    return true;
+  }
+  if (candidate_str == "batched-fixation") {
+    *candidate = ValidationCandidate::BATCHED_FIXATION;
+    return true;
+  }
+  if (candidate_str == "parallel-trajectory") {
+    *candidate = ValidationCandidate::PARALLEL_TRAJECTORY;
+    return true;
+  }
+
+  return false;
+}
+
+bool ToString(const ValidationCandidate& candidate, std::string* candidate_str) {
+  if (candidate == ValidationCandidate::ENSEMBLE) {
+    *candidate_str = "ensemble";
+    return true;
+  }
+  if (candidate == ValidationCandidate::LUMPED) {
+    *candidate_str = "lumped";
+    return true;
+  }
+  if (candidate == ValidationCandidate::COMMON_RANDOM_NUMBERS) {
+    *candidate_str = "common-random-numbers";
+    return true;
+  }
+  if (candidate == ValidationCandidate::BATCHED_FIXATION) {
+    *candidate_str = "batched-fixation";
+    return true;
+  }
+  if (candidate == ValidationCandidate::PARALLEL_TRAJECTORY) {
+    *candidate_str = "parallel-trajectory";
+    return true;
+  }
+
+  return false;
+}
+
+bool RunValidation(const ValidationConfig& config, std::vector<ValidationResult>* results) {
+  results->clear();
+  if (config.candidate == ValidationCandidate::BATCHED_FIXATION && !IsValidFitness(config.mutant_fitness)) {
+    return false;
+  }
+  for (const auto& graph_name : config.graph_names) {
+    for (const auto& n : config.ns) {
+      for (const auto& dynamic : config.dynamics) {
+        for (const auto& mutation_rate : config.mutation_rates) {
+          SimulationConfig reference;
+          if (!GetGraph(graph_name, n, &reference.graph)) return false;
+          const bool absorption = !(mutation_rate > 0);
+          reference.birth_mutation_rate = mutation_rate;
+          reference.independent_mutation_rate = mutation_rate;
+          reference.num_steps = absorption ? 0 : config.num_steps;
+          reference.num_simulations = config.num_trials;
+          reference.dynamic = dynamic;
+          reference.compute_stats = true;
+          reference.capture_history = false;
+          reference.start_with_max_diversity = absorption;
+          reference.run_until_homogeneous = absorption;
+          reference.seed = config.seed;
+
+          ValidationResult result;
+          result.graph_name = graph_name;
+          result.n = n;
+          result.dynamic = dynamic;
+          result.mutation_rate = mutation_rate;
+          if (config.candidate == ValidationCandidate::BATCHED_FIXATION) {
+            // Fixation trials have no mutations.
+            if (!absorption) continue;
+            FixationConfig fixation;
+            fixation.dynamic = dynamic;
+            fixation.graph = reference.graph;
+            fixation.mutant_fitness = config.mutant_fitness;
+            fixation.num_simulations = config.num_trials;
+            fixation.seed = config.seed;
+            std::map<std::string, Histogram> reference_fixations;
+            GetFixations(fixation, &reference_fixations);
+            fixation.engine = FixationEngine::BATCHED;
+            fixation.seed = config.seed + 1;
+            std::map<std::string, Histogram> candidate_fixations;
+            GetFixations(fixation, &candidate_fixations);
+            for (const std::string quantity : {"fixation", "fixation_time", "extinction_time"}) {
+              result.quantity = quantity;
+              Compare(reference_fixations[quantity], candidate_fixations[quantity], &result);
+              results->push_back(result);
+            }
+            continue;
+          }
+          if (config.candidate == ValidationCandidate::PARALLEL_TRAJECTORY) {
+            reference.independent_mutation_rate = 0;
+            reference.run_until_homogeneous = false;
+            SimulationConfig candidate = reference;
+            candidate.seed = config.seed + 1;
+            if (!SupportsParallelTrajectory(candidate)) continue;
+            const double end_time = static_cast<double>(config.num_steps) / n;
+            std::map<DiversityMeasure, Histogram> reference_counts;
+            std::map<DiversityMeasure, Histogram> candidate_counts;
+            GetDiversityCountsAt(reference, end_time, false, &reference_counts);
+            GetDiversityCountsAt(candidate, end_time, true, &candidate_counts);
+            for (const auto& measure : DIVERSITY_MEASURES) {
+              ToString(measure, &result.quantity);
+              Compare(reference_counts[measure], candidate_counts[measure], &result);
+              results->push_back(result);
+            }
+            continue;
+          }
+
+          SimulationConfig candidate = reference;
+          candidate.seed = config.seed + 1;
+          if (!ApplyCandidate(config.candidate, &candidate)) continue;
+          if (absorption) {
+            Histogram reference_times;
+            Histogram candidate_times;
+            GetAbsorptionTimes(reference, &reference_times);
+            GetAbsorptionTimes(candidate, &candidate_times);
+            result.quantity = "absorption_time";
+            Compare(reference_times, candidate_times, &result);
+            results->push_back(result);
+          } else {
+            std::map<DiversityMeasure, Histogram> reference_counts;
+            std::map<DiversityMeasure, Histogram> candidate_counts;
+            GetDiversityCounts(reference, &reference_counts);
+            GetDiversityCounts(candidate, &candidate_counts);
+            for (const auto& measure : DIVERSITY_MEASURES) {
+              ToString(measure, &result.quantity);
+              Compare(reference_counts[measure], candidate_counts[measure], &result);
+              results->push_back(result);
+            }
+          }
+        }
+      }
+    }
+  }
+
+  // Bonferroni over both tests of every result.
+  const double test_alpha = config.alpha / static_cast<double>(std::max<std::size_t>(1, 2 * results->size()));
+  for (auto& result : *results) {
+    result.passed = result.chi_square.p_value >= test_alpha && result.kolmogorov_smirnov.p_value >= test_alpha;
+  }
+  return true;
+}
+
+} // namespace equilibrium
@@ -1,8 +1,14 @@
+#include <cmath>
+#include <iomanip>
+#include <map>
 #include <ostream>
 #include <sstream>
 #include <string>
 
+#include <equilibrium/fixation.h>
+#include <equilibrium/profile.h>
 #include <equilibrium/simulation.h>
+#include <equilibrium/trajectory.h>
 #include <equilibrium/writer.h>
 
 #include <nlohmann/json.hpp>
@@ -27,6 +33,57 @@ long long GetSeconds(const std::chrono::time_point<std::chrono::system_clock>& t
   return seconds;
 }
 
+nlohmann::json ProfileToJson(const Profile& profile) {
+  nlohmann::json profile_json;
+  profile_json["trials"] = profile.trials;
+  profile_json["steps"] = profile.steps;
+  profile_json["effective_steps"] = profile.effective_steps;
+  profile_json["mutations"] = profile.mutations;
+  profile_json["rng_draws"] = profile.rng_draws;
+  profile_json["history_snapshots"] = profile.history_snapshots;
+  profile_json["burn_in_s"] = profile.burn_in_seconds;
+  profile_json["stats_s"] = profile.stats_seconds;
+  profile_json["serialisation_s"] = profile.serialisation_seconds;
+  profile_json["replica_bytes"] = profile.replica_bytes;
+  return profile_json;
+}
+
+/// Serialisation time covers building the JSON document; the final dump to
+/// the stream happens after the profile block is written.
+void AddProfile(const std::chrono::steady_clock::time_point& serialisation_start, nlohmann::json* j) {
+  if (!kProfile) return;
+  ThreadProfile().serialisation_seconds += SecondsSince(serialisation_start);
+
+  std::vector<Profile> profiles;
+  CollectProfiles(&profiles);
+  Profile total;
+  // Pinned threads are also summed per NUMA node, see ConfigReplicas.
+  std::map<int, Profile> nodes;
+  std::map<int, int> node_threads;
+  auto& profile_json = (*j)["profile"];
+  for (const auto& profile : profiles) {
+    auto thread_json = ProfileToJson(profile);
+    thread_json["thread"] = profile.thread;
+    thread_json["numa_node"] = profile.numa_node;
+    profile_json["threads"].emplace_back(thread_json);
+    MergeProfile(profile, &total);
+    if (profile.numa_node >= 0) {
+      MergeProfile(profile, &nodes[profile.numa_node]);
+      ++node_threads[profile.numa_node];
+    }
+  }
+  profile_json["total"] = ProfileToJson(total);
+  for (const auto& node : nodes) {
+    auto node_json = ProfileToJson(node.second);
+    node_json["numa_node"] = node.first;
+    node_json["threads"] = node_threads[node.first];
+    // burn_in_s sums over the node's threads, which run side by side.
+    node_json["steps_per_second"] = node.second.burn_in_seconds > 0
+        ? static_cast<double>(node.second.steps * node_threads[node.first]) / node.second.burn_in_seconds : 0.;
+    profile_json["numa_nodes"].emplace_back(node_json);
+  }
+}
+
 std::string GetOutputFileName(
   const std::string& prefix,
   const std::chrono::time_point<std::chrono::system_clock>& time
@@ -40,21 +97,212 @@ std::string GetOutputFileName(
   return ss.str();
 }
 
+nlohmann::json FixationResultToJson(const FixationResult& result) {
+  nlohmann::json result_json;
+  result_json["trials"] = result.trials;
+  result_json["fixations"] = result.fixations;
+  result_json["undecided"] = result.undecided;
+
+  double lower, upper;
+  WilsonInterval(result.fixations, result.trials, 1.96, &lower, &upper);
+  result_json["fixation_probability"] =
+      result.trials > 0 ? static_cast<double>(result.fixations) / static_cast<double>(result.trials) : 0.;
+  result_json["fixation_probability_ci95"] = {lower, upper};
+
+  result_json["mean_fixation_time"] = result.fixation_time.mean();
+  result_json["fixation_time_stddev"] = std::sqrt(result.fixation_time.variance());
+  result_json["mean_extinction_time"] = result.extinction_time.mean();
+  result_json["extinction_time_stddev"] = std::sqrt(result.extinction_time.variance());
+  return result_json;
+}
+
+void WriteFixationToStream(
+    const FixationResults& results,
+    const FixationConfig& config,
+    const MetaData& metadata,
+    std::ostream* os
+) {
+  const auto serialisation_start = ProfileNow();
+  nlohmann::json j;
+  auto& config_json = j["config"];
+  config_json["graph_name"] = config.graph.name();
+  config_json["N"] = config.graph.size();
+  config_json["mutant_fitness"] = config.mutant_fitness;
+  config_json["start_node"] = config.start_node;
+  config_json["num_simulations"] = config.num_simulations;
+  config_json["max_steps"] = config.max_steps;
+  config_json["seed"] = config.seed;
+
+  std::string engine_str;
+  if (!ToString(config.engine, &engine_str)) {
+    engine_str = "unknown";
+  }
+  config_json["engine"] = engine_str;
+
+  std::string dynamic_str;
+  if (!ToString(config.dynamic, &dynamic_str)) {
+    dynamic_str = "unknown";
+  }
+  config_json["dynamic"] = dynamic_str;
+
+  auto& metadata_json = j["metadata"];
+  metadata_json["start_time_s"] = GetSeconds(metadata.start_time);
+  metadata_json["end_time_s"] = GetSeconds(metadata.end_time);
+  metadata_json["tag"] = metadata.tag;
+
+  FixationResult overall;
+  auto& results_json = j["results"];
+  for (const auto& node_result : results) {
+    auto result_json = FixationResultToJson(node_result.second);
+    result_json["start_node"] = node_result.first;
+    results_json.emplace_back(result_json);
+
+    MergeFixationResult(node_result.second, &overall);
+  }
+  j["overall"] = FixationResultToJson(overall);
+
+  AddProfile(serialisation_start, &j);
+  (*os) << j.dump(2);
+}
+
+void WriteSplittingToStream(const SplittingResult& result, const SplittingConfig& config, const MetaData& metadata,
+                            std::ostream* os) {
+  const auto serialisation_start = ProfileNow();
+  nlohmann::json j;
+  auto& config_json = j["config"];
+  config_json["graph_name"] = config.fixation.graph.name();
+  config_json["N"] = config.fixation.graph.size();
+  config_json["mutant_fitness"] = config.fixation.mutant_fitness;
+  config_json["start_node"] = config.fixation.start_node;
+  config_json["max_steps"] = config.fixation.max_steps;
+  config_json["seed"] = config.fixation.seed;
+  config_json["levels"] = config.levels;
+  config_json["clones_per_level"] = config.clones_per_level;
+  config_json["num_replications"] = config.num_replications;
+
+  std::string coordinate_str;
+  if (!ToString(config.coordinate, &coordinate_str)) {
+    coordinate_str = "unknown";
+  }
+  config_json["coordinate"] = coordinate_str;
+
+  std::string dynamic_str;
+  if (!ToString(config.fixation.dynamic, &dynamic_str)) {
+    dynamic_str = "unknown";
+  }
+  config_json["dynamic"] = dynamic_str;
+
+  auto& metadata_json = j["metadata"];
+  metadata_json["start_time_s"] = GetSeconds(metadata.start_time);
+  metadata_json["end_time_s"] = GetSeconds(metadata.end_time);
+  metadata_json["tag"] = metadata.tag;
+
+  auto& results_json = j["results"];
+  results_json["probability"] = result.probability;
+  results_json["stderr"] = result.standard_error;
+  results_json["lower"] = result.lower;
+  results_json["upper"] = result.upper;
+  results_json["level_probabilities"] = result.level_probabilities;
+  results_json["steps"] = result.steps;
+
+  AddProfile(serialisation_start, &j);
+  (*os) << j.dump(2);
+}
+
+void WriteTrajectoryToStream(
+  const TrajectorySummary& summary,
+  const SimulationConfig& config,
+  const std::string& spacing,
+  const MetaData& metadata,
+  std::ostream* os
+) {
+  const auto serialisation_start = ProfileNow();
+  nlohmann::json j;
+  auto& config_json = j["config"];
+  config_json["graph_name"] = config.graph.name();
+  config_json["birth_mutation_rate"] = config.birth_mutation_rate;
+  config_json["independent_mutation_rate"] = config.independent_mutation_rate;
+  config_json["N"] = config.graph.size();
+  config_json["num_steps"] = config.num_steps;
+  config_json["num_simulations"] = config.num_simulations;
+  config_json["start_with_max_diversity"] = config.start_with_max_diversity;
+  config_json["seed"] = config.seed;
+  config_json["spacing"] = spacing;
+  config_json["weighted"] = config.graph.weighted();
+
+  std::string dynamic_str;
+  if (!ToString(config.dynamic, &dynamic_str)) {
+    dynamic_str = "unknown";
+  }
+  config_json["dynamic"] = dynamic_str;
+
+  auto& metadata_json = j["metadata"];
+  metadata_json["start_time_s"] = GetSeconds(metadata.start_time);
+  metadata_json["end_time_s"] = GetSeconds(metadata.end_time);
+  metadata_json["tag"] = metadata.tag;
+
+  // One column per statistic, one row per checkpoint.
+  j["step"] = summary.checkpoints;
+  auto& results_json = j["results"];
+  for (int s = 0; s < static_cast<int>(summary.series.size()); ++s) {
+    nlohmann::json series_json;
+    series_json["measure"] = summary.series[s];
+    for (int c = 0; c < static_cast<int>(summary.checkpoints.size()); ++c) {
+      const auto& moments = summary.moments[c][s];
+      const auto& quantiles = summary.quantiles[c][s];
+      series_json["count"].emplace_back(moments.count());
+      series_json["mean"].emplace_back(moments.mean());
+      series_json["stddev"].emplace_back(std::sqrt(moments.variance()));
+      series_json["p05"].emplace_back(quantiles.Quantile(0.05));
+      series_json["p25"].emplace_back(quantiles.Quantile(0.25));
+      series_json["p50"].emplace_back(quantiles.Quantile(0.5));
+      series_json["p75"].emplace_back(quantiles.Quantile(0.75));
+      series_json["p95"].emplace_back(quantiles.Quantile(0.95));
+    }
+    results_json.emplace_back(series_json);
+  }
+
+  AddProfile(serialisation_start, &j);
+  (*os) << j.dump(2);
+}
+
+void WriteTrendsToStream(
+    const std::string& graph_name,
+    const int N,
+    const double exp_sample_rate,
+    const Trends& trends,
+    const SimulationConfig& config,
+    const MetaData& metadata,
+    std::ostream* os
+) {
+  WriteTrendsToStream(graph_name, N, exp_sample_rate, trends, TrendSummaries(), config, metadata, os);
+}
+
 void WriteTrendsToStream(
     const std::string& graph_name,
     const int N,
     const double exp_sample_rate,
     const Trends& trends,
+    const TrendSummaries& summaries,
     const SimulationConfig& config,
     const MetaData& metadata,
     std::ostream* os
 ) {
+  const auto serialisation_start = ProfileNow();
   nlohmann::json j;
   auto& config_json = j["config"];
   config_json["graph_name"] = graph_name;
   config_json["N"] = N;
   config_json["num_simulations"] = config.num_simulations;
   config_json["exp_sample_rate"] = exp_sample_rate;
+  config_json["seed"] = config.seed;
+  config_json["weighted"] = config.graph.weighted();
+
+  std::string engine_str;
+  if (!ToString(config.engine, &engine_str)) {
+    engine_str = "unknown";
+  }
+  config_json["engine"] = engine_str;
 
   std::string dynamic_str;
   if (!ToString(config.dynamic, &dynamic_str)) {
@@ -67,7 +315,10 @@ void WriteTrendsToStream(
   metadata_json["end_time_s"] = GetSeconds(metadata.end_time);
   metadata_json["tag"] = metadata.tag;
 
+  config_json["summary"] = !summaries.empty();
+
   auto& results_json = j["results"];
+  results_json = nlohmann::json::array();
 
   for (const auto& trend : trends) {
     nlohmann::json result_json;
@@ -75,6 +326,34 @@ void WriteTrendsToStream(
     result_json["times"] = trend.second;
     results_json.emplace_back(result_json);
   }
+
+  auto& summaries_json = j["summaries"];
+  summaries_json = nlohmann::json::array();
+  for (const auto& n_summary : summaries) {
+    const auto& summary = n_summary.second;
+    nlohmann::json summary_json;
+    summary_json["n"] = n_summary.first;
+    summary_json["count"] = summary.moments.count();
+    summary_json["mean"] = summary.moments.mean();
+    summary_json["stddev"] = std::sqrt(summary.moments.variance());
+    for (const double q : {0.01, 0.05, 0.25, 0.5, 0.75, 0.95, 0.99}) {
+      std::ostringstream key;
+      key << "p" << std::setw(2) << std::setfill('0') << static_cast<int>(std::lround(q * 100));
+      summary_json["quantiles"][key.str()] = summary.quantiles.Quantile(q);
+    }
+    auto& histogram_json = summary_json["histogram"];
+    histogram_json = nlohmann::json::array();
+    if (summary.histogram.underflow() > 0) {
+      histogram_json.push_back({{"lower", 0}, {"upper", 1}, {"count", summary.histogram.underflow()}});
+    }
+    for (const auto& bucket : summary.histogram.buckets()) {
+      histogram_json.push_back({{"lower", summary.histogram.lower(bucket.first)},
+                                {"upper", summary.histogram.upper(bucket.first)},
+                                {"count", bucket.second}});
+    }
+    summaries_json.emplace_back(summary_json);
+  }
+  AddProfile(serialisation_start, &j);
   (*os) << j;
 }
 
@@ -84,6 +363,7 @@ void WriteSimulationHistoryToStream(
   const MetaData& metadata,
   std::ostream* os
 ) {
+  const auto serialisation_start = ProfileNow();
   nlohmann::json j;
   auto& config_json = j["config"];
   config_json["graph_name"] = config.graph.name();
@@ -95,6 +375,11 @@ void WriteSimulationHistoryToStream(
   config_json["sample_rate"] = config.history_sample_rate;
   config_json["start_with_max_diversity"] = config.start_with_max_diversity;
   config_json["run_until_homogeneous"] = config.run_until_homogeneous;
+  config_json["seed"] = config.seed;
+  config_json["node_rates"] = HasUniformRates(config.node_rates) ? "uniform" : "heterogeneous";
+  config_json["continuous_time"] = config.continuous_time;
+  config_json["weighted"] = config.graph.weighted();
+  config_json["track_genealogy"] = config.track_genealogy;
 
   std::string dynamic_str;
   if (!ToString(config.dynamic, &dynamic_str)) {
@@ -117,20 +402,35 @@ void WriteSimulationHistoryToStream(
       nlohmann::json time_slice;
       time_slice["step_num"] = step_num * config.history_sample_rate;
       time_slice["location_to_type"] = history.location_to_types[step_num];
+      if (config.continuous_time) time_slice["time"] = history.times[step_num];
       simulation_history_json.emplace_back(time_slice);
     }
 
-    auto& ancestry_json = result_json["ancestry"];
-    for (int child_type = 0; child_type < history.ancestry.size();
-         ++child_type) {
-      nlohmann::json parent_child;
-      parent_child["child"] = child_type;
-      parent_child["parent"] = history.ancestry[child_type];
-      ancestry_json.emplace_back(parent_child);
+    if (config.track_genealogy) {
+      auto& genealogy_json = result_json["genealogy"];
+      for (const auto& node : history.genealogy) {
+        nlohmann::json node_json;
+        node_json["type"] = node.type;
+        node_json["parent"] = node.parent;
+        node_json["birth_step"] = node.birth_step;
+        node_json["abundance"] = node.abundance;
+        genealogy_json.emplace_back(node_json);
+      }
+      result_json["time_to_mrca"] = history.time_to_mrca;
+    } else {
+      auto& ancestry_json = result_json["ancestry"];
+      for (int child_type = 0; child_type < static_cast<int>(history.ancestry.size());
+           ++child_type) {
+        nlohmann::json parent_child;
+        parent_child["child"] = child_type;
+        parent_child["parent"] = history.ancestry[child_type];
+        ancestry_json.emplace_back(parent_child);
+      }
     }
 
     results_json.emplace_back(result_json);
   }
+  AddProfile(serialisation_start, &j);
   (*os) << j;
 }
 
@@ -140,6 +440,17 @@ void WriteDiversityCountsToStream(
   const MetaData& metadata,
   std::ostream* os
 ) {
+  WriteDiversityCountsToStream(diversity_counts, MeasureSummaries(), config, metadata, os);
+}
+
+void WriteDiversityCountsToStream(
+  const DiversityCounts& diversity_counts,
+  const MeasureSummaries& measure_summaries,
+  const SimulationConfig& config,
+  const MetaData& metadata,
+  std::ostream* os
+) {
+  const auto serialisation_start = ProfileNow();
   nlohmann::json j;
   auto& config_json = j["config"];
   config_json["graph_name"] = config.graph.name();
@@ -150,6 +461,13 @@ void WriteDiversityCountsToStream(
   config_json["num_simulations"] = config.num_simulations;
   config_json["start_with_max_diversity"] = config.start_with_max_diversity;
   config_json["run_until_homogeneous"] = config.run_until_homogeneous;
+  config_json["seed"] = config.seed;
+  config_json["node_rates"] = HasUniformRates(config.node_rates) ? "uniform" : "heterogeneous";
+  config_json["continuous_time"] = config.continuous_time;
+  config_json["weighted"] = config.graph.weighted();
+  auto& measures_config_json = config_json["measures"];
+  measures_config_json = nlohmann::json::array();
+  for (const auto& measure : config.measures) measures_config_json.emplace_back(measure->name());
 
   std::string dynamic_str;
   if (!ToString(config.dynamic, &dynamic_str)) {
@@ -162,6 +480,24 @@ void WriteDiversityCountsToStream(
   metadata_json["end_time_s"] = GetSeconds(metadata.end_time);
   metadata_json["tag"] = metadata.tag;
 
+  // Means and standard deviations across trials, per value of the measure.
+  if (!measure_summaries.empty()) {
+    auto& measures_json = j["measures"];
+    for (const auto& entry : measure_summaries) {
+      nlohmann::json measure_json;
+      measure_json["measure"] = entry.first;
+      for (const auto& moments : entry.second.final) {
+        measure_json["final_mean"].emplace_back(moments.mean());
+        measure_json["final_stddev"].emplace_back(std::sqrt(moments.variance()));
+      }
+      for (const auto& moments : entry.second.time_average) {
+        measure_json["time_average_mean"].emplace_back(moments.mean());
+        measure_json["time_average_stddev"].emplace_back(std::sqrt(moments.variance()));
+      }
+      measures_json.emplace_back(measure_json);
+    }
+  }
+
   auto& results_json = j["results"];
   for (const auto& measure_counts : diversity_counts) {
     nlohmann::json diversity_count_json;
@@ -183,6 +519,67 @@ void WriteDiversityCountsToStream(
     results_json.emplace_back(diversity_count_json);
   }
 
+  AddProfile(serialisation_start, &j);
+  (*os) << j.dump(2);
+}
+
+void WriteSweepToStream(const SweepResults& results, const SimulationConfig& config, const MetaData& metadata,
+                        std::ostream* os) {
+  const auto serialisation_start = ProfileNow();
+  nlohmann::json j;
+  auto& config_json = j["config"];
+  config_json["graph_name"] = config.graph.name();
+  config_json["birth_mutation_rate"] = config.birth_mutation_rate;
+  config_json["independent_mutation_rate"] = config.independent_mutation_rate;
+  config_json["N"] = config.graph.size();
+  config_json["num_steps"] = config.num_steps;
+  config_json["num_simulations"] = config.num_simulations;
+  config_json["start_with_max_diversity"] = config.start_with_max_diversity;
+  config_json["seed"] = config.seed;
+  config_json["common_random_numbers"] = config.common_random_numbers;
+  config_json["sweep_parameter"] = results.parameter;
+  config_json["sweep_values"] = results.values;
+
+  std::string dynamic_str;
+  if (!ToString(config.dynamic, &dynamic_str)) {
+    dynamic_str = "unknown";
+  }
+  config_json["dynamic"] = dynamic_str;
+
+  auto& metadata_json = j["metadata"];
+  metadata_json["start_time_s"] = GetSeconds(metadata.start_time);
+  metadata_json["end_time_s"] = GetSeconds(metadata.end_time);
+  metadata_json["tag"] = metadata.tag;
+
+  // Per value: the mean of each measure, and its paired difference from the
+  // first value.
+  auto& results_json = j["results"];
+  for (int p = 0; p < static_cast<int>(results.values.size()); ++p) {
+    nlohmann::json point_json;
+    point_json["value"] = results.values[p];
+    for (const auto& samples : results.samples[p]) {
+      std::string measure_str;
+      if (!ToString(samples.first, &measure_str)) {
+        measure_str = "unknown";
+      }
+      RunningMoments moments;
+      for (const auto& sample : samples.second) moments.Add(sample);
+      nlohmann::json measure_json;
+      measure_json["mean"] = moments.mean();
+      measure_json["variance"] = moments.variance();
+      if (p > 0) {
+        const auto& difference = results.differences[p].at(samples.first);
+        measure_json["difference_mean"] = difference.mean;
+        measure_json["difference_variance"] = difference.variance;
+        measure_json["difference_stderr"] = difference.standard_error;
+        measure_json["unpaired_stderr"] = difference.unpaired_standard_error;
+      }
+      point_json["measures"][measure_str] = measure_json;
+    }
+    results_json.emplace_back(point_json);
+  }
+
+  AddProfile(serialisation_start, &j);
   (*os) << j.dump(2);
 }
 
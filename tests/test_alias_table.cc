@@ -0,0 +1,49 @@
+#include <cmath>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <equilibrium/alias_table.h>
+
+namespace {
+
+// Fraction of a fine grid of u that lands on each index.
+std::vector<double> Frequencies(const equilibrium::AliasTable& table, int row) {
+  const int grid = 1 << 16;
+  std::vector<double> frequencies(table.row_size(row), 0.);
+  for (int k = 0; k < grid; ++k) {
+    frequencies[table.Sample(row, (k + 0.5) / grid)] += 1. / grid;
+  }
+  return frequencies;
+}
+
+}  // namespace
+
+TEST_CASE("rows are sampled proportionally to their weights", "[AliasTable]") {
+  const equilibrium::AliasTable table({{1., 2., 3., 2.}, {5.}, {0.25, 0.75}});
+  REQUIRE(table.num_rows() == 3);
+
+  const auto first = Frequencies(table, 0);
+  const std::vector<double> expected = {0.125, 0.25, 0.375, 0.25};
+  for (int i = 0; i < static_cast<int>(expected.size()); ++i) {
+    REQUIRE(first[i] > expected[i] - 1e-3);
+    REQUIRE(first[i] < expected[i] + 1e-3);
+  }
+  REQUIRE(std::fabs(Frequencies(table, 1)[0] - 1.) < 1e-12);
+  REQUIRE(Frequencies(table, 2)[1] > 0.749);
+  REQUIRE(Frequencies(table, 2)[1] < 0.751);
+}
+
+TEST_CASE("zero weights are never sampled", "[AliasTable]") {
+  const equilibrium::AliasTable table({{0., 1., 0., 1.}, {}, {0., 0., 3.}});
+  REQUIRE(table.row_size(1) == 0);
+  const auto first = Frequencies(table, 0);
+  REQUIRE(std::fabs(first[0]) < 1e-12);
+  REQUIRE(std::fabs(first[2]) < 1e-12);
+  REQUIRE(std::fabs(Frequencies(table, 2)[2] - 1.) < 1e-12);
+}
+
+TEST_CASE("rows of zero weights sample -1", "[AliasTable]") {
+  const equilibrium::AliasTable table({{0., 0.}, {1., 0.}});
+  for (const double u : {0., 0.3, 0.6, 0.999}) REQUIRE(table.Sample(0, u) == -1);
+  REQUIRE(table.Sample(1, 0.6) == 0);
+}
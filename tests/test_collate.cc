@@ -0,0 +1,69 @@
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <equilibrium/collate.h>
+
+namespace {
+
+const char* kResult = R"({
+  "config": {
+    "N": 10,
+    "birth_mutation_rate": 0.05,
+    "dynamic": "birth-death",
+    "graph_name": "complete",
+    "independent_mutation_rate": 0.0,
+    "num_simulations": 40,
+    "num_steps": 500,
+    "run_until_homogeneous": false
+  },
+  "metadata": {"end_time_s": 12, "start_time_s": 11, "tag": "sweep"},
+  "results": [
+    {"diversity_counts": [{"count": 9, "diversity": 1}, {"count": 31, "diversity": 2}],
+     "diversity_measure": "number_of_types"},
+    {"diversity_measure": "unmatching_pairs",
+     "diversity_counts": [{"diversity": 0, "count": 40}]}
+  ],
+  "measures": {"shannon": {"mean": 0.5}}
+})";
+
+}  // namespace
+
+TEST_CASE("collates one row per measure and diversity", "[Collate]") {
+  std::istringstream is(kResult);
+  std::vector<equilibrium::CsvRow> rows;
+  REQUIRE(equilibrium::CollateDiversityCounts(&is, "sweep", &rows));
+  REQUIRE(rows.size() == 3);
+
+  const equilibrium::CsvRow expected = {
+    "sweep", "11", "12", "10", "complete", "40", "500", "0.05", "0.0", "number_of_types", "birth-death", "1", "9",
+  };
+  REQUIRE(rows[0] == expected);
+  REQUIRE(rows[1][11] == "2");
+  REQUIRE(rows[1][12] == "31");
+  // diversity_measure may come before or after the counts.
+  REQUIRE(rows[2][9] == "unmatching_pairs");
+  REQUIRE(rows[2][12] == "40");
+}
+
+TEST_CASE("skips other tags and untagged results", "[Collate]") {
+  std::vector<equilibrium::CsvRow> rows;
+  std::istringstream other(kResult);
+  REQUIRE(equilibrium::CollateDiversityCounts(&other, "other", &rows));
+  REQUIRE(rows.empty());
+
+  std::istringstream untagged(R"({"config": {"N": 3}, "metadata": {},
+    "results": [{"diversity_measure": "x", "diversity_counts": [{"diversity": 1, "count": 1}]}]})");
+  REQUIRE(equilibrium::CollateDiversityCounts(&untagged, "", &rows));
+  REQUIRE(rows.empty());
+
+  std::istringstream malformed(R"({"metadata": {"tag": "sweep"}, "results": [)");
+  REQUIRE_FALSE(equilibrium::CollateDiversityCounts(&malformed, "sweep", &rows));
+}
+
+TEST_CASE("writes RFC 4180 rows", "[Collate]") {
+  std::ostringstream os;
+  equilibrium::WriteCsvRow({"plain", "a,b", "say \"hi\"", ""}, &os);
+  REQUIRE(os.str() == "plain,\"a,b\",\"say \"\"hi\"\"\",\r\n");
+}
@@ -0,0 +1,53 @@
+#ifndef EQUILIBRIUM_TESTS_TEST_CONFIGS_H_
+#define EQUILIBRIUM_TESTS_TEST_CONFIGS_H_
+
+// Configs shared by the tests. Each test sets only the fields it varies.
+
+#include <map>
+
+#include <equilibrium/graph.h>
+#include <equilibrium/simulation.h>
+
+namespace equilibrium_test {
+
+/// Runs from maximal diversity until one type is left, without mutation.
+inline equilibrium::SimulationConfig AbsorptionConfig(const equilibrium::Graph& graph,
+                                                      equilibrium::Dynamic dynamic) {
+  equilibrium::SimulationConfig config;
+  config.birth_mutation_rate = 0;
+  config.independent_mutation_rate = 0;
+  config.num_steps = 0;
+  config.num_simulations = 1;
+  config.dynamic = dynamic;
+  config.graph = graph;
+  config.capture_history = false;
+  config.history_sample_rate = 1;
+  config.compute_stats = true;
+  config.start_with_max_diversity = true;
+  config.run_until_homogeneous = true;
+  config.seed = 4;
+  return config;
+}
+
+/// Runs num_steps steps from a single type instead.
+inline equilibrium::SimulationConfig FixedStepsConfig(const equilibrium::Graph& graph,
+                                                      equilibrium::Dynamic dynamic, int num_steps) {
+  auto config = AbsorptionConfig(graph, dynamic);
+  config.num_steps = num_steps;
+  config.start_with_max_diversity = false;
+  config.run_until_homogeneous = false;
+  return config;
+}
+
+/// Mean absorption time of the first config over num_trials trials.
+inline double MeanTime(const std::map<int, equilibrium::SimulationConfig>& configs, int num_trials) {
+  equilibrium::Trends trends;
+  equilibrium::ComputeTrends(configs, 0, num_trials, &trends);
+  double sum = 0;
+  for (const auto& time : trends.begin()->second) sum += static_cast<double>(time);
+  return sum / num_trials;
+}
+
+} // namespace equilibrium_test
+
+#endif // EQUILIBRIUM_TESTS_TEST_CONFIGS_H_
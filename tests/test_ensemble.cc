@@ -0,0 +1,68 @@
+#include <cmath>
+#include <map>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <equilibrium/ensemble.h>
+#include <equilibrium/graph.h>
+#include <equilibrium/simulation.h>
+
+#include "test_configs.h"
+
+namespace {
+
+equilibrium::SimulationConfig MakeConfig(const equilibrium::Graph& graph, equilibrium::Dynamic dynamic) {
+  auto config = equilibrium_test::AbsorptionConfig(graph, dynamic);
+  config.engine = equilibrium::SimulationEngine::ENSEMBLE;
+  return config;
+}
+
+}  // namespace
+
+TEST_CASE("only plain absorption runs are supported", "[SupportsEnsemble]") {
+  auto config = MakeConfig(equilibrium::CompleteGraph(5), equilibrium::Dynamic::BIRTH_DEATH);
+  REQUIRE(equilibrium::SupportsEnsemble(config));
+  config.birth_mutation_rate = 0.1;
+  REQUIRE_FALSE(equilibrium::SupportsEnsemble(config));
+  config.birth_mutation_rate = 0;
+  config.run_until_homogeneous = false;
+  REQUIRE_FALSE(equilibrium::SupportsEnsemble(config));
+  config.run_until_homogeneous = true;
+  config.node_rates = {1, 1, 1, 1, 2};
+  REQUIRE_FALSE(equilibrium::SupportsEnsemble(config));
+}
+
+TEST_CASE("ensemble trials do not depend on the trial range", "[ComputeTrends]") {
+  std::map<int, equilibrium::SimulationConfig> configs;
+  for (int n : {3, 7}) configs[n] = MakeConfig(equilibrium::CycleGraph(n), equilibrium::Dynamic::DEATH_BIRTH);
+
+  equilibrium::Trends all;
+  equilibrium::ComputeTrends(configs, 0, 3000, &all);
+  equilibrium::Trends tail;
+  equilibrium::ComputeTrends(configs, 1000, 3000, &tail);
+  for (const auto& trend : tail) {
+    REQUIRE(std::vector<long long>(all[trend.first].begin() + 1000, all[trend.first].end()) == trend.second);
+  }
+
+  // Homogeneous from the start.
+  configs[7].start_with_max_diversity = false;
+  equilibrium::Trends homogeneous;
+  equilibrium::ComputeTrends(configs, 0, 10, &homogeneous);
+  REQUIRE(homogeneous[7] == std::vector<long long>(10, 0));
+}
+
+TEST_CASE("ensemble absorption times match Simulate", "[ComputeTrends]") {
+  const int num_trials = 20000;
+  for (const auto& dynamic : {equilibrium::Dynamic::BIRTH_DEATH, equilibrium::Dynamic::DEATH_BIRTH}) {
+    for (const auto& graph : {equilibrium::CompleteGraph(6), equilibrium::StarGraph(6)}) {
+      std::map<int, equilibrium::SimulationConfig> ensemble = {{6, MakeConfig(graph, dynamic)}};
+      auto scalar = ensemble;
+      scalar[6].engine = equilibrium::SimulationEngine::SCALAR;
+
+      const double ensemble_mean = equilibrium_test::MeanTime(ensemble, num_trials);
+      const double scalar_mean = equilibrium_test::MeanTime(scalar, num_trials);
+      // Both standard errors are well under 1% of the mean here.
+      REQUIRE(std::fabs(ensemble_mean - scalar_mean) < 0.04 * scalar_mean);
+    }
+  }
+}
@@ -1,7 +1,13 @@
+#include <cmath>
 #include <iostream>
+#include <map>
+#include <sstream>
 #include <vector>
 
 #include <catch2/catch_test_macros.hpp>
+#include <equilibrium/distributed.h>
+#include <equilibrium/profile.h>
+#include <equilibrium/random.h>
 #include <equilibrium/simulation.h>
 #include <equilibrium/graph.h>
 
@@ -215,3 +221,406 @@ TEST_CASE("barbell", "[BarbellGraph]") {
   REQUIRE(graph.out_edges() == expected);
 }
 
+
+TEST_CASE("edge weights follow the edges", "[ReadEdgeWeights]") {
+  auto graph = equilibrium::DirectedLineGraph(3);
+  REQUIRE_FALSE(graph.weighted());
+  std::istringstream weights("1 2 0.5\n");
+  REQUIRE(equilibrium::ReadEdgeWeights(&weights, &graph));
+  REQUIRE(graph.weighted());
+  REQUIRE(graph.out_weights() == std::vector<std::vector<double>>{{1.}, {0.5}, {}});
+  REQUIRE(graph.in_weights() == std::vector<std::vector<double>>{{}, {1.}, {0.5}});
+
+  std::istringstream missing_edge("2 1 1");
+  REQUIRE_FALSE(equilibrium::ReadEdgeWeights(&missing_edge, &graph));
+}
+
+TEST_CASE("trial ranges cover all trials", "[GetTrialRange]") {
+  for (int num_ranks = 1; num_ranks <= 7; ++num_ranks) {
+    int next = 0;
+    for (int rank = 0; rank < num_ranks; ++rank) {
+      const auto range = equilibrium::GetTrialRange(10, rank, num_ranks);
+      REQUIRE(range.first == next);
+      REQUIRE(range.last - range.first >= 10 / num_ranks);
+      REQUIRE(range.last - range.first <= 10 / num_ranks + 1);
+      next = range.last;
+    }
+    REQUIRE(next == 10);
+  }
+}
+
+TEST_CASE("diversity counts round trip", "[FlattenDiversityCounts]") {
+  equilibrium::DiversityCounts counts;
+  counts[equilibrium::DiversityMeasure::NUMBER_OF_TYPES][3] = 4;
+  counts[equilibrium::DiversityMeasure::NUMBER_OF_UNMATCHING_LINKS][7] = 1;
+  std::vector<int> flat;
+  equilibrium::FlattenDiversityCounts(counts, &flat);
+
+  equilibrium::DiversityCounts decoded;
+  REQUIRE(equilibrium::UnflattenDiversityCounts(flat, &decoded));
+  REQUIRE(decoded == counts);
+}
+
+TEST_CASE("trends round trip keeps rank order", "[FlattenTrends]") {
+  const equilibrium::Trends first = {{2, {1, 2}}, {3, {5}}};
+  const equilibrium::Trends second = {{2, {3}}, {3, {6, 7}}};
+  std::vector<long long> flat_first, flat_second;
+  equilibrium::FlattenTrends(first, &flat_first);
+  equilibrium::FlattenTrends(second, &flat_second);
+
+  equilibrium::Trends decoded;
+  REQUIRE(equilibrium::UnflattenTrends(flat_first, &decoded));
+  REQUIRE(equilibrium::UnflattenTrends(flat_second, &decoded));
+  const equilibrium::Trends expected = {{2, {1, 2, 3}}, {3, {5, 6, 7}}};
+  REQUIRE(decoded == expected);
+}
+
+TEST_CASE("seeded counts do not depend on the number of ranks", "[ComputeDiversityCounts]") {
+  equilibrium::SimulationConfig config;
+  config.birth_mutation_rate = 0.05;
+  config.independent_mutation_rate = 0;
+  config.num_steps = 200;
+  config.num_simulations = 20;
+  config.dynamic = equilibrium::Dynamic::BIRTH_DEATH;
+  config.graph = equilibrium::CycleGraph(10);
+  config.capture_history = false;
+  config.compute_stats = true;
+  config.start_with_max_diversity = false;
+  config.run_until_homogeneous = false;
+  config.seed = 7;
+
+  equilibrium::DiversityCounts single;
+  equilibrium::ComputeDiversityCounts(config, &single);
+
+  equilibrium::DiversityCounts merged;
+  for (int rank = 0; rank < 3; ++rank) {
+    const auto range = equilibrium::GetTrialRange(config.num_simulations, rank, 3);
+    equilibrium::DiversityCounts local;
+    equilibrium::ComputeDiversityCounts(config, range.first, range.last, &local);
+    equilibrium::MergeDiversityCounts(local, &merged);
+  }
+  REQUIRE(merged == single);
+}
+
+TEST_CASE("profile counts steps only when compiled in", "[Profile]") {
+  equilibrium::SimulationConfig config;
+  config.birth_mutation_rate = 0.5;
+  config.independent_mutation_rate = 0;
+  config.num_steps = 100;
+  config.num_simulations = 1;
+  config.dynamic = equilibrium::Dynamic::DEATH_BIRTH;
+  config.graph = equilibrium::CompleteGraph(5);
+  config.capture_history = false;
+  config.compute_stats = false;
+  config.start_with_max_diversity = false;
+  config.run_until_homogeneous = false;
+  config.seed = 1;
+
+  equilibrium::ResetProfiles();
+  equilibrium::Simulate(config, 0, nullptr, nullptr);
+
+  std::vector<equilibrium::Profile> profiles;
+  equilibrium::CollectProfiles(&profiles);
+  equilibrium::Profile total;
+  for (const auto& profile : profiles) equilibrium::MergeProfile(profile, &total);
+
+  if (equilibrium::kProfile) {
+    REQUIRE(total.trials == 1);
+    REQUIRE(total.steps == 100);
+    REQUIRE(total.mutations > 0);
+    REQUIRE(total.effective_steps >= total.mutations);
+    REQUIRE(total.rng_draws >= 4 * total.steps);
+  } else {
+    REQUIRE(total.steps == 0);
+  }
+}
+
+TEST_CASE("profile counts each effective step once", "[Profile]") {
+  if (!equilibrium::kProfile) return;
+
+  equilibrium::SimulationConfig config;
+  config.birth_mutation_rate = 0;
+  config.independent_mutation_rate = 0;
+  config.num_steps = 10;
+  config.num_simulations = 1;
+  config.dynamic = equilibrium::Dynamic::BIRTH_DEATH;
+  config.graph = equilibrium::CompleteGraph(2);
+  config.capture_history = false;
+  config.compute_stats = false;
+  config.start_with_max_diversity = true;
+  config.run_until_homogeneous = false;
+  config.seed = 1;
+
+  const auto effective_steps = [&config]() {
+    equilibrium::ResetProfiles();
+    equilibrium::Simulate(config, 0, nullptr, nullptr);
+    std::vector<equilibrium::Profile> profiles;
+    equilibrium::CollectProfiles(&profiles);
+    equilibrium::Profile total;
+    for (const auto& profile : profiles) equilibrium::MergeProfile(profile, &total);
+    return total.effective_steps;
+  };
+
+  // Two distinct types: the first copy makes them equal, and no later copy
+  // changes anything.
+  REQUIRE(effective_steps() == 1);
+
+  // Every birth mutates, whether or not the copy changed the dier's type.
+  config.birth_mutation_rate = 1;
+  REQUIRE(effective_steps() == 10);
+
+  // A step that both copies and mutates still counts once.
+  config.independent_mutation_rate = 1;
+  REQUIRE(effective_steps() == 10);
+
+  config.birth_mutation_rate = 0;
+  REQUIRE(effective_steps() == 10);
+}
+
+TEST_CASE("uniform rates leave the trajectory unchanged", "[ContinuousTime]") {
+  equilibrium::SimulationConfig config;
+  config.birth_mutation_rate = 0.1;
+  config.independent_mutation_rate = 0.01;
+  config.num_steps = 500;
+  config.num_simulations = 1;
+  config.dynamic = equilibrium::Dynamic::BIRTH_DEATH;
+  config.graph = equilibrium::StarGraph(8);
+  config.capture_history = false;
+  config.compute_stats = true;
+  config.start_with_max_diversity = true;
+  config.run_until_homogeneous = false;
+  config.seed = 3;
+
+  equilibrium::Stats discrete;
+  equilibrium::Simulate(config, 0, &discrete, nullptr);
+
+  config.node_rates.assign(config.graph.size(), 2.);
+  config.continuous_time = true;
+  equilibrium::Stats continuous;
+  equilibrium::Simulate(config, 0, &continuous, nullptr);
+
+  REQUIRE(continuous.number_of_types == discrete.number_of_types);
+  REQUIRE(continuous.number_of_unmatching_pairs == discrete.number_of_unmatching_pairs);
+  REQUIRE(continuous.number_of_steps == discrete.number_of_steps);
+  // Each step waits Exp(2N), so 500 steps take about 500 / 16.
+  REQUIRE(continuous.time > 500. / 16 * 0.7);
+  REQUIRE(continuous.time < 500. / 16 * 1.3);
+}
+
+TEST_CASE("a location with rate 0 never reproduces", "[ContinuousTime]") {
+  equilibrium::SimulationConfig config;
+  config.birth_mutation_rate = 1;
+  config.independent_mutation_rate = 0;
+  config.num_steps = 50;
+  config.num_simulations = 1;
+  config.dynamic = equilibrium::Dynamic::BIRTH_DEATH;
+  config.graph = equilibrium::LineGraph(3);
+  config.capture_history = true;
+  config.history_sample_rate = 1;
+  config.compute_stats = false;
+  config.start_with_max_diversity = false;
+  config.run_until_homogeneous = false;
+  config.seed = 5;
+  config.node_rates = {1., 0., 0.};
+  config.continuous_time = true;
+
+  equilibrium::SimulationHistory history;
+  equilibrium::Simulate(config, 0, nullptr, &history);
+
+  REQUIRE(history.times.size() == history.location_to_types.size());
+  for (int i = 0; i < static_cast<int>(history.location_to_types.size()); ++i) {
+    REQUIRE(history.location_to_types[i][0] == 0);
+    REQUIRE(history.location_to_types[i][2] == 0);
+    if (i > 0) REQUIRE(history.times[i] > history.times[i-1]);
+  }
+  // Every step is a birth from 0 into 1 with a new type.
+  REQUIRE(history.location_to_types.back()[1] == config.num_steps);
+}
+
+TEST_CASE("node rates are read one per location", "[ReadNodeRates]") {
+  std::vector<double> rates;
+  std::istringstream good("1 2.5\n0\n");
+  REQUIRE(equilibrium::ReadNodeRates(&good, 3, &rates));
+  REQUIRE(rates == std::vector<double>{1., 2.5, 0.});
+  std::istringstream short_input("1 2");
+  REQUIRE_FALSE(equilibrium::ReadNodeRates(&short_input, 3, &rates));
+  std::istringstream negative("1 -2 1");
+  REQUIRE_FALSE(equilibrium::ReadNodeRates(&negative, 3, &rates));
+  std::istringstream all_zero("0 0 0");
+  REQUIRE_FALSE(equilibrium::ReadNodeRates(&all_zero, 3, &rates));
+  REQUIRE(equilibrium::ValidNodeRates({0, 1}, 2));
+  REQUIRE_FALSE(equilibrium::ValidNodeRates({0, 1}, 3));
+}
+
+TEST_CASE("zero-weight edges are never used", "[Weighted]") {
+  equilibrium::SimulationConfig config;
+  config.birth_mutation_rate = 1;
+  config.independent_mutation_rate = 0;
+  config.num_steps = 100;
+  config.num_simulations = 1;
+  config.dynamic = equilibrium::Dynamic::BIRTH_DEATH;
+  // Only i -> i+1 (mod 3) has weight.
+  config.graph = equilibrium::Graph(3, "weighted", {{1, 2}, {0, 2}, {0, 1}}, {{1., 0.}, {0., 1.}, {1., 0.}});
+  config.capture_history = true;
+  config.history_sample_rate = 1;
+  config.compute_stats = false;
+  config.start_with_max_diversity = false;
+  config.run_until_homogeneous = false;
+  config.seed = 9;
+
+  equilibrium::SimulationHistory history;
+  equilibrium::Simulate(config, 0, nullptr, &history);
+
+  REQUIRE(static_cast<int>(history.location_to_types.size()) == config.num_steps + 1);
+  for (int step = 1; step < static_cast<int>(history.location_to_types.size()); ++step) {
+    const auto& before = history.location_to_types[step-1];
+    const auto& after = history.location_to_types[step];
+    for (int dier = 0; dier < 3; ++dier) {
+      if (after[dier] == before[dier]) continue;
+      REQUIRE(history.ancestry[after[dier]] == before[(dier + 2) % 3]);
+    }
+  }
+}
+
+TEST_CASE("locations whose edges all have weight 0 never reproduce", "[Weighted]") {
+  equilibrium::SimulationConfig config;
+  config.birth_mutation_rate = 1;
+  config.independent_mutation_rate = 0;
+  config.num_steps = 200;
+  config.num_simulations = 1;
+  config.dynamic = equilibrium::Dynamic::BIRTH_DEATH;
+  config.graph = equilibrium::Graph(3, "weighted", {{1, 2}, {0, 2}, {0, 1}}, {{0., 0.}, {1., 1.}, {1., 1.}});
+  config.capture_history = true;
+  config.history_sample_rate = 1;
+  config.compute_stats = false;
+  // Every birth mutates, so types stay distinct and name their location.
+  config.start_with_max_diversity = true;
+  config.run_until_homogeneous = false;
+  config.seed = 4;
+
+  equilibrium::SimulationHistory history;
+  equilibrium::Simulate(config, 0, nullptr, &history);
+
+  int births = 0;
+  for (int step = 1; step < static_cast<int>(history.location_to_types.size()); ++step) {
+    const auto& before = history.location_to_types[step-1];
+    const auto& after = history.location_to_types[step];
+    for (int dier = 0; dier < 3; ++dier) {
+      if (after[dier] == before[dier]) continue;
+      ++births;
+      REQUIRE(history.ancestry[after[dier]] != before[0]);
+    }
+  }
+  REQUIRE(births > 0);
+}
+
+TEST_CASE("trend summaries agree with the raw times", "[ComputeTrends]") {
+  std::map<int, equilibrium::SimulationConfig> configs;
+  for (int n : {4, 8}) {
+    equilibrium::SimulationConfig config;
+    config.birth_mutation_rate = 0;
+    config.independent_mutation_rate = 0;
+    config.num_steps = 0;
+    config.num_simulations = 50;
+    config.dynamic = equilibrium::Dynamic::BIRTH_DEATH;
+    config.graph = equilibrium::CompleteGraph(n);
+    config.capture_history = false;
+    config.compute_stats = true;
+    config.start_with_max_diversity = true;
+    config.run_until_homogeneous = true;
+    config.seed = 6;
+    configs[n] = config;
+  }
+
+  equilibrium::Trends trends;
+  equilibrium::TrendSummaries summaries;
+  equilibrium::ComputeTrends(configs, 0, 50, &trends, &summaries);
+  equilibrium::TrendSummaries summaries_only;
+  equilibrium::ComputeTrends(configs, 0, 50, nullptr, &summaries_only);
+
+  for (const auto& trend : trends) {
+    double sum = 0;
+    for (const auto& time : trend.second) sum += static_cast<double>(time);
+    const auto& summary = summaries.at(trend.first);
+    REQUIRE(summary.moments.count() == 50);
+    REQUIRE(std::fabs(summary.moments.mean() - sum / 50) < 1e-9);
+    REQUIRE(std::fabs(summaries_only.at(trend.first).moments.mean() - sum / 50) < 1e-9);
+  }
+}
+
+TEST_CASE("seed sequence matches std::seed_seq", "[SeedSequence]") {
+  for (int n : {1, 2, 6, 7, 39, 68, 623, 624, 700}) {
+    std::vector<std::uint32_t> expected(n);
+    std::vector<std::uint32_t> actual(n);
+    std::seed_seq{7, -3}.generate(expected.begin(), expected.end());
+    equilibrium::SeedSequence(7, -3).generate(actual.begin(), actual.end());
+    REQUIRE(actual == expected);
+
+    std::seed_seq{1, 2, 3}.generate(expected.begin(), expected.end());
+    equilibrium::SeedSequence(1, 2, 3).generate(actual.begin(), actual.end());
+    REQUIRE(actual == expected);
+  }
+
+  std::seed_seq seq{11, 5};
+  equilibrium::SeedSequence sequence(11, 5);
+  REQUIRE(std::mt19937(seq)() == std::mt19937(sequence)());
+}
+
+TEST_CASE("a reused workspace gives the same trials as a fresh one", "[SimulationWorkspace]") {
+  equilibrium::SimulationConfig config;
+  config.birth_mutation_rate = 0.05;
+  config.independent_mutation_rate = 0.01;
+  config.num_steps = 300;
+  config.num_simulations = 1;
+  config.dynamic = equilibrium::Dynamic::DEATH_BIRTH;
+  config.graph = equilibrium::StarGraph(9);
+  config.capture_history = false;
+  config.compute_stats = true;
+  config.start_with_max_diversity = true;
+  config.run_until_homogeneous = false;
+  config.seed = 12;
+  config.node_rates = {2, 1, 1, 1, 1, 1, 1, 1, 3};
+  config.continuous_time = true;
+  REQUIRE(equilibrium::MakeMeasureTrackers("shannon,unmatching_links", config.graph, &config.measures));
+
+  equilibrium::SimulationWorkspace workspace(config);
+  for (int trial = 0; trial < 5; ++trial) {
+    equilibrium::Stats fresh;
+    equilibrium::Simulate(config, trial, &fresh, nullptr);
+    equilibrium::Stats reused;
+    equilibrium::Simulate(config, trial, &workspace, &reused, nullptr);
+    REQUIRE(reused.number_of_types == fresh.number_of_types);
+    REQUIRE(reused.number_of_unmatching_pairs == fresh.number_of_unmatching_pairs);
+    REQUIRE(reused.number_of_unmatching_links == fresh.number_of_unmatching_links);
+    REQUIRE(std::fabs(reused.time - fresh.time) < 1e-12);
+    REQUIRE(reused.measures[0].time_average == fresh.measures[0].time_average);
+    REQUIRE(reused.measures[1].final == fresh.measures[1].final);
+  }
+}
+
+TEST_CASE("histories come back in trial order", "[ComputeSimulationHistories]") {
+  equilibrium::SimulationConfig config;
+  config.birth_mutation_rate = 0.1;
+  config.independent_mutation_rate = 0;
+  config.num_steps = 50;
+  config.num_simulations = 12;
+  config.dynamic = equilibrium::Dynamic::BIRTH_DEATH;
+  config.graph = equilibrium::CycleGraph(6);
+  config.capture_history = true;
+  config.history_sample_rate = 10;
+  config.compute_stats = false;
+  config.start_with_max_diversity = false;
+  config.run_until_homogeneous = false;
+  config.seed = 9;
+
+  equilibrium::SimulationHistories histories(1);
+  equilibrium::ComputeSimulationHistories(config, &histories);
+  REQUIRE(histories.size() == 13);
+  REQUIRE(histories[0].location_to_types.empty());
+  for (int trial = 0; trial < config.num_simulations; ++trial) {
+    equilibrium::SimulationHistory expected;
+    equilibrium::Simulate(config, trial, nullptr, &expected);
+    REQUIRE(histories[trial + 1].location_to_types == expected.location_to_types);
+    REQUIRE(histories[trial + 1].ancestry == expected.ancestry);
+  }
+}
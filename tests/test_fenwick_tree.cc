@@ -0,0 +1,38 @@
+#include <cmath>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <equilibrium/fenwick_tree.h>
+
+TEST_CASE("find follows the prefix sums", "[FenwickTree]") {
+  equilibrium::FenwickTree tree;
+  tree.Reset({1., 0., 2., 3.});
+  REQUIRE(std::fabs(tree.total() - 6.) < 1e-12);
+  REQUIRE(tree.Find(0.) == 0);
+  REQUIRE(tree.Find(0.99) == 0);
+  REQUIRE(tree.Find(1.) == 2);
+  REQUIRE(tree.Find(2.99) == 2);
+  REQUIRE(tree.Find(3.) == 3);
+  REQUIRE(tree.Find(5.99) == 3);
+}
+
+TEST_CASE("zero weights are never found", "[FenwickTree]") {
+  equilibrium::FenwickTree tree(5);
+  tree.Set(4, 1.);
+  for (double u = 0; u < 1.; u += 0.125) {
+    REQUIRE(tree.Find(u) == 4);
+  }
+  tree.Set(4, 0.);
+  tree.Set(1, 2.);
+  REQUIRE(tree.Find(1.999) == 1);
+}
+
+TEST_CASE("updates keep the total", "[FenwickTree]") {
+  equilibrium::FenwickTree tree(3);
+  tree.Add(0, 1.);
+  tree.Add(2, 4.);
+  tree.Add(0, 1.);
+  REQUIRE(std::fabs(tree.weight(0) - 2.) < 1e-12);
+  REQUIRE(std::fabs(tree.total() - 6.) < 1e-12);
+  REQUIRE(tree.Find(2.) == 2);
+}
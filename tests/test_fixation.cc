@@ -0,0 +1,206 @@
+#include <cmath>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <equilibrium/fixation.h>
+#include <equilibrium/graph.h>
+
+namespace {
+
+equilibrium::FixationConfig MakeFixationConfig(const equilibrium::Graph& graph, equilibrium::Dynamic dynamic) {
+  equilibrium::FixationConfig config;
+  config.dynamic = dynamic;
+  config.graph = graph;
+  config.num_simulations = 20000;
+  config.seed = 1;
+  return config;
+}
+
+double FixationProbability(const equilibrium::FixationResult& result) {
+  return static_cast<double>(result.fixations) / static_cast<double>(result.trials);
+}
+
+}  // namespace
+
+TEST_CASE("bitset tracks mutants", "[TwoTypePopulation]") {
+  equilibrium::TwoTypePopulation population;
+  population.Reset(130);
+  population.Set(0, true);
+  population.Set(64, true);
+  population.Set(129, true);
+  population.Set(129, true);
+  REQUIRE(population.num_mutants() == 3);
+  REQUIRE(population.IsMutant(64));
+  REQUIRE(!population.IsMutant(65));
+
+  population.Set(64, false);
+  REQUIRE(population.num_mutants() == 2);
+  REQUIRE(!population.IsAbsorbed());
+}
+
+TEST_CASE("neutral moran fixation is 1/N", "[ComputeFixation]") {
+  const auto config = MakeFixationConfig(equilibrium::CompleteGraph(5), equilibrium::Dynamic::BIRTH_DEATH);
+  equilibrium::FixationResults results;
+  equilibrium::ComputeFixation(config, &results);
+
+  equilibrium::FixationResult overall;
+  for (const auto& node_result : results) equilibrium::MergeFixationResult(node_result.second, &overall);
+  REQUIRE(overall.trials == config.num_simulations);
+  REQUIRE(overall.undecided == 0);
+  REQUIRE(FixationProbability(overall) > 0.19);
+  REQUIRE(FixationProbability(overall) < 0.21);
+}
+
+TEST_CASE("advantageous moran fixation", "[ComputeFixation]") {
+  // (1 - 1/r) / (1 - 1/r^N) for r = 2, N = 5.
+  auto config = MakeFixationConfig(equilibrium::CompleteGraph(5), equilibrium::Dynamic::BIRTH_DEATH);
+  config.mutant_fitness = 2.;
+  config.start_node = 0;
+  equilibrium::FixationResults results;
+  equilibrium::ComputeFixation(config, &results);
+
+  REQUIRE(results.size() == 1);
+  REQUIRE(FixationProbability(results[0]) > 0.5161 - 0.015);
+  REQUIRE(FixationProbability(results[0]) < 0.5161 + 0.015);
+  REQUIRE(results[0].fixation_time.count() == results[0].fixations);
+}
+
+TEST_CASE("every start node gets equal effort", "[ComputeFixation]") {
+  auto config = MakeFixationConfig(equilibrium::StarGraph(4), equilibrium::Dynamic::DEATH_BIRTH);
+  config.start_node = equilibrium::kEveryStartNode;
+  config.num_simulations = 400;
+  equilibrium::FixationResults results;
+  equilibrium::ComputeFixation(config, &results);
+
+  REQUIRE(results.size() == 4);
+  for (const auto& node_result : results) {
+    REQUIRE(node_result.second.trials == 100);
+  }
+}
+
+TEST_CASE("seeded fixation reproduces", "[ComputeFixation]") {
+  auto config = MakeFixationConfig(equilibrium::CycleGraph(6), equilibrium::Dynamic::DEATH_BIRTH);
+  config.num_simulations = 500;
+  equilibrium::FixationResults first, second;
+  equilibrium::ComputeFixation(config, &first);
+  equilibrium::ComputeFixation(config, &second);
+
+  REQUIRE(first.size() == second.size());
+  for (const auto& node_result : first) {
+    REQUIRE(node_result.second.fixations == second[node_result.first].fixations);
+  }
+}
+
+TEST_CASE("max steps leaves trials undecided", "[RunFixationTrial]") {
+  auto config = MakeFixationConfig(equilibrium::CycleGraph(50), equilibrium::Dynamic::BIRTH_DEATH);
+  config.max_steps = 1;
+  equilibrium::TwoTypePopulation population;
+  equilibrium::Xoshiro256 rng(1, 0);
+  equilibrium::FixationTrial trial;
+  equilibrium::RunFixationTrial(config, 0, rng, &population, &trial);
+  REQUIRE(trial.steps == 1);
+  REQUIRE(trial.outcome == equilibrium::FixationOutcome::UNDECIDED);
+}
+
+TEST_CASE("batched engine matches neutral moran", "[RunFixationBlock]") {
+  auto config = MakeFixationConfig(equilibrium::CompleteGraph(5), equilibrium::Dynamic::DEATH_BIRTH);
+  config.engine = equilibrium::FixationEngine::BATCHED;
+  config.batch_size = 1000;
+  equilibrium::FixationResults results;
+  equilibrium::ComputeFixation(config, &results);
+
+  equilibrium::FixationResult overall;
+  for (const auto& node_result : results) equilibrium::MergeFixationResult(node_result.second, &overall);
+  REQUIRE(overall.trials == config.num_simulations);
+  REQUIRE(FixationProbability(overall) > 0.19);
+  REQUIRE(FixationProbability(overall) < 0.21);
+}
+
+TEST_CASE("batched engine matches scalar with selection", "[RunFixationBlock]") {
+  auto config = MakeFixationConfig(equilibrium::StarGraph(6), equilibrium::Dynamic::BIRTH_DEATH);
+  config.mutant_fitness = 1.5;
+  config.start_node = 1;
+  equilibrium::FixationResults scalar, batched;
+  equilibrium::ComputeFixation(config, &scalar);
+  config.engine = equilibrium::FixationEngine::BATCHED;
+  equilibrium::ComputeFixation(config, &batched);
+
+  const double difference = FixationProbability(scalar[1]) - FixationProbability(batched[1]);
+  REQUIRE(difference < 0.02);
+  REQUIRE(difference > -0.02);
+  const double time_ratio = scalar[1].fixation_time.mean() / batched[1].fixation_time.mean();
+  REQUIRE(time_ratio > 0.95);
+  REQUIRE(time_ratio < 1.05);
+}
+
+TEST_CASE("batched results do not depend on block size", "[RunFixationBlock]") {
+  auto config = MakeFixationConfig(equilibrium::CycleGraph(7), equilibrium::Dynamic::BIRTH_DEATH);
+  config.engine = equilibrium::FixationEngine::BATCHED;
+  config.start_node = equilibrium::kRandomStartNode;
+  config.num_simulations = 300;
+  config.batch_size = 300;
+  equilibrium::FixationResults one_block, many_blocks;
+  equilibrium::ComputeFixation(config, &one_block);
+  config.batch_size = 7;
+  equilibrium::ComputeFixation(config, &many_blocks);
+
+  REQUIRE(one_block.size() == many_blocks.size());
+  for (const auto& node_result : one_block) {
+    REQUIRE(node_result.second.fixations == many_blocks[node_result.first].fixations);
+    // Only the order trials are merged in differs.
+    const double difference = node_result.second.fixation_time.mean() - many_blocks[node_result.first].fixation_time.mean();
+    REQUIRE(std::fabs(difference) < 1e-9);
+  }
+}
+
+TEST_CASE("batched trials are reported in trial order", "[RunFixationBlock]") {
+  auto config = MakeFixationConfig(equilibrium::CycleGraph(7), equilibrium::Dynamic::BIRTH_DEATH);
+  config.start_node = equilibrium::kRandomStartNode;
+  equilibrium::NeighborTable table;
+  equilibrium::GetNeighborTable(config.graph, config.dynamic, &table);
+  equilibrium::FixationResults all_results, tail_results;
+  std::vector<equilibrium::FixationTrial> all(300), tail(200);
+  equilibrium::RunFixationBlock(config, table, 3, 0, 300, &all_results, &all);
+  equilibrium::RunFixationBlock(config, table, 3, 100, 300, &tail_results, &tail);
+
+  long long fixations = 0;
+  for (const auto& trial : all) fixations += trial.outcome == equilibrium::FixationOutcome::FIXATION;
+  long long all_fixations = 0;
+  for (const auto& node_result : all_results) all_fixations += node_result.second.fixations;
+  REQUIRE(fixations == all_fixations);
+  for (int k = 0; k < static_cast<int>(tail.size()); ++k) {
+    REQUIRE(tail[k].start_node == all[100 + k].start_node);
+    REQUIRE(tail[k].outcome == all[100 + k].outcome);
+    REQUIRE(tail[k].steps == all[100 + k].steps);
+  }
+}
+
+TEST_CASE("fitness must be finite and positive", "[IsValidFitness]") {
+  REQUIRE(equilibrium::IsValidFitness(1.));
+  REQUIRE(equilibrium::IsValidFitness(1e-3));
+  REQUIRE(!equilibrium::IsValidFitness(0.));
+  REQUIRE(!equilibrium::IsValidFitness(-1.));
+  REQUIRE(!equilibrium::IsValidFitness(INFINITY));
+  REQUIRE(!equilibrium::IsValidFitness(NAN));
+}
+
+TEST_CASE("weak mutant centre of a death-birth star absorbs", "[RunFixationTrial][RunFixationBlock]") {
+  // Every dier but the centre has only the mutant centre to copy from.
+  auto config = MakeFixationConfig(equilibrium::StarGraph(5), equilibrium::Dynamic::DEATH_BIRTH);
+  config.mutant_fitness = 1e-3;
+  equilibrium::TwoTypePopulation population;
+  equilibrium::Xoshiro256 rng(1, 0);
+  for (int trial = 0; trial < 100; ++trial) {
+    equilibrium::FixationTrial fixation_trial;
+    equilibrium::RunFixationTrial(config, 0, rng, &population, &fixation_trial);
+    REQUIRE(fixation_trial.outcome != equilibrium::FixationOutcome::UNDECIDED);
+  }
+
+  config.engine = equilibrium::FixationEngine::BATCHED;
+  config.start_node = 0;
+  config.num_simulations = 100;
+  equilibrium::FixationResults results;
+  equilibrium::ComputeFixation(config, &results);
+  REQUIRE(results[0].trials == 100);
+  REQUIRE(results[0].undecided == 0);
+}
@@ -0,0 +1,87 @@
+#include <set>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <equilibrium/genealogy.h>
+#include <equilibrium/graph.h>
+#include <equilibrium/simulation.h>
+
+TEST_CASE("extinct lineages are pruned", "[Genealogy]") {
+  equilibrium::Genealogy genealogy;
+  genealogy.Reset({0, 0, 0});
+  // 0 -> 1 -> 2 at steps 1 and 2, each taking over one location.
+  genealogy.AddType(1, 0, 1);
+  genealogy.Replace(0, 1);
+  genealogy.AddType(2, 1, 2);
+  genealogy.Replace(1, 2);
+  REQUIRE(genealogy.size() == 3);
+  REQUIRE(genealogy.MostRecentCommonAncestor() == 0);
+
+  // Type 0 dies out but still roots type 2.
+  genealogy.Replace(0, 2);
+  genealogy.Replace(0, 2);
+  REQUIRE(genealogy.size() == 3);
+  REQUIRE(genealogy.MostRecentCommonAncestor() == 2);
+  REQUIRE(genealogy.TimeToMostRecentCommonAncestor(10) == 8);
+
+  // A new root replacing the last type 2 drops the whole old lineage.
+  genealogy.AddType(3, equilibrium::kNoAncestry, 11);
+  genealogy.Replace(2, 3);
+  genealogy.Replace(2, 3);
+  genealogy.Replace(2, 3);
+  std::vector<equilibrium::GenealogyNode> nodes;
+  genealogy.GetNodes(&nodes);
+  REQUIRE(nodes.size() == 1);
+  REQUIRE(nodes[0].type == 3);
+  REQUIRE(nodes[0].abundance == 3);
+}
+
+TEST_CASE("separate roots have no common ancestor", "[Genealogy]") {
+  equilibrium::Genealogy genealogy;
+  genealogy.Reset({0, 1});
+  REQUIRE(genealogy.MostRecentCommonAncestor() == equilibrium::kNoAncestry);
+  REQUIRE(genealogy.TimeToMostRecentCommonAncestor(5) == -1);
+  genealogy.Replace(1, 0);
+  REQUIRE(genealogy.size() == 1);
+  REQUIRE(genealogy.TimeToMostRecentCommonAncestor(5) == 5);
+}
+
+TEST_CASE("pruned genealogy matches the full ancestry", "[Genealogy]") {
+  equilibrium::SimulationConfig config;
+  config.birth_mutation_rate = 0.05;
+  config.independent_mutation_rate = 0.002;
+  config.num_steps = 5000;
+  config.num_simulations = 1;
+  config.dynamic = equilibrium::Dynamic::DEATH_BIRTH;
+  config.graph = equilibrium::CycleGraph(20);
+  config.capture_history = true;
+  config.history_sample_rate = config.num_steps;
+  config.compute_stats = false;
+  config.start_with_max_diversity = true;
+  config.run_until_homogeneous = false;
+  config.seed = 11;
+
+  equilibrium::SimulationHistory full;
+  equilibrium::Simulate(config, 0, nullptr, &full);
+  config.track_genealogy = true;
+  equilibrium::SimulationHistory pruned;
+  equilibrium::Simulate(config, 0, nullptr, &pruned);
+
+  REQUIRE(pruned.ancestry.empty());
+  REQUIRE(pruned.location_to_types == full.location_to_types);
+  REQUIRE(pruned.genealogy.size() < full.ancestry.size());
+
+  // Every ancestor of a final type, and nothing else, survives pruning.
+  std::set<int> expected;
+  for (auto type : full.location_to_types.back()) {
+    while (type != equilibrium::kNoAncestry && expected.insert(type).second) {
+      type = full.ancestry[type];
+    }
+  }
+  std::set<int> kept;
+  for (const auto& node : pruned.genealogy) {
+    kept.insert(node.type);
+    REQUIRE(node.parent == full.ancestry[node.type]);
+  }
+  REQUIRE(kept == expected);
+}
@@ -0,0 +1,92 @@
+#include <climits>
+#include <cmath>
+#include <map>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <equilibrium/graph.h>
+#include <equilibrium/lumped.h>
+#include <equilibrium/simulation.h>
+
+#include "test_configs.h"
+
+namespace {
+
+equilibrium::SimulationConfig MakeConfig(const equilibrium::Graph& graph, equilibrium::Dynamic dynamic) {
+  auto config = equilibrium_test::AbsorptionConfig(graph, dynamic);
+  config.engine = equilibrium::SimulationEngine::LUMPED;
+  return config;
+}
+
+}  // namespace
+
+TEST_CASE("complete graphs and (double) stars are lumped", "[GetLumpedGraph]") {
+  equilibrium::LumpedGraph lumped;
+  REQUIRE(equilibrium::GetLumpedGraph(equilibrium::CompleteGraph(5), &lumped));
+  REQUIRE(lumped.complete);
+  REQUIRE(equilibrium::GetLumpedGraph(equilibrium::StarGraph(5), &lumped));
+  REQUIRE(lumped.hub_leaves == std::vector<int>{4});
+  REQUIRE(equilibrium::GetLumpedGraph(equilibrium::DoubleStarGraph(7), &lumped));
+  REQUIRE(lumped.hub_leaves == std::vector<int>{3, 2});
+  REQUIRE_FALSE(equilibrium::GetLumpedGraph(equilibrium::CycleGraph(5), &lumped));
+}
+
+TEST_CASE("only plain absorption runs are lumped", "[SupportsLumped]") {
+  auto config = MakeConfig(equilibrium::StarGraph(5), equilibrium::Dynamic::BIRTH_DEATH);
+  REQUIRE(equilibrium::SupportsLumped(config));
+  config.birth_mutation_rate = 0.1;
+  REQUIRE_FALSE(equilibrium::SupportsLumped(config));
+  config.birth_mutation_rate = 0;
+  config.graph = equilibrium::LineGraph(5);
+  REQUIRE_FALSE(equilibrium::SupportsLumped(config));
+}
+
+TEST_CASE("lumped trials do not depend on the trial range", "[ComputeTrends]") {
+  std::map<int, equilibrium::SimulationConfig> configs;
+  for (int n : {3, 9}) configs[n] = MakeConfig(equilibrium::DoubleStarGraph(n), equilibrium::Dynamic::DEATH_BIRTH);
+
+  equilibrium::Trends all;
+  equilibrium::ComputeTrends(configs, 0, 3000, &all);
+  equilibrium::Trends tail;
+  equilibrium::ComputeTrends(configs, 1000, 3000, &tail);
+  for (const auto& trend : tail) {
+    REQUIRE(std::vector<long long>(all[trend.first].begin() + 1000, all[trend.first].end()) == trend.second);
+  }
+
+  // Homogeneous from the start.
+  configs[9].start_with_max_diversity = false;
+  equilibrium::Trends homogeneous;
+  equilibrium::ComputeTrends(configs, 0, 10, &homogeneous);
+  REQUIRE(homogeneous[9] == std::vector<long long>(10, 0));
+}
+
+TEST_CASE("lumped absorption times match Simulate", "[ComputeTrends]") {
+  const int num_trials = 20000;
+  for (const auto& dynamic : {equilibrium::Dynamic::BIRTH_DEATH, equilibrium::Dynamic::DEATH_BIRTH}) {
+    for (const auto& graph : {equilibrium::CompleteGraph(6), equilibrium::StarGraph(6),
+                              equilibrium::DoubleStarGraph(7)}) {
+      const int n = graph.size();
+      std::map<int, equilibrium::SimulationConfig> lumped = {{n, MakeConfig(graph, dynamic)}};
+      auto scalar = lumped;
+      scalar[n].engine = equilibrium::SimulationEngine::SCALAR;
+
+      const double lumped_mean = equilibrium_test::MeanTime(lumped, num_trials);
+      const double scalar_mean = equilibrium_test::MeanTime(scalar, num_trials);
+      // Both standard errors are well under 1% of the mean here.
+      REQUIRE(std::fabs(lumped_mean - scalar_mean) < 0.04 * scalar_mean);
+    }
+  }
+}
+
+TEST_CASE("lumped times past an int are kept and overflow is reported", "[ComputeTrends]") {
+  // A birth-death star absorbs after about N^3 steps.
+  const int small = 1000000;
+  equilibrium::Trends trends;
+  REQUIRE(equilibrium::ComputeTrends(
+      {{small, MakeConfig(equilibrium::StarGraph(small), equilibrium::Dynamic::BIRTH_DEATH)}}, 0, 1, &trends));
+  REQUIRE(trends[small][0] > INT_MAX);
+
+  const int large = 3000000;
+  REQUIRE_FALSE(equilibrium::ComputeTrends(
+      {{large, MakeConfig(equilibrium::StarGraph(large), equilibrium::Dynamic::BIRTH_DEATH)}}, 0, 1, &trends));
+}
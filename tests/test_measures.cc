@@ -0,0 +1,138 @@
+#include <cmath>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <equilibrium/graph.h>
+#include <equilibrium/measures.h>
+#include <equilibrium/simulation.h>
+#include <equilibrium/type_allocator.h>
+
+namespace {
+
+std::unique_ptr<equilibrium::MeasureTracker> Make(const std::string& name, const equilibrium::Graph& graph) {
+  std::shared_ptr<const equilibrium::MeasureTracker> prototype;
+  REQUIRE(equilibrium::MakeMeasureTracker(name, graph, &prototype));
+  return prototype->Clone();
+}
+
+double Final(const equilibrium::MeasureTracker& tracker, int step) {
+  equilibrium::MeasureResult result;
+  tracker.GetResult(step, &result);
+  return result.final[0];
+}
+
+}  // namespace
+
+TEST_CASE("incremental measures match a recount", "[MeasureTracker]") {
+  const auto graph = equilibrium::CycleGraph(8);
+  const int n = graph.size();
+  std::vector<int> location_to_type(n, 0);
+  equilibrium::TypeAllocator types;
+  types.Reset(n, 1);
+
+  std::vector<std::unique_ptr<equilibrium::MeasureTracker>> trackers;
+  for (const auto& name : {"abundance_spectrum", "shannon", "simpson", "unmatching_pairs",
+                           "unmatching_links", "autocorrelation_2"}) {
+    trackers.push_back(Make(name, graph));
+    trackers.back()->Reset(&location_to_type);
+  }
+
+  std::mt19937 rng(3);
+  std::uniform_int_distribution<> location_dist(0, n - 1);
+  for (int step = 1; step <= 300; ++step) {
+    const int location = location_dist(rng);
+    const int old_type = location_to_type[location];
+    // Alternate copying a random location and mutating.
+    const int new_type = step % 3 == 0 ? types.Allocate() : location_to_type[location_dist(rng)];
+    location_to_type[location] = new_type;
+    types.Replace(old_type, new_type);
+    for (auto& tracker : trackers) tracker->Replace(location, old_type, new_type, step);
+
+    std::map<int, int> abundance;
+    for (const auto& type : location_to_type) ++abundance[type];
+    std::vector<double> spectrum(n, 0.);
+    double shannon = 0;
+    double matching = 0;
+    for (const auto& entry : abundance) {
+      const double p = static_cast<double>(entry.second) / n;
+      spectrum[entry.second - 1] += 1;
+      shannon -= p * std::log(p);
+      matching += entry.second * (entry.second - 1);
+    }
+    const double simpson = matching / (n * (n - 1));
+    // Distance 2 on a cycle of 8 is i +- 2.
+    double same_at_2 = 0;
+    for (int i = 0; i < n; ++i) same_at_2 += location_to_type[i] == location_to_type[(i + 2) % n];
+    const double f_2 = same_at_2 / n;
+    const double autocorrelation = simpson < 1 ? (f_2 - simpson) / (1 - simpson) : 0.;
+
+    equilibrium::MeasureResult result;
+    trackers[0]->GetResult(step, &result);
+    REQUIRE(result.final == spectrum);
+    REQUIRE(std::fabs(Final(*trackers[1], step) - shannon) < 1e-9);
+    REQUIRE(std::fabs(Final(*trackers[2], step) - simpson) < 1e-12);
+    const double pairs = equilibrium::NumberOfUnmatchingPairs(location_to_type);
+    const double links = equilibrium::NumberOfUnmatchingLinks(location_to_type, graph);
+    REQUIRE(std::fabs(Final(*trackers[3], step) - pairs) < 1e-12);
+    REQUIRE(std::fabs(Final(*trackers[4], step) - links) < 1e-12);
+    REQUIRE(std::fabs(Final(*trackers[5], step) - autocorrelation) < 1e-12);
+  }
+}
+
+TEST_CASE("time averages weight values by how long they were held", "[MeasureTracker]") {
+  const auto graph = equilibrium::CompleteGraph(2);
+  std::vector<int> location_to_type = {0, 0};
+  auto tracker = Make("unmatching_pairs", graph);
+  tracker->Reset(&location_to_type);
+
+  // 0 pairs for steps [0, 3), 1 pair for [3, 4), then 0 again until 10.
+  location_to_type[1] = 1;
+  tracker->Replace(1, 0, 1, 3);
+  location_to_type[1] = 0;
+  tracker->Replace(1, 1, 0, 4);
+
+  equilibrium::MeasureResult result;
+  tracker->GetResult(10, &result);
+  REQUIRE(std::fabs(result.final[0]) < 1e-12);
+  REQUIRE(std::fabs(result.time_average[0] - 0.1) < 1e-12);
+}
+
+TEST_CASE("unknown measures are rejected", "[MakeMeasureTracker]") {
+  const auto graph = equilibrium::CycleGraph(4);
+  std::vector<std::shared_ptr<const equilibrium::MeasureTracker>> trackers;
+  REQUIRE(equilibrium::MakeMeasureTrackers("shannon,autocorrelation_1", graph, &trackers));
+  REQUIRE(trackers.size() == 2);
+  REQUIRE_FALSE(equilibrium::MakeMeasureTrackers("shannon,entropy", graph, &trackers));
+  REQUIRE_FALSE(equilibrium::MakeMeasureTrackers("autocorrelation_x", graph, &trackers));
+}
+
+TEST_CASE("simulation reports the tracked measures", "[MeasureTracker]") {
+  equilibrium::SimulationConfig config;
+  config.birth_mutation_rate = 0.05;
+  config.independent_mutation_rate = 0;
+  config.num_steps = 1000;
+  config.num_simulations = 4;
+  config.dynamic = equilibrium::Dynamic::BIRTH_DEATH;
+  config.graph = equilibrium::CycleGraph(12);
+  config.capture_history = false;
+  config.compute_stats = true;
+  config.start_with_max_diversity = false;
+  config.run_until_homogeneous = false;
+  config.seed = 2;
+  REQUIRE(equilibrium::MakeMeasureTrackers("unmatching_pairs,unmatching_links", config.graph, &config.measures));
+
+  equilibrium::Stats stats;
+  equilibrium::Simulate(config, 0, &stats, nullptr);
+  REQUIRE(stats.measures.size() == 2);
+  REQUIRE(std::fabs(stats.measures[0].final[0] - stats.number_of_unmatching_pairs) < 1e-12);
+  REQUIRE(std::fabs(stats.measures[1].final[0] - stats.number_of_unmatching_links) < 1e-12);
+
+  equilibrium::DiversityCounts counts;
+  equilibrium::MeasureSummaries summaries;
+  equilibrium::ComputeDiversityCounts(config, 0, config.num_simulations, &counts, &summaries);
+  REQUIRE(summaries.at("unmatching_pairs").final[0].count() == 4);
+  REQUIRE(summaries.at("unmatching_pairs").time_average[0].mean() > 0);
+}
@@ -0,0 +1,75 @@
+#include <cstddef>
+#include <map>
+
+#include <catch2/catch_test_macros.hpp>
+#include <equilibrium/graph.h>
+#include <equilibrium/numa.h>
+#include <equilibrium/simulation.h>
+
+#include "test_configs.h"
+
+namespace {
+
+equilibrium::SimulationConfig MakeConfig() {
+  auto config = equilibrium_test::FixedStepsConfig(equilibrium::CycleGraph(20), equilibrium::Dynamic::BIRTH_DEATH, 200);
+  config.birth_mutation_rate = 0.05;
+  config.num_simulations = 50;
+  config.seed = 3;
+  return config;
+}
+
+}  // namespace
+
+TEST_CASE("the topology lists at least one CPU", "[GetNumaTopology]") {
+  equilibrium::NumaTopology topology;
+  equilibrium::GetNumaTopology(&topology);
+  REQUIRE(topology.num_nodes() >= 1);
+  for (const auto& cpus : topology.node_cpus) REQUIRE_FALSE(cpus.empty());
+}
+
+TEST_CASE("each node gets one copy", "[ConfigReplicas]") {
+  const auto config = MakeConfig();
+  equilibrium::ConfigReplicas replicas(config, 2);
+  std::size_t bytes;
+  const auto& first = replicas.Get(1, &bytes);
+  // 20 out and 20 in edges of 2 locations each.
+  REQUIRE(bytes == equilibrium::ReplicaBytes(config));
+  REQUIRE(bytes == 80 * sizeof(int));
+  REQUIRE(&first != &config);
+  REQUIRE(first.graph.out_edges() == config.graph.out_edges());
+  REQUIRE(&first.graph.out_edges() != &config.graph.out_edges());
+
+  REQUIRE(&replicas.Get(1, &bytes) == &first);
+  REQUIRE(bytes == 0);
+  // Unpinned threads share the original.
+  REQUIRE(&replicas.Get(-1, &bytes) == &config);
+}
+
+TEST_CASE("replicas do not change diversity counts", "[ComputeDiversityCounts]") {
+  auto config = MakeConfig();
+  equilibrium::DiversityCounts shared;
+  equilibrium::ComputeDiversityCounts(config, &shared);
+  config.numa_replicas = true;
+  equilibrium::DiversityCounts replicated;
+  equilibrium::ComputeDiversityCounts(config, &replicated);
+  REQUIRE(shared == replicated);
+}
+
+TEST_CASE("pinning is undone when the pin goes away", "[ScopedThreadPin]") {
+  equilibrium::NumaTopology before;
+  equilibrium::GetNumaTopology(&before);
+  {
+    equilibrium::ScopedThreadPin pin(before, 0);
+  }
+  equilibrium::NumaTopology after;
+  equilibrium::GetNumaTopology(&after);
+  REQUIRE(after.node_cpus == before.node_cpus);
+
+  // A second replicated run must see every CPU again, not the pinned one.
+  auto config = MakeConfig();
+  config.numa_replicas = true;
+  equilibrium::DiversityCounts diversity_counts;
+  equilibrium::ComputeDiversityCounts(config, &diversity_counts);
+  equilibrium::GetNumaTopology(&after);
+  REQUIRE(after.node_cpus == before.node_cpus);
+}
@@ -0,0 +1,75 @@
+#include <cmath>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <equilibrium/graph.h>
+#include <equilibrium/parallel_trajectory.h>
+#include <equilibrium/simulation.h>
+#include <omp.h>
+
+#include "test_configs.h"
+
+namespace {
+
+equilibrium::SimulationConfig MakeConfig(const equilibrium::Graph& graph, equilibrium::Dynamic dynamic) {
+  auto config = equilibrium_test::AbsorptionConfig(graph, dynamic);
+  config.run_until_homogeneous = false;
+  config.seed = 5;
+  return config;
+}
+
+}  // namespace
+
+TEST_CASE("parallel trajectories do not depend on the number of threads", "[SimulateParallel]") {
+  auto config = MakeConfig(equilibrium::CycleGraph(2000), equilibrium::Dynamic::DEATH_BIRTH);
+  config.birth_mutation_rate = 0.01;
+  config.node_rates.assign(2000, 1.);
+  config.node_rates[7] = 3.;
+
+  const int max_threads = omp_get_max_threads();
+  std::vector<std::vector<int>> finals;
+  std::vector<long long> steps;
+  for (int num_threads : {1, 3}) {
+    omp_set_num_threads(num_threads);
+    equilibrium::Stats stats;
+    finals.emplace_back();
+    equilibrium::SimulateParallel(config, 2, 5., &stats, &finals.back());
+    steps.emplace_back(stats.number_of_steps);
+    REQUIRE(stats.number_of_types == equilibrium::NumberOfTypes(finals.back()));
+  }
+  omp_set_num_threads(max_threads);
+  REQUIRE(finals[0] == finals[1]);
+  REQUIRE(steps[0] == steps[1]);
+
+  // About N * T events, Poisson distributed.
+  const double expected = 2002. * 5.;
+  REQUIRE(std::fabs(static_cast<double>(steps[0]) - expected) < 5 * std::sqrt(expected));
+}
+
+TEST_CASE("parallel trajectories fix like Simulate", "[SimulateParallel]") {
+  const int num_trials = 3000;
+  for (const auto& dynamic : {equilibrium::Dynamic::BIRTH_DEATH, equilibrium::Dynamic::DEATH_BIRTH}) {
+    // The center of the star is location 0.
+    auto config = MakeConfig(equilibrium::StarGraph(5), dynamic);
+    auto absorbing = config;
+    absorbing.run_until_homogeneous = true;
+    absorbing.capture_history = true;
+    absorbing.compute_stats = false;
+
+    int parallel_wins = 0;
+    int sequential_wins = 0;
+    for (int trial = 0; trial < num_trials; ++trial) {
+      equilibrium::Stats stats;
+      std::vector<int> location_to_type;
+      equilibrium::SimulateParallel(config, trial, 100., &stats, &location_to_type);
+      REQUIRE(stats.number_of_types == 1);
+      parallel_wins += location_to_type[0] == 0;
+
+      equilibrium::SimulationHistory history;
+      equilibrium::Simulate(absorbing, trial, nullptr, &history);
+      sequential_wins += history.location_to_types.back()[0] == 0;
+    }
+    // Both proportions have a standard error under 0.01.
+    REQUIRE(std::fabs(parallel_wins - sequential_wins) < 0.04 * num_trials);
+  }
+}
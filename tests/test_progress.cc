@@ -0,0 +1,113 @@
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <unistd.h>
+
+#include <catch2/catch_test_macros.hpp>
+#include <equilibrium/graph.h>
+#include <equilibrium/progress.h>
+#include <equilibrium/simulation.h>
+
+TEST_CASE("trials from every thread are counted", "[RecordTrialProgress]") {
+  long long trials_before;
+  long long steps_before;
+  equilibrium::GetTrialProgress(&trials_before, &steps_before);
+
+#pragma omp parallel for
+  for (int trial = 0; trial < 1000; ++trial) equilibrium::RecordTrialProgress(3);
+
+  long long trials;
+  long long steps;
+  equilibrium::GetTrialProgress(&trials, &steps);
+  REQUIRE(trials - trials_before == 1000);
+  REQUIRE(steps - steps_before == 3000);
+}
+
+TEST_CASE("simulations report their trials", "[RecordTrialProgress]") {
+  equilibrium::SimulationConfig config;
+  config.birth_mutation_rate = 0;
+  config.independent_mutation_rate = 0;
+  config.num_steps = 0;
+  config.num_simulations = 20;
+  config.dynamic = equilibrium::Dynamic::BIRTH_DEATH;
+  config.graph = equilibrium::CompleteGraph(5);
+  config.capture_history = false;
+  config.compute_stats = true;
+  config.start_with_max_diversity = true;
+  config.run_until_homogeneous = true;
+  config.seed = 1;
+
+  long long trials_before;
+  long long steps_before;
+  equilibrium::GetTrialProgress(&trials_before, &steps_before);
+  equilibrium::Trends trends;
+  equilibrium::ComputeTrends({{5, config}}, 0, config.num_simulations, &trends);
+  long long trials;
+  long long steps;
+  equilibrium::GetTrialProgress(&trials, &steps);
+
+  long long total_steps = 0;
+  for (const auto& time : trends[5]) total_steps += time;
+  REQUIRE(trials - trials_before == 20);
+  REQUIRE(steps - steps_before == total_steps);
+}
+
+TEST_CASE("the reporter leaves a final status file", "[ProgressReporter]") {
+  char directory[] = "/tmp/equilibrium-progress-XXXXXX";
+  REQUIRE(mkdtemp(directory) != nullptr);
+  const std::string status_file = std::string(directory) + "/status.json";
+  {
+    equilibrium::ProgressReporter reporter(40, 0, 60, status_file);
+    for (int trial = 0; trial < 10; ++trial) equilibrium::RecordTrialProgress(100);
+    const auto status = reporter.GetStatus();
+    REQUIRE(status.trials == 10);
+    REQUIRE(status.steps == 1000);
+    REQUIRE(status.total_trials == 40);
+    REQUIRE(status.eta_seconds >= 0);
+  }
+
+  std::ifstream ifs{status_file};
+  std::stringstream contents;
+  contents << ifs.rdbuf();
+  REQUIRE(contents.str().find("\"done\":true") != std::string::npos);
+  REQUIRE(contents.str().find("\"trials\":10") != std::string::npos);
+  REQUIRE(contents.str().find("\"total_trials\":40") != std::string::npos);
+
+  REQUIRE(std::remove(status_file.c_str()) == 0);
+  REQUIRE(rmdir(directory) == 0);
+}
+
+TEST_CASE("long trials report their steps before they end", "[RecordStepProgress]") {
+  equilibrium::SimulationConfig config;
+  config.birth_mutation_rate = 0.01;
+  config.independent_mutation_rate = 0;
+  config.num_steps = 3 * equilibrium::kProgressStepsPerFlush + 5;
+  config.num_simulations = 1;
+  config.dynamic = equilibrium::Dynamic::BIRTH_DEATH;
+  config.graph = equilibrium::CycleGraph(10);
+  config.capture_history = false;
+  config.compute_stats = true;
+  config.start_with_max_diversity = false;
+  config.run_until_homogeneous = false;
+  config.seed = 1;
+
+  long long trials_before;
+  long long steps_before;
+  equilibrium::GetTrialProgress(&trials_before, &steps_before);
+  equilibrium::RecordStepProgress(7);
+  long long trials;
+  long long steps;
+  equilibrium::GetTrialProgress(&trials, &steps);
+  REQUIRE(trials == trials_before);
+  REQUIRE(steps - steps_before == 7);
+
+  // Flushed and final steps add up to the trial's steps, counted once.
+  equilibrium::DiversityCounts diversity_counts;
+  equilibrium::ComputeDiversityCounts(config, &diversity_counts);
+  equilibrium::GetTrialProgress(&trials_before, &steps_before);
+  REQUIRE(trials_before - trials == 1);
+  REQUIRE(steps_before - steps == config.num_steps);
+}
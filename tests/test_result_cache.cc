@@ -0,0 +1,107 @@
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include <catch2/catch_test_macros.hpp>
+#include <equilibrium/graph.h>
+#include <equilibrium/result_cache.h>
+#include <equilibrium/simulation.h>
+
+#include "test_configs.h"
+
+namespace {
+
+equilibrium::SimulationConfig MakeConfig() {
+  auto config = equilibrium_test::FixedStepsConfig(equilibrium::StarGraph(12), equilibrium::Dynamic::BIRTH_DEATH, 300);
+  config.birth_mutation_rate = 0.05;
+  config.num_simulations = 10;
+  config.seed = 21;
+  return config;
+}
+
+}  // namespace
+
+TEST_CASE("canonical config ignores the number of trials", "[CanonicalConfig]") {
+  auto config = MakeConfig();
+  const auto key = equilibrium::CanonicalConfig(config);
+  config.num_simulations = 99;
+  REQUIRE(equilibrium::CanonicalConfig(config) == key);
+  config.birth_mutation_rate = 0.0500001;
+  REQUIRE(equilibrium::CanonicalConfig(config) != key);
+  config = MakeConfig();
+  config.seed = 22;
+  REQUIRE(equilibrium::CanonicalConfig(config) != key);
+}
+
+TEST_CASE("cached runs extend earlier ones", "[ResultCache]") {
+  char directory[] = "/tmp/equilibrium-cache-XXXXXX";
+  REQUIRE(mkdtemp(directory) != nullptr);
+  const equilibrium::ResultCache cache(directory);
+
+  auto config = MakeConfig();
+  equilibrium::DiversityCounts expected;
+  equilibrium::ComputeDiversityCounts(config, &expected);
+
+  // Six trials first, then ten reusing those six.
+  config.num_simulations = 6;
+  equilibrium::DiversityCounts partial;
+  int cached_trials = -1;
+  equilibrium::ComputeDiversityCounts(config, cache, &partial, &cached_trials);
+  REQUIRE(cached_trials == 0);
+
+  config.num_simulations = 10;
+  equilibrium::DiversityCounts extended;
+  equilibrium::ComputeDiversityCounts(config, cache, &extended, &cached_trials);
+  REQUIRE(cached_trials == 6);
+  REQUIRE(extended == expected);
+
+  equilibrium::DiversityCounts reused;
+  equilibrium::ComputeDiversityCounts(config, cache, &reused, &cached_trials);
+  REQUIRE(cached_trials == 10);
+  REQUIRE(reused == expected);
+  REQUIRE(equilibrium::CachedTrials(config, 4, cache) == 4);
+  REQUIRE(equilibrium::CachedTrials(config, 12, cache) == 10);
+
+  const auto key = equilibrium::CanonicalConfig(config);
+  std::vector<std::vector<long long>> rows;
+  cache.Load(key, &rows);
+  REQUIRE(rows.size() == 10);
+
+  REQUIRE(std::remove(cache.PathFor(key).c_str()) == 0);
+  REQUIRE(rmdir(directory) == 0);
+}
+
+TEST_CASE("cached trends can be summarised without the raw times", "[ResultCache]") {
+  char directory[] = "/tmp/equilibrium-cache-XXXXXX";
+  REQUIRE(mkdtemp(directory) != nullptr);
+  const equilibrium::ResultCache cache(directory);
+
+  std::map<int, equilibrium::SimulationConfig> configs;
+  for (int n : {4, 6}) {
+    configs[n] = equilibrium_test::AbsorptionConfig(equilibrium::CycleGraph(n), equilibrium::Dynamic::BIRTH_DEATH);
+  }
+  equilibrium::Trends expected;
+  REQUIRE(equilibrium::ComputeTrends(configs, 0, 30, &expected));
+
+  int cached_trials = -1;
+  equilibrium::Trends trends;
+  REQUIRE(equilibrium::ComputeTrends(configs, 20, cache, &trends, &cached_trials));
+  equilibrium::TrendSummaries summaries;
+  REQUIRE(equilibrium::ComputeTrends(configs, 30, cache, nullptr, &summaries, &cached_trials));
+  REQUIRE(cached_trials == 40);
+  for (const auto& trend : expected) {
+    equilibrium::SampleSummary summary;
+    for (const auto& time : trend.second) summary.Add(static_cast<double>(time));
+    REQUIRE(summaries[trend.first].moments.count() == 30);
+    REQUIRE(std::fabs(summaries[trend.first].moments.mean() - summary.moments.mean()) < 1e-9);
+  }
+
+  for (const auto& n_config : configs) {
+    REQUIRE(std::remove(cache.PathFor(equilibrium::CanonicalConfig(n_config.second)).c_str()) == 0);
+  }
+  REQUIRE(rmdir(directory) == 0);
+}
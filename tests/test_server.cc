@@ -0,0 +1,84 @@
+#include <atomic>
+#include <string>
+
+#include <catch2/catch_test_macros.hpp>
+#include <equilibrium/graph.h>
+#include <equilibrium/server.h>
+
+#include <nlohmann/json.hpp>
+
+TEST_CASE("graph cache builds each graph once", "[GraphCache]") {
+  equilibrium::GraphCache graphs;
+  equilibrium::Graph graph;
+  REQUIRE(graphs.Get("cycle", 8, &graph));
+  REQUIRE(graph.size() == 8);
+  equilibrium::Graph again;
+  REQUIRE(graphs.Get("cycle", 8, &again));
+  // Shared, not copied.
+  REQUIRE(&again.out_edges() == &graph.out_edges());
+  REQUIRE(graphs.Get("cycle", 9, &graph));
+  REQUIRE(graphs.size() == 2);
+  REQUIRE_FALSE(graphs.Get("no-such-graph", 8, &graph));
+  REQUIRE(graphs.size() == 2);
+}
+
+TEST_CASE("jobs reply with the document the app would write", "[RunJob]") {
+  equilibrium::GraphCache graphs;
+  const auto reply = nlohmann::json::parse(equilibrium::RunJob(
+      R"({"id": 7, "kind": "diversity_counts", "graph_name": "cycle", "N": 10, "num_steps": 200,)"
+      R"( "num_simulations": 20, "birth_mutation_rate": 0.05, "seed": 3, "tag": "notebook"})", &graphs));
+  REQUIRE(reply["id"] == 7);
+  REQUIRE(reply.count("error") == 0);
+  REQUIRE(reply["result"]["config"]["N"] == 10);
+  REQUIRE(reply["result"]["metadata"]["tag"] == "notebook");
+
+  int total = 0;
+  for (const auto& count : reply["result"]["results"][0]["diversity_counts"]) total += count["count"].get<int>();
+  REQUIRE(total == 20);
+
+  // Seeded jobs reproduce.
+  const auto again = nlohmann::json::parse(equilibrium::RunJob(
+      R"({"id": 8, "kind": "diversity_counts", "graph_name": "cycle", "N": 10, "num_steps": 200,)"
+      R"( "num_simulations": 20, "birth_mutation_rate": 0.05, "seed": 3, "tag": "notebook"})", &graphs));
+  REQUIRE(again["result"]["results"] == reply["result"]["results"]);
+  REQUIRE(graphs.size() == 1);
+
+  const auto fixation = nlohmann::json::parse(equilibrium::RunJob(
+      R"({"kind": "fixation", "graph_name": "complete", "N": 6, "num_simulations": 50, "seed": 1})", &graphs));
+  REQUIRE(fixation.count("error") == 0);
+  REQUIRE(fixation.count("id") == 0);
+}
+
+TEST_CASE("bad jobs reply with an error", "[RunJob]") {
+  equilibrium::GraphCache graphs;
+  REQUIRE(nlohmann::json::parse(equilibrium::RunJob("not json", &graphs)).count("error") == 1);
+
+  const auto unknown = nlohmann::json::parse(equilibrium::RunJob(R"({"id": "a", "kind": "nope"})", &graphs));
+  REQUIRE(unknown["id"] == "a");
+  REQUIRE(unknown.count("error") == 1);
+
+  const auto no_graph = nlohmann::json::parse(equilibrium::RunJob(
+      R"({"kind": "diversity_counts", "graph_name": "no-such-graph", "N": 4})", &graphs));
+  REQUIRE(no_graph.count("error") == 1);
+
+  const auto zero_fitness = nlohmann::json::parse(equilibrium::RunJob(
+      R"({"kind": "fixation", "graph_name": "star", "N": 5, "dynamic": "death-birth", "mutant_fitness": 0})",
+      &graphs));
+  REQUIRE(zero_fitness.count("error") == 1);
+
+  for (const std::string rates : {"[1, 1, 1]", "[1, -1, 1, 1]", "[0, 0, 0, 0]"}) {
+    const auto bad_rates = nlohmann::json::parse(equilibrium::RunJob(
+        R"({"kind": "diversity_counts", "graph_name": "complete", "N": 4, "node_rates": )" + rates + "}",
+        &graphs));
+    REQUIRE(bad_rates.count("error") == 1);
+  }
+}
+
+TEST_CASE("job queue runs every pushed job", "[JobQueue]") {
+  std::atomic<int> done(0);
+  {
+    equilibrium::JobQueue queue(3, 1);
+    for (int i = 0; i < 50; ++i) queue.Push([&done] { ++done; });
+  }
+  REQUIRE(done == 50);
+}
@@ -0,0 +1,113 @@
+#include <cmath>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <equilibrium/fixation.h>
+#include <equilibrium/graph.h>
+#include <equilibrium/random.h>
+#include <equilibrium/splitting.h>
+#include <omp.h>
+
+namespace {
+
+equilibrium::SplittingConfig MakeConfig(const equilibrium::Graph& graph, double mutant_fitness) {
+  equilibrium::SplittingConfig config;
+  config.fixation.dynamic = equilibrium::Dynamic::BIRTH_DEATH;
+  config.fixation.graph = graph;
+  config.fixation.mutant_fitness = mutant_fitness;
+  config.fixation.num_simulations = 0;
+  config.fixation.seed = 6;
+  config.clones_per_level = 1000;
+  config.num_replications = 10;
+  return config;
+}
+
+}  // namespace
+
+TEST_CASE("even levels end at the target", "[MakeEvenLevels]") {
+  std::vector<long long> levels;
+  equilibrium::MakeEvenLevels(1, 10, 3, &levels);
+  REQUIRE(levels == std::vector<long long>({4, 7, 10}));
+  equilibrium::MakeEvenLevels(0, 100, 4, &levels);
+  REQUIRE(levels == std::vector<long long>({25, 50, 75, 100}));
+  // Never repeats a level.
+  equilibrium::MakeEvenLevels(1, 3, 5, &levels);
+  REQUIRE(levels == std::vector<long long>({2, 3}));
+}
+
+TEST_CASE("levels must increase beyond the start", "[RunSplitting]") {
+  auto config = MakeConfig(equilibrium::CompleteGraph(5), 1.);
+  equilibrium::SplittingResult result;
+  config.levels = {1, 5};
+  REQUIRE_FALSE(equilibrium::RunSplitting(config, &result));
+  config.levels = {3, 3, 5};
+  REQUIRE_FALSE(equilibrium::RunSplitting(config, &result));
+  config.levels = {3, 6};
+  REQUIRE_FALSE(equilibrium::RunSplitting(config, &result));
+  config.levels = {3, 5};
+  REQUIRE(equilibrium::RunSplitting(config, &result));
+}
+
+TEST_CASE("splitting estimates a rare fixation probability", "[RunSplitting]") {
+  // Birth-death on a regular graph fixes with the Moran probability.
+  const int N = 30;
+  const double r = 0.7;
+  const double expected = (1 - 1 / r) / (1 - std::pow(1 / r, N));
+  auto config = MakeConfig(equilibrium::CompleteGraph(N), r);
+  equilibrium::MakeEvenLevels(1, N, 10, &config.levels);
+
+  equilibrium::SplittingResult result;
+  REQUIRE(equilibrium::RunSplitting(config, &result));
+  REQUIRE(expected < 1e-5);
+  REQUIRE(std::fabs(result.probability - expected) < 4 * result.standard_error);
+  REQUIRE(std::fabs(result.probability - expected) < 0.25 * expected);
+  REQUIRE(result.lower <= result.probability);
+  REQUIRE(result.probability <= result.upper);
+  REQUIRE(result.level_probabilities.size() == config.levels.size());
+}
+
+TEST_CASE("splitting on steps matches brute force absorption tails", "[RunSplitting]") {
+  auto config = MakeConfig(equilibrium::StarGraph(10), 1.);
+  config.coordinate = equilibrium::ProgressCoordinate::STEPS;
+  const long long T = 200;
+  equilibrium::MakeEvenLevels(0, T, 4, &config.levels);
+  config.clones_per_level = 2000;
+  config.num_replications = 5;
+  equilibrium::SplittingResult result;
+  REQUIRE(equilibrium::RunSplitting(config, &result));
+
+  const int num_trials = 20000;
+  int survived = 0;
+  equilibrium::TwoTypePopulation population;
+  for (int trial = 0; trial < num_trials; ++trial) {
+    equilibrium::Xoshiro256 rng(7, static_cast<std::uint64_t>(trial));
+    equilibrium::FixationTrial fixation_trial;
+    equilibrium::RunFixationTrial(config.fixation, equilibrium::GetStartNode(config.fixation, trial, rng), rng,
+                                  &population, &fixation_trial);
+    survived += fixation_trial.steps > T;
+  }
+  const double brute_force = static_cast<double>(survived) / num_trials;
+  const double brute_force_error = std::sqrt(brute_force * (1 - brute_force) / num_trials);
+  REQUIRE(brute_force > 0.01);
+  REQUIRE(std::fabs(result.probability - brute_force) <
+          4 * std::sqrt(result.standard_error * result.standard_error + brute_force_error * brute_force_error));
+}
+
+TEST_CASE("splitting does not depend on the number of threads", "[RunSplitting]") {
+  auto config = MakeConfig(equilibrium::StarGraph(12), 0.9);
+  config.fixation.dynamic = equilibrium::Dynamic::DEATH_BIRTH;
+  config.clones_per_level = 300;
+  config.num_replications = 2;
+  equilibrium::MakeEvenLevels(1, 12, 4, &config.levels);
+
+  const int max_threads = omp_get_max_threads();
+  std::vector<equilibrium::SplittingResult> results(2);
+  omp_set_num_threads(1);
+  equilibrium::RunSplitting(config, &results[0]);
+  omp_set_num_threads(3);
+  equilibrium::RunSplitting(config, &results[1]);
+  omp_set_num_threads(max_threads);
+  REQUIRE(std::fabs(results[0].probability - results[1].probability) < 1e-12);
+  REQUIRE(results[0].steps == results[1].steps);
+  REQUIRE(results[0].level_probabilities == results[1].level_probabilities);
+}
@@ -0,0 +1,134 @@
+#include <cmath>
+#include <map>
+
+#include <catch2/catch_test_macros.hpp>
+#include <equilibrium/statistics.h>
+
+TEST_CASE("moments of a sample", "[RunningMoments]") {
+  equilibrium::RunningMoments moments;
+  for (double x : {2., 4., 4., 4., 5., 5., 7., 9.}) moments.Add(x);
+  REQUIRE(moments.count() == 8);
+  REQUIRE(std::fabs(moments.mean() - 5.) < 1e-12);
+  REQUIRE(std::fabs(moments.variance() - 32. / 7.) < 1e-12);
+}
+
+TEST_CASE("merged moments match a single pass", "[RunningMoments]") {
+  equilibrium::RunningMoments all, left, right;
+  for (int i = 0; i < 10; ++i) {
+    all.Add(i * i);
+    (i < 3 ? left : right).Add(i * i);
+  }
+  left.Merge(right);
+  REQUIRE(left.count() == all.count());
+  REQUIRE(std::fabs(left.mean() - all.mean()) < 1e-9);
+  REQUIRE(std::fabs(left.variance() - all.variance()) < 1e-9);
+}
+
+TEST_CASE("wilson interval", "[WilsonInterval]") {
+  double lower, upper;
+  equilibrium::WilsonInterval(50, 100, 1.96, &lower, &upper);
+  REQUIRE(std::fabs(lower - 0.4038) < 1e-3);
+  REQUIRE(std::fabs(upper - 0.5962) < 1e-3);
+
+  equilibrium::WilsonInterval(0, 10, 1.96, &lower, &upper);
+  REQUIRE(std::fabs(lower) < 1e-12);
+  REQUIRE(upper > 0);
+}
+
+TEST_CASE("t-digest quantiles of a uniform sample", "[TDigest]") {
+  equilibrium::TDigest digest;
+  for (int i = 0; i < 10000; ++i) digest.Add((i * 7919) % 10000);
+  REQUIRE(std::fabs(digest.count() - 10000) < 1e-12);
+  REQUIRE(std::fabs(digest.Quantile(0.5) - 5000) < 100);
+  REQUIRE(std::fabs(digest.Quantile(0.05) - 500) < 50);
+  REQUIRE(std::fabs(digest.Quantile(0.99) - 9900) < 20);
+  REQUIRE(digest.Quantile(0) >= 0);
+  REQUIRE(digest.Quantile(1) <= 9999);
+}
+
+TEST_CASE("merged t-digests match a single one", "[TDigest]") {
+  equilibrium::TDigest whole;
+  equilibrium::TDigest parts[4];
+  for (int i = 0; i < 8000; ++i) {
+    const double x = std::sqrt(static_cast<double>(i));
+    whole.Add(x);
+    parts[i % 4].Add(x);
+  }
+  equilibrium::TDigest merged;
+  for (const auto& part : parts) merged.Merge(part);
+  REQUIRE(std::fabs(merged.count() - whole.count()) < 1e-12);
+  for (const double q : {0.1, 0.5, 0.9}) {
+    REQUIRE(std::fabs(merged.Quantile(q) - whole.Quantile(q)) < 0.5);
+  }
+}
+
+TEST_CASE("log histogram buckets by octave", "[LogHistogram]") {
+  equilibrium::LogHistogram histogram(1);
+  for (double x : {0.5, 1., 1.5, 2., 3., 4., 1000.}) histogram.Add(x);
+  REQUIRE(histogram.underflow() == 1);
+  REQUIRE(histogram.buckets().at(0) == 2);
+  REQUIRE(histogram.buckets().at(1) == 2);
+  REQUIRE(histogram.buckets().at(2) == 1);
+  REQUIRE(histogram.buckets().at(9) == 1);
+  REQUIRE(std::fabs(histogram.lower(9) - 512.) < 1e-12);
+  REQUIRE(std::fabs(histogram.upper(9) - 1024.) < 1e-12);
+
+  equilibrium::LogHistogram other(1);
+  other.Add(5.);
+  histogram.Merge(other);
+  REQUIRE(histogram.buckets().at(2) == 2);
+}
+
+TEST_CASE("paired difference", "[ComputePairedDifference]") {
+  equilibrium::PairedDifference difference;
+  equilibrium::ComputePairedDifference({1, 2, 3, 4}, {2, 4, 4, 6}, &difference);
+  REQUIRE(difference.num_pairs == 4);
+  REQUIRE(std::fabs(difference.mean - 1.5) < 1e-12);
+  // Differences 1, 2, 1, 2.
+  REQUIRE(std::fabs(difference.variance - 1. / 3) < 1e-12);
+  REQUIRE(std::fabs(difference.standard_error - std::sqrt(1. / 12)) < 1e-12);
+  // Variances 5/3 and 8/3.
+  REQUIRE(std::fabs(difference.unpaired_standard_error - std::sqrt(13. / 12)) < 1e-12);
+
+  equilibrium::ComputePairedDifference({}, {}, &difference);
+  REQUIRE(difference.num_pairs == 0);
+  REQUIRE(std::fabs(difference.standard_error) < 1e-12);
+}
+
+TEST_CASE("chi-square p-values", "[ChiSquarePValue]") {
+  REQUIRE(std::fabs(equilibrium::ChiSquarePValue(3.841, 1) - 0.05) < 1e-3);
+  REQUIRE(std::fabs(equilibrium::ChiSquarePValue(18.307, 10) - 0.05) < 1e-3);
+  REQUIRE(std::fabs(equilibrium::ChiSquarePValue(2., 2) - std::exp(-1.)) < 1e-12);
+  REQUIRE(std::fabs(equilibrium::ChiSquarePValue(0., 3) - 1.) < 1e-12);
+}
+
+TEST_CASE("two-sample tests tell shifted histograms apart", "[ChiSquareTest][KolmogorovSmirnovTest]") {
+  equilibrium::Histogram a;
+  equilibrium::Histogram same;
+  equilibrium::Histogram shifted;
+  for (int x = 0; x < 20; ++x) {
+    a[x] = 100;
+    same[x] = 100;
+    shifted[x + 2] = 100;
+  }
+
+  equilibrium::TestResult result;
+  equilibrium::ChiSquareTest(a, same, &result);
+  REQUIRE(std::fabs(result.statistic) < 1e-12);
+  REQUIRE(result.degrees_of_freedom == 19);
+  REQUIRE(std::fabs(result.p_value - 1.) < 1e-12);
+  equilibrium::ChiSquareTest(a, shifted, &result);
+  REQUIRE(result.p_value < 1e-6);
+
+  equilibrium::KolmogorovSmirnovTest(a, same, &result);
+  REQUIRE(std::fabs(result.statistic) < 1e-12);
+  REQUIRE(std::fabs(result.p_value - 1.) < 1e-12);
+  equilibrium::KolmogorovSmirnovTest(a, shifted, &result);
+  REQUIRE(std::fabs(result.statistic - 0.1) < 1e-12);
+  REQUIRE(result.p_value < 1e-6);
+
+  // Nothing to compare.
+  equilibrium::ChiSquareTest(a, {}, &result);
+  REQUIRE(std::fabs(result.p_value - 1.) < 1e-12);
+  REQUIRE(equilibrium::KolmogorovSmirnovResolution(10000, 10000, 0.05) < 0.02);
+}
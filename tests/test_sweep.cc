@@ -0,0 +1,100 @@
+#include <climits>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <equilibrium/graph.h>
+#include <equilibrium/simulation.h>
+#include <equilibrium/sweep.h>
+
+#include "test_configs.h"
+
+namespace {
+
+equilibrium::SimulationConfig MakeConfig() {
+  auto config = equilibrium_test::FixedStepsConfig(equilibrium::CycleGraph(30), equilibrium::Dynamic::BIRTH_DEATH, 500);
+  config.num_simulations = 400;
+  config.seed = 8;
+  return config;
+}
+
+}  // namespace
+
+TEST_CASE("sweep parameters parse", "[SetSweepParameter]") {
+  auto config = MakeConfig();
+  REQUIRE(equilibrium::SetSweepParameter("birth_mutation_rate", "0.25", &config));
+  REQUIRE(std::fabs(config.birth_mutation_rate - 0.25) < 1e-12);
+  REQUIRE(equilibrium::SetSweepParameter("independent_mutation_rate", "1e-3", &config));
+  REQUIRE(std::fabs(config.independent_mutation_rate - 1e-3) < 1e-12);
+  REQUIRE(equilibrium::SetSweepParameter("dynamic", "death-birth", &config));
+  REQUIRE(config.dynamic == equilibrium::Dynamic::DEATH_BIRTH);
+
+  REQUIRE_FALSE(equilibrium::SetSweepParameter("birth_mutation_rate", "0.1x", &config));
+  REQUIRE_FALSE(equilibrium::SetSweepParameter("birth_mutation_rate", "2", &config));
+  REQUIRE_FALSE(equilibrium::SetSweepParameter("num_steps", "10", &config));
+}
+
+TEST_CASE("common random numbers couple mutation rates", "[Simulate]") {
+  // Trial k makes the same steps at both rates, and every mutation at the
+  // lower rate also happens at the higher one. Two locations only share a
+  // type when no mutation hit their lineages since they split, so sharing a
+  // type at the higher rate implies sharing one at the lower rate.
+  auto low = MakeConfig();
+  low.common_random_numbers = true;
+  low.capture_history = true;
+  low.compute_stats = false;
+  low.history_sample_rate = low.num_steps;
+  low.birth_mutation_rate = 0.01;
+  low.independent_mutation_rate = 0.01;
+  auto high = low;
+  high.birth_mutation_rate = 0.03;
+  high.independent_mutation_rate = 0.05;
+
+  for (int trial = 0; trial < 20; ++trial) {
+    equilibrium::SimulationHistory low_history;
+    equilibrium::Simulate(low, trial, nullptr, &low_history);
+    equilibrium::SimulationHistory high_history;
+    equilibrium::Simulate(high, trial, nullptr, &high_history);
+    const auto& low_types = low_history.location_to_types.back();
+    const auto& high_types = high_history.location_to_types.back();
+    for (int i = 0; i < static_cast<int>(low_types.size()); ++i) {
+      for (int j = 0; j < i; ++j) {
+        if (high_types[i] == high_types[j]) REQUIRE(low_types[i] == low_types[j]);
+      }
+    }
+  }
+}
+
+TEST_CASE("paired differences shrink with common random numbers", "[ComputeSweep]") {
+  auto config = MakeConfig();
+  const std::vector<std::string> values = {"0.01", "0.012"};
+  const auto measure = equilibrium::DiversityMeasure::NUMBER_OF_TYPES;
+
+  config.common_random_numbers = true;
+  equilibrium::SweepResults coupled;
+  REQUIRE(equilibrium::ComputeSweep(config, "birth_mutation_rate", values, &coupled));
+  REQUIRE(coupled.differences[0].empty());
+  const auto& coupled_difference = coupled.differences[1].at(measure);
+  REQUIRE(coupled_difference.num_pairs == config.num_simulations);
+
+  config.common_random_numbers = false;
+  equilibrium::SweepResults independent;
+  REQUIRE(equilibrium::ComputeSweep(config, "birth_mutation_rate", values, &independent));
+  const auto& independent_difference = independent.differences[1].at(measure);
+
+  REQUIRE(coupled_difference.standard_error < 0.6 * independent_difference.standard_error);
+  REQUIRE(coupled_difference.standard_error < 0.6 * coupled_difference.unpaired_standard_error);
+
+  REQUIRE_FALSE(equilibrium::ComputeSweep(config, "birth_mutation_rate", {"0.01", "x"}, &independent));
+}
+
+TEST_CASE("independent sweep points get seeds of their own", "[ComputeSweep]") {
+  auto config = MakeConfig();
+  config.num_simulations = 20;
+  config.seed = INT_MAX;
+  equilibrium::SweepResults results;
+  REQUIRE(equilibrium::ComputeSweep(config, "birth_mutation_rate", {"0.01", "0.01"}, &results));
+  const auto measure = equilibrium::DiversityMeasure::NUMBER_OF_TYPES;
+  REQUIRE(results.samples[0].at(measure) != results.samples[1].at(measure));
+}
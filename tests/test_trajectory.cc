@@ -0,0 +1,56 @@
+#include <cmath>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <equilibrium/graph.h>
+#include <equilibrium/simulation.h>
+#include <equilibrium/trajectory.h>
+
+TEST_CASE("checkpoints include both ends", "[MakeCheckpoints]") {
+  std::vector<int> checkpoints;
+  equilibrium::MakeCheckpoints(1000, 3, true, &checkpoints);
+  REQUIRE(checkpoints == std::vector<int>{0, 10, 100, 1000});
+  equilibrium::MakeCheckpoints(10, 5, false, &checkpoints);
+  REQUIRE(checkpoints == std::vector<int>{0, 2, 4, 6, 8, 10});
+}
+
+TEST_CASE("trajectory ends at the final stats", "[ComputeTrajectories]") {
+  equilibrium::SimulationConfig config;
+  config.birth_mutation_rate = 0.02;
+  config.independent_mutation_rate = 0;
+  config.num_steps = 2000;
+  config.num_simulations = 6;
+  config.dynamic = equilibrium::Dynamic::DEATH_BIRTH;
+  config.graph = equilibrium::StarGraph(10);
+  config.capture_history = false;
+  config.compute_stats = true;
+  config.start_with_max_diversity = true;
+  config.run_until_homogeneous = false;
+  config.seed = 8;
+  equilibrium::MakeCheckpoints(config.num_steps, 10, true, &config.checkpoints);
+  REQUIRE(equilibrium::MakeMeasureTrackers("abundance_spectrum", config.graph, &config.measures));
+
+  equilibrium::TrajectorySummary summary;
+  equilibrium::ComputeTrajectories(config, 0, config.num_simulations, &summary);
+  REQUIRE(summary.series.size() == 3 + 10);
+  REQUIRE(summary.series[3] == "abundance_spectrum_1");
+
+  // Every location starts as its own type.
+  REQUIRE(std::fabs(summary.moments[0][0].mean() - 10) < 1e-12);
+  REQUIRE(std::fabs(summary.moments[0][3].mean() - 10) < 1e-12);
+
+  config.checkpoints.clear();
+  config.measures.clear();
+  double final_types = 0;
+  double final_pairs = 0;
+  for (int trial = 0; trial < config.num_simulations; ++trial) {
+    equilibrium::Stats stats;
+    equilibrium::Simulate(config, trial, &stats, nullptr);
+    final_types += stats.number_of_types;
+    final_pairs += stats.number_of_unmatching_pairs;
+  }
+  const auto& last = summary.moments.back();
+  REQUIRE(last[0].count() == config.num_simulations);
+  REQUIRE(std::fabs(last[0].mean() - final_types / config.num_simulations) < 1e-9);
+  REQUIRE(std::fabs(last[1].mean() - final_pairs / config.num_simulations) < 1e-9);
+}
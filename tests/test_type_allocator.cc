@@ -0,0 +1,39 @@
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <equilibrium/type_allocator.h>
+
+TEST_CASE("extinct ids are recycled", "[TypeAllocator]") {
+  equilibrium::TypeAllocator types;
+  types.Reset(3, 1);
+  REQUIRE(types.num_types() == 1);
+  REQUIRE(types.abundance(0) == 3);
+
+  // Mutate every location in turn; ids never exceed N.
+  std::vector<int> location_to_id = {0, 0, 0};
+  for (int k = 0; k < 30; ++k) {
+    const int location = k % 3;
+    const int id = types.Allocate();
+    REQUIRE(id <= 3);
+    types.Replace(location_to_id[location], id);
+    location_to_id[location] = id;
+  }
+  REQUIRE(types.num_types() == 3);
+  REQUIRE(types.num_global_types() == 31);
+
+  std::vector<int> location_to_type;
+  types.ToGlobal(location_to_id, &location_to_type);
+  REQUIRE(location_to_type == std::vector<int>{28, 29, 30});
+}
+
+TEST_CASE("max diversity starts with one id per location", "[TypeAllocator]") {
+  equilibrium::TypeAllocator types;
+  types.Reset(4, 4);
+  REQUIRE(types.num_types() == 4);
+  types.Replace(1, 0);
+  REQUIRE(types.num_types() == 3);
+  REQUIRE(types.abundance(0) == 2);
+  // The freed id stands for the next global type.
+  REQUIRE(types.Allocate() == 1);
+  REQUIRE(types.global_type(1) == 4);
+}
@@ -0,0 +1,69 @@
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <equilibrium/validate.h>
+
+namespace {
+
+equilibrium::ValidationConfig MakeConfig(equilibrium::ValidationCandidate candidate) {
+  equilibrium::ValidationConfig config;
+  config.candidate = candidate;
+  config.graph_names = {"star", "cycle"};
+  config.ns = {5};
+  config.dynamics = {equilibrium::Dynamic::DEATH_BIRTH};
+  config.num_steps = 50;
+  config.num_trials = 2000;
+  return config;
+}
+
+}  // namespace
+
+TEST_CASE("candidates run the cases they support", "[RunValidation]") {
+  std::vector<equilibrium::ValidationResult> results;
+  REQUIRE(equilibrium::RunValidation(MakeConfig(equilibrium::ValidationCandidate::LUMPED), &results));
+  // Neither mutations nor cycles are lumped.
+  REQUIRE(results.size() == 1);
+  REQUIRE(results[0].graph_name == "star");
+  REQUIRE(results[0].quantity == "absorption_time");
+  REQUIRE(results[0].passed);
+
+  REQUIRE(equilibrium::RunValidation(MakeConfig(equilibrium::ValidationCandidate::COMMON_RANDOM_NUMBERS), &results));
+  // Per graph, absorption times and the three diversity measures.
+  REQUIRE(results.size() == 8);
+  for (const auto& result : results) REQUIRE(result.passed);
+
+  REQUIRE(equilibrium::RunValidation(MakeConfig(equilibrium::ValidationCandidate::BATCHED_FIXATION), &results));
+  // Per graph, the outcome and both absorption times, only without mutations.
+  REQUIRE(results.size() == 6);
+  REQUIRE(results[1].quantity == "fixation_time");
+  for (const auto& result : results) REQUIRE(result.passed);
+
+  REQUIRE(equilibrium::RunValidation(MakeConfig(equilibrium::ValidationCandidate::PARALLEL_TRAJECTORY), &results));
+  // Per graph and mutation rate, the three diversity measures.
+  REQUIRE(results.size() == 12);
+  for (const auto& result : results) REQUIRE(result.passed);
+}
+
+TEST_CASE("batched fixation needs a valid fitness", "[RunValidation]") {
+  auto config = MakeConfig(equilibrium::ValidationCandidate::BATCHED_FIXATION);
+  config.mutant_fitness = 0;
+  std::vector<equilibrium::ValidationResult> results;
+  REQUIRE_FALSE(equilibrium::RunValidation(config, &results));
+}
+
+TEST_CASE("unknown graphs are rejected", "[RunValidation]") {
+  auto config = MakeConfig(equilibrium::ValidationCandidate::ENSEMBLE);
+  config.graph_names = {"moebius"};
+  std::vector<equilibrium::ValidationResult> results;
+  REQUIRE_FALSE(equilibrium::RunValidation(config, &results));
+}
+
+TEST_CASE("candidate names", "[ValidationCandidate]") {
+  equilibrium::ValidationCandidate candidate;
+  REQUIRE(equilibrium::FromString("common-random-numbers", &candidate));
+  std::string candidate_str;
+  REQUIRE(equilibrium::ToString(candidate, &candidate_str));
+  REQUIRE(candidate_str == "common-random-numbers");
+  REQUIRE_FALSE(equilibrium::FromString("simd", &candidate));
+}